@@ -12,8 +12,6 @@ class gpgpu_context {
  public:
   gpgpu_context() {
     g_global_allfiles_symbol_table = NULL;
-    sm_next_access_uid = 0;
-    warp_inst_sm_next_uid = 0;
     operand_info_sm_next_uid = 1;
     kernel_info_m_next_uid = 1;
     g_num_ptx_inst_uid = 0;
@@ -32,8 +30,6 @@ class gpgpu_context {
   // global list
   symbol_table *g_global_allfiles_symbol_table;
   const char *g_filename;
-  unsigned sm_next_access_uid;
-  unsigned warp_inst_sm_next_uid;
   unsigned operand_info_sm_next_uid;  // uid for operand_info
   unsigned kernel_info_m_next_uid;    // uid for kernel_info_t
   unsigned g_num_ptx_inst_uid;        // uid for ptx inst inside ptx_instruction
@@ -42,16 +42,43 @@
 
 void mem_access_t::init(gpgpu_context *ctx) {
   gpgpu_ctx = ctx;
-  m_uid = ++(gpgpu_ctx->sm_next_access_uid);
   m_addr = 0;
   m_req_size = 0;
 }
+void inst_t::set_reg_mask() {
+  unsigned regs[MAX_OUTPUT_VALUES + MAX_INPUT_VALUES + 3];
+  unsigned n = 0;
+  for (unsigned i = 0; i < outcount; i++) regs[n++] = out[i];
+  for (unsigned i = 0; i < incount; i++) regs[n++] = in[i];
+  if (pred > 0) regs[n++] = pred;
+  if (ar1 > 0) regs[n++] = ar1;
+  if (ar2 > 0) regs[n++] = ar2;
+
+  reg_mask_words = 0;
+  for (unsigned i = 0; i < n; i++) {
+    unsigned word = regs[i] / 64;
+    unsigned long long bit = 1ULL << (regs[i] % 64);
+    unsigned w = 0;
+    while (w < reg_mask_words && reg_mask[w].word != word) w++;
+    if (w == reg_mask_words) {
+      if (reg_mask_words == MAX_REG_MASK_WORDS) {
+        reg_mask_words = (unsigned)-1;
+        return;
+      }
+      reg_mask[w].word = word;
+      reg_mask[w].bits = 0;
+      reg_mask_words++;
+    }
+    reg_mask[w].bits |= bit;
+  }
+}
+
 void warp_inst_t::issue(const active_mask_t &mask, unsigned warp_id,
                         unsigned long long cycle, int dynamic_warp_id,
-                        int sch_id) {
+                        int sch_id, unsigned uid) {
   m_warp_active_mask = mask;
   m_warp_issued_mask = mask;
-  m_uid = ++(m_config->gpgpu_ctx->warp_inst_sm_next_uid);
+  m_uid = uid;
   m_warp_id = warp_id;
   m_dynamic_warp_id = dynamic_warp_id;
   issue_cycle = cycle;
@@ -166,6 +193,11 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser *opp) {
                          &g_ptx_inst_debug_thread_uid,
                          "Thread UID for executed instructions' debug output",
                          "1");
+  option_parser_register(
+      opp, "-gpgpu_ptx_warp_exec", OPT_BOOL, &m_ptx_warp_exec,
+      "Execute common ALU, compare and load/store instructions for a whole "
+      "warp at once",
+      "1");
 }
 
 void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(
@@ -176,10 +208,10 @@ void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(
 gpgpu_t::gpgpu_t(const gpgpu_functional_sim_config &config, gpgpu_context *ctx)
     : m_function_model_config(config) {
   gpgpu_ctx = ctx;
-  m_global_mem = new memory_space_impl<8192>("global", 64 * 1024);
+  m_global_mem = new memory_space_impl<8192>("global");
 
-  m_tex_mem = new memory_space_impl<8192>("tex", 64 * 1024);
-  m_surf_mem = new memory_space_impl<8192>("surf", 64 * 1024);
+  m_tex_mem = new memory_space_impl<8192>("tex");
+  m_surf_mem = new memory_space_impl<8192>("surf");
 
   m_dev_malloc = GLOBAL_HEAP_START;
   checkpoint_option = m_function_model_config.get_checkpoint_option();
@@ -205,8 +237,8 @@ gpgpu_t::gpgpu_t(const gpgpu_functional_sim_config &config, gpgpu_context *ctx)
   gpu_tot_sim_cycle = 0;
 }
 
-address_type line_size_based_tag_func(new_addr_type address,
-                                      new_addr_type line_size) {
+new_addr_type line_size_based_tag_func(new_addr_type address,
+                                       new_addr_type line_size) {
   // gives the tag for an address based on a given line size
   return address & ~(line_size - 1);
 }
@@ -268,6 +300,7 @@ void warp_inst_t::do_atomic(const active_mask_t &access_mask, bool forceDo) {
 
 void warp_inst_t::broadcast_barrier_reduction(
     const active_mask_t &access_mask) {
+  if (!m_per_scalar_thread_valid) return;
   for (unsigned i = 0; i < m_config->warp_size; i++) {
     if (access_mask.test(i)) {
       dram_callback_t &cb = m_per_scalar_thread[i].callback;
@@ -442,17 +475,43 @@ void warp_inst_t::generate_mem_accesses() {
   if (cache_block_size) {
     assert(m_accessq.empty());
     mem_access_byte_mask_t byte_mask;
+    // Lanes usually hit one line (broadcast) or lines in ascending order;
+    // those are emitted as runs, anything else is sorted through a map.
+    new_addr_type block[MAX_WARP_SIZE];
+    active_mask_t run_mask[MAX_WARP_SIZE];
+    unsigned n_runs = 0;
+    bool sorted = true;
     std::map<new_addr_type, active_mask_t>
         accesses;  // block address -> set of thread offsets in warp
     std::map<new_addr_type, active_mask_t>::iterator a;
     for (unsigned thread = 0; thread < m_config->warp_size; thread++) {
       if (!active(thread)) continue;
       new_addr_type addr = m_per_scalar_thread[thread].memreqaddr[0];
-      unsigned block_address = line_size_based_tag_func(addr, cache_block_size);
-      accesses[block_address].set(thread);
+      new_addr_type block_address =
+          line_size_based_tag_func(addr, cache_block_size);
+      if (sorted && n_runs && block_address < block[n_runs - 1]) {
+        sorted = false;
+        for (unsigned r = 0; r < n_runs; r++) accesses[block[r]] = run_mask[r];
+      }
+      if (!sorted) {
+        accesses[block_address].set(thread);
+      } else {
+        if (n_runs == 0 || block_address != block[n_runs - 1]) {
+          block[n_runs] = block_address;
+          run_mask[n_runs].reset();
+          n_runs++;
+        }
+        run_mask[n_runs - 1].set(thread);
+      }
       unsigned idx = addr - block_address;
       for (unsigned i = 0; i < data_size; i++) byte_mask.set(idx + i);
     }
+    if (sorted) {
+      for (unsigned r = 0; r < n_runs; r++)
+        m_accessq.push_back(mem_access_t(
+            access_type, block[r], cache_block_size, is_write, run_mask[r],
+            byte_mask, mem_access_sector_mask_t(), m_config->gpgpu_ctx));
+    }
     for (a = accesses.begin(); a != accesses.end(); ++a)
       m_accessq.push_back(mem_access_t(
           access_type, a->first, cache_block_size, is_write, a->second,
@@ -501,79 +560,173 @@ void warp_inst_t::memory_coalescing_arch(bool is_write,
   }
   unsigned subwarp_size = m_config->warp_size / warp_parts;
 
-  for (unsigned subwarp = 0; subwarp < warp_parts; subwarp++) {
-    std::map<new_addr_type, transaction_info> subwarp_transactions;
-
-    // step 1: find all transactions generated by this subwarp
-    for (unsigned thread = subwarp * subwarp_size;
-         thread < subwarp_size * (subwarp + 1); thread++) {
-      if (!active(thread)) continue;
+  unsigned data_size_coales = data_size;
+  if (space.get_type() == local_space ||
+      space.get_type() == param_space_local) {
+    // Local memory accesses >4B were split into 4B chunks
+    if (data_size >= 4) {
+      data_size_coales = 4;
+      assert(data_size / 4 <= MAX_ACCESSES_PER_INSN_PER_THREAD);
+    }
+    // Otherwise keep the same data_size for sub-4B access to local memory
+  }
 
-      unsigned data_size_coales = data_size;
-      unsigned num_accesses = 1;
+  for (unsigned subwarp = 0; subwarp < warp_parts; subwarp++) {
+    unsigned first = subwarp * subwarp_size;
+    unsigned last = first + subwarp_size;
+#ifdef CHECK_SORTED_COALESCING
+    // cross-check the map-free coalescer against the general one
+    unsigned n_before = m_accessq.size();
+    if (memory_coalescing_arch_sorted(is_write, access_type, first, last,
+                                      segment_size, data_size_coales)) {
+      unsigned n_sorted = m_accessq.size() - n_before;
+      memory_coalescing_arch_general(is_write, access_type, first, last,
+                                     segment_size, data_size_coales);
+      assert(m_accessq.size() - n_before == 2 * n_sorted);
+      for (unsigned i = 0; i < n_sorted; i++) {
+        const mem_access_t &x = m_accessq[n_before + i];
+        const mem_access_t &y = m_accessq[n_before + n_sorted + i];
+        assert(x.get_addr() == y.get_addr() && x.get_size() == y.get_size() &&
+               x.get_warp_mask() == y.get_warp_mask() &&
+               x.get_byte_mask() == y.get_byte_mask() &&
+               x.get_sector_mask() == y.get_sector_mask());
+      }
+      for (unsigned i = 0; i < n_sorted; i++) m_accessq.pop_back();
+      continue;
+    }
+#else
+    if (memory_coalescing_arch_sorted(is_write, access_type, first, last,
+                                      segment_size, data_size_coales))
+      continue;
+#endif
+    memory_coalescing_arch_general(is_write, access_type, first, last,
+                                   segment_size, data_size_coales);
+  }
+}
 
-      if (space.get_type() == local_space ||
-          space.get_type() == param_space_local) {
-        // Local memory accesses >4B were split into 4B chunks
-        if (data_size >= 4) {
-          data_size_coales = 4;
-          num_accesses = data_size / 4;
-        }
-        // Otherwise keep the same data_size for sub-4B access to local memory
+bool warp_inst_t::memory_coalescing_arch_sorted(bool is_write,
+                                                mem_access_type access_type,
+                                                unsigned first, unsigned last,
+                                                unsigned segment_size,
+                                                unsigned data_size_coales) {
+  if (segment_size == 0 || data_size_coales > 16) return false;
+
+  // gather the active lanes into dense vectors
+  new_addr_type addr[MAX_WARP_SIZE];
+  new_addr_type block[MAX_WARP_SIZE];
+  new_addr_type block_end[MAX_WARP_SIZE];
+  unsigned lane[MAX_WARP_SIZE];
+  unsigned n = 0;
+  for (unsigned thread = first; thread < last; thread++) {
+    if (!active(thread)) continue;
+    const per_thread_info &info = m_per_scalar_thread[thread];
+    // exactly one access per lane; address 0 marks a lane without one
+    if (info.memreqaddr[0] == 0 || info.memreqaddr[1] != 0) return false;
+    addr[n] = info.memreqaddr[0];
+    lane[n] = thread;
+    n++;
+  }
+  if (n == 0) return true;
+
+  // no lane may straddle two segments, and segments must not decrease from
+  // one lane to the next, so equal segments form runs in ascending order
+  bool general = false;
+  for (unsigned i = 0; i < n; i++) {
+    block[i] = line_size_based_tag_func(addr[i], segment_size);
+    block_end[i] =
+        line_size_based_tag_func(addr[i] + data_size_coales - 1, segment_size);
+  }
+  for (unsigned i = 0; i < n; i++) general |= block[i] != block_end[i];
+  for (unsigned i = 1; i < n; i++) general |= block[i] < block[i - 1];
+  if (general) return false;
+
+  const unsigned long long size_bits = (1ULL << data_size_coales) - 1;
+  for (unsigned i = 0; i < n;) {
+    new_addr_type run_block = block[i];
+    transaction_info info;
+    unsigned long long bytes_lo = 0, bytes_hi = 0;
+    for (; i < n && block[i] == run_block; i++) {
+      unsigned idx = addr[i] & 127;
+      info.chunks.set(idx / 32);
+      info.active.set(lane[i]);
+      // bytes past the 128-byte window are dropped, as in the general path
+      if (idx < 64) {
+        bytes_lo |= size_bits << idx;
+        if (idx + data_size_coales > 64) bytes_hi |= size_bits >> (64 - idx);
+      } else {
+        bytes_hi |= size_bits << (idx - 64);
       }
+    }
+    info.bytes = mem_access_byte_mask_t(bytes_hi);
+    info.bytes <<= 64;
+    info.bytes |= mem_access_byte_mask_t(bytes_lo);
+    memory_coalescing_arch_reduce_and_send(is_write, access_type, info,
+                                           run_block, segment_size);
+  }
+  return true;
+}
 
-      assert(num_accesses <= MAX_ACCESSES_PER_INSN_PER_THREAD);
-
-      //            for(unsigned access=0; access<num_accesses; access++) {
-      for (unsigned access = 0;
-           (access < MAX_ACCESSES_PER_INSN_PER_THREAD) &&
-           (m_per_scalar_thread[thread].memreqaddr[access] != 0);
-           access++) {
-        new_addr_type addr = m_per_scalar_thread[thread].memreqaddr[access];
-        unsigned block_address = line_size_based_tag_func(addr, segment_size);
-        unsigned chunk =
-            (addr & 127) / 32;  // which 32-byte chunk within in a 128-byte
-                                // chunk does this thread access?
-        transaction_info &info = subwarp_transactions[block_address];
+void warp_inst_t::memory_coalescing_arch_general(bool is_write,
+                                                 mem_access_type access_type,
+                                                 unsigned first, unsigned last,
+                                                 unsigned segment_size,
+                                                 unsigned data_size_coales) {
+  std::map<new_addr_type, transaction_info> subwarp_transactions;
+
+  // step 1: find all transactions generated by this subwarp
+  for (unsigned thread = first; thread < last; thread++) {
+    if (!active(thread)) continue;
+
+    //            for(unsigned access=0; access<num_accesses; access++) {
+    for (unsigned access = 0;
+         (access < MAX_ACCESSES_PER_INSN_PER_THREAD) &&
+         (m_per_scalar_thread[thread].memreqaddr[access] != 0);
+         access++) {
+      new_addr_type addr = m_per_scalar_thread[thread].memreqaddr[access];
+      new_addr_type block_address =
+          line_size_based_tag_func(addr, segment_size);
+      unsigned chunk =
+          (addr & 127) / 32;  // which 32-byte chunk within in a 128-byte
+                              // chunk does this thread access?
+      transaction_info &info = subwarp_transactions[block_address];
 
-        // can only write to one segment
-        // it seems like in trace driven, a thread can write to more than one
-        // segment assert(block_address ==
-        // line_size_based_tag_func(addr+data_size_coales-1,segment_size));
+      // can only write to one segment
+      // it seems like in trace driven, a thread can write to more than one
+      // segment assert(block_address ==
+      // line_size_based_tag_func(addr+data_size_coales-1,segment_size));
 
+      info.chunks.set(chunk);
+      info.active.set(thread);
+      unsigned idx = (addr & 127);
+      for (unsigned i = 0; i < data_size_coales; i++)
+        if ((idx + i) < MAX_MEMORY_ACCESS_SIZE) info.bytes.set(idx + i);
+
+      // it seems like in trace driven, a thread can write to more than one
+      // segment handle this special case
+      if (block_address != line_size_based_tag_func(
+                               addr + data_size_coales - 1, segment_size)) {
+        addr = addr + data_size_coales - 1;
+        new_addr_type block_address =
+            line_size_based_tag_func(addr, segment_size);
+        unsigned chunk = (addr & 127) / 32;
+        transaction_info &info = subwarp_transactions[block_address];
         info.chunks.set(chunk);
         info.active.set(thread);
         unsigned idx = (addr & 127);
         for (unsigned i = 0; i < data_size_coales; i++)
           if ((idx + i) < MAX_MEMORY_ACCESS_SIZE) info.bytes.set(idx + i);
-
-        // it seems like in trace driven, a thread can write to more than one
-        // segment handle this special case
-        if (block_address != line_size_based_tag_func(
-                                 addr + data_size_coales - 1, segment_size)) {
-          addr = addr + data_size_coales - 1;
-          unsigned block_address = line_size_based_tag_func(addr, segment_size);
-          unsigned chunk = (addr & 127) / 32;
-          transaction_info &info = subwarp_transactions[block_address];
-          info.chunks.set(chunk);
-          info.active.set(thread);
-          unsigned idx = (addr & 127);
-          for (unsigned i = 0; i < data_size_coales; i++)
-            if ((idx + i) < MAX_MEMORY_ACCESS_SIZE) info.bytes.set(idx + i);
-        }
       }
     }
+  }
 
-    // step 2: reduce each transaction size, if possible
-    std::map<new_addr_type, transaction_info>::iterator t;
-    for (t = subwarp_transactions.begin(); t != subwarp_transactions.end();
-         t++) {
-      new_addr_type addr = t->first;
-      const transaction_info &info = t->second;
-
-      memory_coalescing_arch_reduce_and_send(is_write, access_type, info, addr,
-                                             segment_size);
-    }
+  // step 2: reduce each transaction size, if possible
+  std::map<new_addr_type, transaction_info>::iterator t;
+  for (t = subwarp_transactions.begin(); t != subwarp_transactions.end(); t++) {
+    new_addr_type addr = t->first;
+    const transaction_info &info = t->second;
+
+    memory_coalescing_arch_reduce_and_send(is_write, access_type, info, addr,
+                                           segment_size);
   }
 }
 
@@ -756,7 +909,7 @@ kernel_info_t::kernel_info_t(dim3 gridDim, dim3 blockDim,
   m_next_tid = m_next_cta;
   m_num_cores_running = 0;
   m_uid = (entry->gpgpu_ctx->kernel_info_m_next_uid)++;
-  m_param_mem = new memory_space_impl<8192>("param", 64 * 1024);
+  m_param_mem = new memory_space_impl<8192>("param");
 
   // Jin: parent and child kernel management for CDP
   m_parent_kernel = NULL;
@@ -787,7 +940,7 @@ kernel_info_t::kernel_info_t(
   m_next_tid = m_next_cta;
   m_num_cores_running = 0;
   m_uid = (entry->gpgpu_ctx->kernel_info_m_next_uid)++;
-  m_param_mem = new memory_space_impl<8192>("param", 64 * 1024);
+  m_param_mem = new memory_space_impl<8192>("param");
 
   // Jin: parent and child kernel management for CDP
   m_parent_kernel = NULL;
@@ -1176,6 +1329,22 @@ void simt_stack::update(simt_mask_t &thread_done, addr_vector_t &next_pc,
 }
 
 void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId) {
+  if (m_gpu->get_config().ptx_warp_exec() && inst.active_count()) {
+    if (warpId == (unsigned(-1))) warpId = inst.warp_id();
+    active_mask_t skipped;
+    if (ptx_thread_info::ptx_exec_warp_inst(
+            inst, &m_thread[m_warp_size * warpId], m_warp_size, skipped)) {
+      // replay the per-lane status updates in the order ptx_exec_inst()
+      // would have interleaved them with execution
+      for (unsigned t = 0; t < m_warp_size; t++) {
+        if (inst.active(t)) {
+          if (skipped.test(t)) inst.set_not_active(t);
+          checkExecutionStatusAndUpdate(inst, t, m_warp_size * warpId + t);
+        }
+      }
+      return;
+    }
+  }
   for (unsigned t = 0; t < m_warp_size; t++) {
     if (inst.active(t)) {
       if (warpId == (unsigned(-1))) warpId = inst.warp_id();
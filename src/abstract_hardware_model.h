@@ -161,6 +161,8 @@ enum _memory_op_t { no_memory_op = 0, memory_load, memory_store };
 #include <deque>
 #include <list>
 #include <map>
+#include <new>
+#include <type_traits>
 #include <vector>
 
 #if !defined(__VECTOR_TYPES_H__)
@@ -528,10 +530,11 @@ class gpgpu_functional_sim_config {
   int get_resume_CTA() const { return resume_CTA; }
   int get_checkpoint_CTA_t() const { return checkpoint_CTA_t; }
   int get_checkpoint_insn_Y() const { return checkpoint_insn_Y; }
+  bool ptx_warp_exec() const { return m_ptx_warp_exec; }
 
  private:
   // PTX options
-  int m_ptx_convert_to_ptxplus;
+  bool m_ptx_convert_to_ptxplus;
   int m_ptx_use_cuobjdump;
   int m_experimental_lib_support;
   unsigned m_ptx_force_max_capability;
@@ -543,9 +546,10 @@ class gpgpu_functional_sim_config {
   unsigned resume_CTA;
   unsigned checkpoint_CTA_t;
   int checkpoint_insn_Y;
-  int g_ptx_inst_debug_to_file;
+  bool g_ptx_inst_debug_to_file;
   char *g_ptx_inst_debug_file;
   int g_ptx_inst_debug_thread_uid;
+  bool m_ptx_warp_exec;
 
   unsigned m_texcache_linesize;
 };
@@ -848,7 +852,6 @@ class mem_access_t {
  private:
   void init(gpgpu_context *ctx);
 
-  unsigned m_uid;
   new_addr_type m_addr;  // request address
   bool m_write;
   unsigned m_req_size;  // bytes
@@ -874,12 +877,19 @@ class mem_fetch_allocator {
   virtual mem_fetch *alloc(const class warp_inst_t &inst,
                            const mem_access_t &access,
                            unsigned long long cycle) const = 0;
+  // pool backing the fetches this allocator hands out; caches use it for the
+  // requests they derive from an incoming one
+  virtual class mem_fetch_pool *get_pool() const = 0;
 };
 
 // the maximum number of destination, source, or address uarch operands in a
 // instruction
 #define MAX_REG_OPERANDS 32
 
+// registers of an instruction are summarized for the scoreboard in at most
+// this many 64-register words
+#define MAX_REG_MASK_WORDS 4
+
 struct dram_callback_t {
   dram_callback_t() {
     function = NULL;
@@ -922,6 +932,7 @@ class inst_t {
       arch_reg.dst[i] = -1;
     }
     isize = 0;
+    reg_mask_words = (unsigned)-1;
   }
   bool valid() const { return m_decoded; }
   virtual void print_insn(FILE *fp) const {
@@ -980,6 +991,18 @@ class inst_t {
   } arch_reg;
   // int arch_reg[MAX_REG_OPERANDS]; // register number for bank conflict
   // evaluation
+
+  // Every register the instruction reads or writes (out, in, pred, ar1, ar2)
+  // as bit masks over 64-register words, built once by set_reg_mask() after
+  // decoding so the scoreboard can test for hazards without walking the
+  // operand arrays.  reg_mask_words is (unsigned)-1 if the registers span
+  // more than MAX_REG_MASK_WORDS words (or the mask was never built).
+  struct reg_mask_word_t {
+    unsigned word;
+    unsigned long long bits;
+  } reg_mask[MAX_REG_MASK_WORDS];
+  unsigned reg_mask_words;
+  void set_reg_mask();
   unsigned latency;  // operation latency
   unsigned initiation_interval;
 
@@ -996,6 +1019,71 @@ enum divergence_support_t { POST_DOMINATOR = 1, NUM_SIMD_MODEL };
 
 const unsigned MAX_ACCESSES_PER_INSN_PER_THREAD = 8;
 
+// Vector that keeps its first N elements inline and only allocates beyond
+// that.  Copies construct just the live elements, so copying an empty or short
+// one costs no more than the inline words it touches.
+template <class T, unsigned N>
+class small_vector {
+ public:
+  small_vector() : m_size(0) {}
+  small_vector(const small_vector &other) : m_size(0) { append(other); }
+  small_vector &operator=(const small_vector &other) {
+    if (this != &other) {
+      clear();
+      append(other);
+    }
+    return *this;
+  }
+  ~small_vector() { clear(); }
+
+  bool empty() const { return m_size == 0; }
+  unsigned size() const { return m_size; }
+  T &operator[](unsigned i) {
+    return i < N ? inline_at(i) : m_overflow[i - N];
+  }
+  const T &operator[](unsigned i) const {
+    return i < N ? inline_at(i) : m_overflow[i - N];
+  }
+  T &back() { return (*this)[m_size - 1]; }
+
+  void push_back(const T &value) {
+    if (m_size < N)
+      new (&inline_at(m_size)) T(value);
+    else
+      m_overflow.push_back(value);
+    m_size++;
+  }
+  void pop_back() {
+    assert(m_size > 0);
+    m_size--;
+    if (m_size < N)
+      inline_at(m_size).~T();
+    else
+      m_overflow.pop_back();
+  }
+  void clear() {
+    while (m_size > N) pop_back();
+    m_overflow.clear();
+    while (m_size) pop_back();
+  }
+
+ private:
+  void append(const small_vector &other) {
+    for (unsigned i = 0; i < other.m_size; i++) push_back(other[i]);
+  }
+  T &inline_at(unsigned i) { return reinterpret_cast<T *>(&m_inline)[i]; }
+  const T &inline_at(unsigned i) const {
+    return reinterpret_cast<const T *>(&m_inline)[i];
+  }
+
+  typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type m_inline;
+  unsigned m_size;
+  std::vector<T> m_overflow;
+};
+
+// accesses kept inline per instruction; a fully uncoalesced warp spills
+#define WARP_INST_INLINE_ACCESSES 8
+
 class warp_inst_t : public inst_t {
  public:
   // constructors
@@ -1026,7 +1114,8 @@ class warp_inst_t : public inst_t {
   void clear() { m_empty = true; }
 
   void issue(const active_mask_t &mask, unsigned warp_id,
-             unsigned long long cycle, int dynamic_warp_id, int sch_id);
+             unsigned long long cycle, int dynamic_warp_id, int sch_id,
+             unsigned uid);
 
   const active_mask_t &get_active_mask() const { return m_warp_active_mask; }
   void completed(unsigned long long cycle)
@@ -1034,14 +1123,14 @@ class warp_inst_t : public inst_t {
 
   void set_addr(unsigned n, new_addr_type addr) {
     if (!m_per_scalar_thread_valid) {
-      m_per_scalar_thread.resize(m_config->warp_size);
+      m_per_scalar_thread.init(m_config->warp_size);
       m_per_scalar_thread_valid = true;
     }
     m_per_scalar_thread[n].memreqaddr[0] = addr;
   }
   void set_addr(unsigned n, new_addr_type *addr, unsigned num_addrs) {
     if (!m_per_scalar_thread_valid) {
-      m_per_scalar_thread.resize(m_config->warp_size);
+      m_per_scalar_thread.init(m_config->warp_size);
       m_per_scalar_thread_valid = true;
     }
     assert(num_addrs <= MAX_ACCESSES_PER_INSN_PER_THREAD);
@@ -1053,11 +1142,11 @@ class warp_inst_t : public inst_t {
       return;
     else {
       printf("Printing mem access generated\n");
-      std::list<mem_access_t>::iterator it;
-      for (it = m_accessq.begin(); it != m_accessq.end(); ++it) {
+      for (unsigned i = 0; i < m_accessq.size(); i++) {
+        const mem_access_t &access = m_accessq[i];
         printf("MEM_TXN_GEN:%s:%llx, Size:%d \n",
-               mem_access_type_str(it->get_type()), it->get_addr(),
-               it->get_size());
+               mem_access_type_str(access.get_type()), access.get_addr(),
+               access.get_size());
       }
     }
   }
@@ -1082,6 +1171,20 @@ class warp_inst_t : public inst_t {
                                               const transaction_info &info,
                                               new_addr_type addr,
                                               unsigned segment_size);
+  // Coalesces the lanes [first, last) of one subwarp.  The sorted variant
+  // handles the common patterns (broadcast, unit stride, lanes grouped by
+  // segment) without building a segment map, and returns false without
+  // generating anything when the subwarp needs the general variant.
+  bool memory_coalescing_arch_sorted(bool is_write,
+                                     mem_access_type access_type,
+                                     unsigned first, unsigned last,
+                                     unsigned segment_size,
+                                     unsigned data_size_coales);
+  void memory_coalescing_arch_general(bool is_write,
+                                      mem_access_type access_type,
+                                      unsigned first, unsigned last,
+                                      unsigned segment_size,
+                                      unsigned data_size_coales);
 
   void add_callback(unsigned lane_id,
                     void (*function)(const class inst_t *,
@@ -1089,7 +1192,7 @@ class warp_inst_t : public inst_t {
                     const inst_t *inst, class ptx_thread_info *thread,
                     bool atomic) {
     if (!m_per_scalar_thread_valid) {
-      m_per_scalar_thread.resize(m_config->warp_size);
+      m_per_scalar_thread.init(m_config->warp_size);
       m_per_scalar_thread_valid = true;
       if (atomic) m_isatomic = true;
     }
@@ -1188,10 +1291,47 @@ class warp_inst_t : public inst_t {
                                                        // 32B access in 8 chunks
                                                        // of 4B each)
   };
+  // Lane metadata stored inline.  Lanes are only constructed by init() and
+  // copies move just the lanes in use, so instructions that never set up
+  // per-thread state copy nothing here.
+  class per_thread_table {
+   public:
+    per_thread_table() : m_count(0) {}
+    per_thread_table(const per_thread_table &other) : m_count(0) {
+      *this = other;
+    }
+    per_thread_table &operator=(const per_thread_table &other) {
+      m_count = other.m_count;
+      if (m_count)
+        memcpy(&m_lanes, &other.m_lanes, m_count * sizeof(per_thread_info));
+      return *this;
+    }
+    void init(unsigned n) {
+      assert(n <= MAX_WARP_SIZE);
+      m_count = n;
+      for (unsigned i = 0; i < n; i++) new (&lane(i)) per_thread_info();
+    }
+    per_thread_info &operator[](unsigned i) {
+      assert(i < m_count);
+      return lane(i);
+    }
+    const per_thread_info &operator[](unsigned i) const {
+      assert(i < m_count);
+      return reinterpret_cast<const per_thread_info *>(&m_lanes)[i];
+    }
+
+   private:
+    per_thread_info &lane(unsigned i) {
+      return reinterpret_cast<per_thread_info *>(&m_lanes)[i];
+    }
+    unsigned m_count;
+    std::aligned_storage<sizeof(per_thread_info) * MAX_WARP_SIZE,
+                         alignof(per_thread_info)>::type m_lanes;
+  };
   bool m_per_scalar_thread_valid;
-  std::vector<per_thread_info> m_per_scalar_thread;
+  per_thread_table m_per_scalar_thread;
   bool m_mem_accesses_created;
-  std::list<mem_access_t> m_accessq;
+  small_vector<mem_access_t, WARP_INST_INLINE_ACCESSES> m_accessq;
 
   unsigned m_scheduler_id;  // the scheduler that issues this inst
 
@@ -117,6 +117,12 @@ cudaGetParameterBufferV2_init_perWarp, cudaGetParameterBufferV2_perKernel, \
 cudaLaunchDeviceV2_init_perWarp, cudaLaunchDevicV2_perKernel>"
                          "Default 7200,8000,100,12000,1600",
                          "7200,8000,100,12000,1600");
+  option_parser_register(opp, "-gpgpu_ptx_predecode", OPT_BOOL,
+                         &gpgpu_ptx_predecode,
+                         "Resolve instruction handlers when a function is "
+                         "assembled instead of switching on the opcode at "
+                         "every execution (default = enabled)",
+                         "1");
 }
 
 void gpgpu_t::gpgpu_ptx_sim_bindNameToTexture(
@@ -318,6 +324,12 @@ void function_info::ptx_assemble() {
     }
   }
   gpgpu_ctx->func_sim->g_assemble_code_next_pc = PC;
+
+  // The parser numbers registers densely per function (instruction groups
+  // continue the parent's numbering, 0 is the "_" sink), so a thread's
+  // register frame for this function is a flat array indexed by reg_num().
+  m_num_reg_slots = (m_symtab ? m_symtab->reg_count() : 0) + 1;
+
   for (unsigned ii = 0; ii < n;
        ii += m_instr_mem[ii]->inst_size()) {  // handle branch instructions
     ptx_instruction *pI = m_instr_mem[ii];
@@ -337,6 +349,8 @@ void function_info::ptx_assemble() {
       target.set_type(label_t);
     }
   }
+  for (unsigned ii = 0; ii < n; ii += m_instr_mem[ii]->inst_size())
+    m_instr_mem[ii]->build_uop();
   m_n = n;
   printf("  done.\n");
   fflush(stdout);
@@ -474,9 +488,9 @@ void gpgpu_t::memcpy_to_gpu(size_t dst_start_addr, const void *src,
         count, (unsigned long long)src, (unsigned long long)dst_start_addr);
     fflush(stdout);
   }
-  char *src_data = (char *)src;
-  for (unsigned n = 0; n < count; n++)
-    m_global_mem->write(dst_start_addr + n, 1, src_data + n, NULL, NULL);
+  std::vector<mem_span> spans;
+  m_global_mem->map(dst_start_addr, count, true, spans);
+  mem_spans_write(spans, src);
 
   // Copy into the performance model.
   // extern gpgpu_sim* g_the_gpu;
@@ -493,9 +507,9 @@ void gpgpu_t::memcpy_from_gpu(void *dst, size_t src_start_addr, size_t count) {
            count, (unsigned long long)src_start_addr, (unsigned long long)dst);
     fflush(stdout);
   }
-  unsigned char *dst_data = (unsigned char *)dst;
-  for (unsigned n = 0; n < count; n++)
-    m_global_mem->read(src_start_addr + n, 1, dst_data + n);
+  std::vector<mem_span> spans;
+  m_global_mem->map(src_start_addr, count, false, spans);
+  mem_spans_read(spans, dst);
 
   // Copy into the performance model.
   // extern gpgpu_sim* g_the_gpu;
@@ -512,11 +526,10 @@ void gpgpu_t::memcpy_gpu_to_gpu(size_t dst, size_t src, size_t count) {
            count, (unsigned long long)src, (unsigned long long)dst);
     fflush(stdout);
   }
-  for (unsigned n = 0; n < count; n++) {
-    unsigned char tmp;
-    m_global_mem->read(src + n, 1, &tmp);
-    m_global_mem->write(dst + n, 1, &tmp, NULL, NULL);
-  }
+  std::vector<mem_span> src_spans, dst_spans;
+  m_global_mem->map(dst, count, true, dst_spans);
+  m_global_mem->map(src, count, false, src_spans);
+  mem_spans_copy(dst_spans, src_spans);
   if (g_debug_execution >= 3) {
     printf(" done.\n");
     fflush(stdout);
@@ -531,9 +544,9 @@ void gpgpu_t::gpu_memset(size_t dst_start_addr, int c, size_t count) {
         count, (unsigned char)c, (unsigned long long)dst_start_addr);
     fflush(stdout);
   }
-  unsigned char c_value = (unsigned char)c;
-  for (unsigned n = 0; n < count; n++)
-    m_global_mem->write(dst_start_addr + n, 1, &c_value, NULL, NULL);
+  std::vector<mem_span> spans;
+  m_global_mem->map(dst_start_addr, count, true, spans);
+  mem_spans_fill(spans, (unsigned char)c);
   if (g_debug_execution >= 3) {
     printf(" done.\n");
     fflush(stdout);
@@ -997,6 +1010,33 @@ static unsigned datatype2size(unsigned data_type) {
   return data_size;
 }
 
+void ptx_instruction::build_uop() {
+  m_uop = ptx_uop();
+  // with -gpgpu_ptx_predecode 0 the handler is left unresolved and
+  // ptx_exec_inst() switches on the opcode every time
+  bool predecode = gpgpu_ctx->func_sim->gpgpu_ptx_predecode;
+  switch (m_opcode) {
+#define OP_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
+  case OP:                                         \
+    if (predecode) m_uop.m_exec = FUNC;            \
+    m_uop.m_classification = CLASSIFICATION;       \
+    break;
+#define OP_W_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
+  case OP:                                           \
+    m_uop.m_classification = CLASSIFICATION;         \
+    break;
+#include "opcodes.def"
+#undef OP_DEF
+#undef OP_W_DEF
+    default:
+      break;
+  }
+  m_uop.m_tensorcore =
+      m_opcode == MMA_OP || m_opcode == MMA_LD_OP || m_opcode == MMA_ST_OP;
+  m_uop.m_copy_warp_mask = m_opcode == VOTE_OP || m_opcode == ACTIVEMASK_OP;
+  m_uop.m_warp_op = ptx_thread_info::decode_warp_exec_op(this);
+}
+
 void ptx_instruction::pre_decode() {
   pc = m_PC;
   isize = m_inst_size;
@@ -1206,6 +1246,8 @@ void ptx_instruction::pre_decode() {
     }
   }
 
+  set_reg_mask();
+
   // get reconvergence pc
   reconvergence_pc = gpgpu_ctx->func_sim->get_converge_point(pc);
 
@@ -1686,13 +1728,72 @@ static unsigned get_tex_datasize(const ptx_instruction *pI,
   return data_size;
 }
 
-int tensorcore_op(int inst_opcode) {
-  if ((inst_opcode == MMA_OP) || (inst_opcode == MMA_LD_OP) ||
-      (inst_opcode == MMA_ST_OP))
-    return 1;
-  else
-    return 0;
+// Bookkeeping shared by the per-thread and warp-wide execution paths once an
+// instruction has been executed (or skipped) by this thread
+void ptx_thread_info::retire_inst(const ptx_instruction *pI,
+                                  int op_classification) {
+  update_pc();
+  // threads of different clusters retire instructions concurrently
+  unsigned n_insn =
+      __sync_add_and_fetch(&m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn, 1);
+
+  // not using it with functional simulation mode
+  if (!(this->m_functionalSimulationMode) &&
+      m_gpu->gpgpu_ctx->stats->enable_ptx_file_line_stats)
+    ptx_file_line_stats_add_exec_count(pI);
+
+  if (m_gpu->gpgpu_ctx->func_sim->gpgpu_ptx_instruction_classification) {
+    m_gpu->gpgpu_ctx->func_sim->init_inst_classification_stat();
+    unsigned space_type = 0;
+    switch (pI->get_space().get_type()) {
+      case global_space:
+        space_type = 10;
+        break;
+      case local_space:
+        space_type = 11;
+        break;
+      case tex_space:
+        space_type = 12;
+        break;
+      case surf_space:
+        space_type = 13;
+        break;
+      case param_space_kernel:
+      case param_space_local:
+        space_type = 14;
+        break;
+      case shared_space:
+        space_type = 15;
+        break;
+      case const_space:
+        space_type = 16;
+        break;
+      default:
+        space_type = 0;
+        break;
+    }
+    StatAddSample(m_gpu->gpgpu_ctx->func_sim->g_inst_classification_stat
+                      [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
+                  op_classification);
+    if (space_type)
+      StatAddSample(m_gpu->gpgpu_ctx->func_sim->g_inst_classification_stat
+                        [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
+                    (int)space_type);
+    StatAddSample(m_gpu->gpgpu_ctx->func_sim->g_inst_op_classification_stat
+                      [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
+                  (int)pI->get_opcode());
+  }
+  if ((n_insn % 100000) == 0) {
+    dim3 ctaid = get_ctaid();
+    dim3 tid = get_tid();
+    DPRINTF(LIVENESS,
+            "GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) "
+            "tid=(%u,%u,%u)\n",
+            n_insn, ctaid.x, ctaid.y, ctaid.z, tid.x, tid.y, tid.z);
+    fflush(stdout);
+  }
 }
+
 void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
   bool skip = false;
   int op_classification = 0;
@@ -1739,16 +1840,16 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
     if (skip) {
       inst.set_not_active(lane_id);
     } else {
+      const ptx_uop &uop = pI->uop();
       const ptx_instruction *pI_saved = pI;
       ptx_instruction *pJ = NULL;
-      if (pI->get_opcode() == VOTE_OP || pI->get_opcode() == ACTIVEMASK_OP) {
+      if (uop.m_copy_warp_mask) {
         pJ = new ptx_instruction(*pI);
         *((warp_inst_t *)pJ) = inst;  // copy active mask information
         pI = pJ;
       }
 
-      if (((inst_opcode == MMA_OP || inst_opcode == MMA_LD_OP ||
-            inst_opcode == MMA_ST_OP))) {
+      if (uop.m_tensorcore) {
         if (inst.active_count() != MAX_WARP_SIZE) {
           printf(
               "Tensor Core operation are warp synchronous operation. All the "
@@ -1760,27 +1861,29 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
       // Tensorcore is warp synchronous operation. So these instructions needs
       // to be executed only once. To make the simulation faster removing the
       // redundant tensorcore operation
-      if (!tensorcore_op(inst_opcode) ||
-          ((tensorcore_op(inst_opcode)) && (lane_id == 0))) {
-        switch (inst_opcode) {
+      if (!uop.m_tensorcore || lane_id == 0) {
+        if (uop.m_exec) {
+          uop.m_exec(pI, this);
+        } else {
+          switch (inst_opcode) {
 #define OP_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
   case OP:                                         \
     FUNC(pI, this);                                \
-    op_classification = CLASSIFICATION;            \
     break;
 #define OP_W_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
   case OP:                                           \
     FUNC(pI, get_core(), inst);                      \
-    op_classification = CLASSIFICATION;              \
     break;
 #include "opcodes.def"
 #undef OP_DEF
 #undef OP_W_DEF
-          default:
-            printf("Execution error: Invalid opcode (0x%x)\n",
-                   pI->get_opcode());
-            break;
+            default:
+              printf("Execution error: Invalid opcode (0x%x)\n",
+                     pI->get_opcode());
+              break;
+          }
         }
+        op_classification = uop.m_classification;
       }
       delete pJ;
       pI = pI_saved;
@@ -1872,64 +1975,7 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
                                                                    pc))
         dump_regs(stdout);
     }
-    update_pc();
-    m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn++;
-
-    // not using it with functional simulation mode
-    if (!(this->m_functionalSimulationMode))
-      ptx_file_line_stats_add_exec_count(pI);
-
-    if (m_gpu->gpgpu_ctx->func_sim->gpgpu_ptx_instruction_classification) {
-      m_gpu->gpgpu_ctx->func_sim->init_inst_classification_stat();
-      unsigned space_type = 0;
-      switch (pI->get_space().get_type()) {
-        case global_space:
-          space_type = 10;
-          break;
-        case local_space:
-          space_type = 11;
-          break;
-        case tex_space:
-          space_type = 12;
-          break;
-        case surf_space:
-          space_type = 13;
-          break;
-        case param_space_kernel:
-        case param_space_local:
-          space_type = 14;
-          break;
-        case shared_space:
-          space_type = 15;
-          break;
-        case const_space:
-          space_type = 16;
-          break;
-        default:
-          space_type = 0;
-          break;
-      }
-      StatAddSample(m_gpu->gpgpu_ctx->func_sim->g_inst_classification_stat
-                        [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
-                    op_classification);
-      if (space_type)
-        StatAddSample(m_gpu->gpgpu_ctx->func_sim->g_inst_classification_stat
-                          [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
-                      (int)space_type);
-      StatAddSample(m_gpu->gpgpu_ctx->func_sim->g_inst_op_classification_stat
-                        [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
-                    (int)pI->get_opcode());
-    }
-    if ((m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn % 100000) == 0) {
-      dim3 ctaid = get_ctaid();
-      dim3 tid = get_tid();
-      DPRINTF(LIVENESS,
-              "GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) "
-              "tid=(%u,%u,%u)\n",
-              m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn, ctaid.x, ctaid.y,
-              ctaid.z, tid.x, tid.y, tid.z);
-      fflush(stdout);
-    }
+    retire_inst(pI, op_classification);
 
     // "Return values"
     if (!skip) {
@@ -2037,10 +2083,10 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
     }
     char buf[512];
     snprintf(buf, 512, "shared_%u", sid);
-    shared_mem = new memory_space_impl<16 * 1024>(buf, 4);
+    shared_mem = new memory_space_impl<16 * 1024>(buf);
     shared_memory_lookup[sm_idx] = shared_mem;
     snprintf(buf, 512, "sstarr_%u", sid);
-    sstarr_mem = new memory_space_impl<16 * 1024>(buf, 4);
+    sstarr_mem = new memory_space_impl<16 * 1024>(buf);
     sstarr_memory_lookup[sm_idx] = sstarr_mem;
     cta_info = new ptx_cta_info(sm_idx, gpu->gpgpu_ctx);
     ptx_cta_lookup[sm_idx] = cta_info;
@@ -2081,7 +2127,7 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
     } else {
       char buf[512];
       snprintf(buf, 512, "local_%u_%u", sid, new_tid);
-      local_mem = new memory_space_impl<32>(buf, 32);
+      local_mem = new memory_space_impl<32>(buf);
       local_mem_lookup[new_tid] = local_mem;
     }
     thd->set_info(kernel.entry());
@@ -2559,9 +2605,10 @@ void functionalCoreSim::createWarp(unsigned warpId) {
   m_liveThreadCount[warpId] = liveThreadsCount;
 }
 
-void functionalCoreSim::execute(int inst_count, unsigned ctaid_cp) {
-  m_gpu->gpgpu_ctx->func_sim->cp_count = m_gpu->checkpoint_insn_Y;
-  m_gpu->gpgpu_ctx->func_sim->cp_cta_resume = m_gpu->checkpoint_CTA_t;
+// Runs the CTA to completion (or up to the -checkpoint_insn_Y point of a
+// checkpointed CTA) without saving any state; sampled simulation uses this
+// directly to fast-forward CTAs.
+void functionalCoreSim::run(int inst_count, unsigned ctaid_cp) {
   initializeCTA(ctaid_cp);
 
   int count = 0;
@@ -2585,18 +2632,21 @@ void functionalCoreSim::execute(int inst_count, unsigned ctaid_cp) {
       for (unsigned i = 0; i < m_warp_count; i++) m_warpAtBarrier[i] = false;
     }
   }
+}
 
-  checkpoint *g_checkpoint;
-  g_checkpoint = new checkpoint();
-
-  ptx_reg_t regval;
-  regval.u64 = 123;
+void functionalCoreSim::execute(int inst_count, unsigned ctaid_cp) {
+  m_gpu->gpgpu_ctx->func_sim->cp_count = m_gpu->checkpoint_insn_Y;
+  m_gpu->gpgpu_ctx->func_sim->cp_cta_resume = m_gpu->checkpoint_CTA_t;
+  run(inst_count, ctaid_cp);
 
   unsigned ctaid = m_kernel->get_next_cta_id_single();
   if (m_gpu->checkpoint_option == 1 &&
       (m_kernel->get_uid() == m_gpu->checkpoint_kernel) &&
       (ctaid_cp >= m_gpu->checkpoint_CTA) &&
       (ctaid_cp < m_gpu->checkpoint_CTA_t)) {
+    checkpoint *g_checkpoint;
+    g_checkpoint = new checkpoint();
+
     char fname[2048];
     snprintf(fname, 2048, "checkpoint_files/shared_mem_%d.txt", ctaid - 1);
     g_checkpoint->store_global_mem(m_thread[0]->m_shared_mem, fname,
@@ -2634,6 +2684,7 @@ void functionalCoreSim::executeWarp(unsigned i, bool &allAtBarrier,
     warp_inst_t inst = getExecuteWarp(i);
     execute_warp_inst_t(inst, i);
     if (inst.isatomic()) inst.do_atomic(true);
+    m_gpu->sampling_functional_inst(inst);
     if (inst.op == BARRIER_OP || inst.op == MEMORY_BARRIER_OP)
       m_warpAtBarrier[i] = true;
     updateSIMTStack(i, &inst);
@@ -77,6 +77,8 @@ class functionalCoreSim : public core_t {
   }
   //! executes all warps till completion
   void execute(int inst_count, unsigned ctaid_cp);
+  //! same, without saving a -checkpoint_option checkpoint of the CTA
+  void run(int inst_count, unsigned ctaid_cp);
   virtual void warp_exit(unsigned warp_id);
   virtual bool warp_waiting_at_barrier(unsigned warp_id) const {
     return (m_warpAtBarrier[warp_id] || !(m_liveThreadCount[warp_id] > 0));
@@ -128,10 +130,10 @@ class cuda_sim {
     g_assemble_code_next_pc = 0;
     g_debug_thread_uid = 0;
     g_override_embedded_ptx = false;
-    ptx_tex_regs = NULL;
     g_ptx_thread_info_delete_count = 0;
     g_ptx_thread_info_uid_next = 1;
     g_debug_pc = 0xBEEF1518;
+    gpgpu_ptx_predecode = true;
     gpgpu_ctx = ctx;
   }
   // global variables
@@ -166,12 +168,12 @@ class cuda_sim {
   std::set<std::string> g_constants;
   std::map<unsigned, function_info *> g_pc_to_finfo;
   int gpgpu_ptx_instruction_classification;
+  bool gpgpu_ptx_predecode;  // dispatch through ptx_uop::m_exec
   unsigned cdp_latency[5];
   unsigned g_assemble_code_next_pc;
   int g_debug_thread_uid;
   bool g_override_embedded_ptx;
   std::set<unsigned long long> g_ptx_cta_info_sm_idx_used;
-  ptx_reg_t *ptx_tex_regs;
   unsigned g_ptx_thread_info_delete_count;
   unsigned g_ptx_thread_info_uid_next;
   addr_t g_debug_pc;
@@ -171,12 +171,29 @@ void video_mem_instruction(const ptx_instruction *pI, ptx_thread_info *thread, i
 
 void sign_extend(ptx_reg_t &data, unsigned src_size, const operand_info &dst);
 
+// Grow the current register frame to hold every register of func up front,
+// so that set_reg() does not have to resize it in the common case.
+void ptx_thread_info::size_reg_frame(const function_info *func) {
+  assert(!m_regs.empty());
+  if (m_regs.back().size() < func->num_reg_slots())
+    m_regs.back().resize(func->num_reg_slots());
+}
+
+ptx_thread_info::reg_slot_t &ptx_thread_info::reg_slot(const symbol *reg) {
+  assert(!m_regs.empty());
+  reg_frame_t &frame = m_regs.back();
+  unsigned n = reg->reg_num();
+  if (n >= frame.size()) frame.resize(n + 1);
+  return frame[n];
+}
+
 void ptx_thread_info::set_reg(const symbol *reg, const ptx_reg_t &value) {
   assert(reg != NULL);
-  if (reg->name() == "_") return;
-  assert(!m_regs.empty());
+  if (reg->reg_num() == 0) return;  // "_" sink register
   assert(reg->uid() > 0);
-  m_regs.back()[reg] = value;
+  reg_slot_t &slot = reg_slot(reg);
+  slot.m_sym = reg;
+  slot.m_value = value;
   if (m_enable_debug_trace) m_debug_trace_regs_modified.back()[reg] = value;
   m_last_set_operand_value = value;
 }
@@ -188,15 +205,16 @@ void ptx_thread_info::print_reg_thread(char *fname) {
   int size = m_regs.size();
 
   if (size > 0) {
-    reg_map_t reg = m_regs.back();
+    const reg_frame_t &reg = m_regs.back();
 
-    reg_map_t::const_iterator it;
+    reg_frame_t::const_iterator it;
     for (it = reg.begin(); it != reg.end(); ++it) {
-      const std::string &name = it->first->name();
-      const std::string &dec = it->first->decl_location();
-      unsigned size = it->first->get_size_in_bytes();
-      fprintf(fp, "%s %llu %s %d\n", name.c_str(), it->second, dec.c_str(),
-              size);
+      if (it->m_sym == NULL) continue;
+      const std::string &name = it->m_sym->name();
+      const std::string &dec = it->m_sym->decl_location();
+      unsigned size = it->m_sym->get_size_in_bytes();
+      fprintf(fp, "%s %llu %s %d\n", name.c_str(), it->m_value.u64,
+              dec.c_str(), size);
     }
     // m_regs.pop_back();
   }
@@ -206,7 +224,7 @@ void ptx_thread_info::print_reg_thread(char *fname) {
 void ptx_thread_info::resume_reg_thread(char *fname, symbol_table *symtab) {
   FILE *fp2 = fopen(fname, "r");
   assert(fp2 != NULL);
-  // m_regs.push_back( reg_map_t() );
+  // m_regs.push_back( reg_frame_t() );
   char line[200];
   while (fgets(line, sizeof line, fp2) != NULL) {
     symbol *reg;
@@ -219,7 +237,9 @@ void ptx_thread_info::resume_reg_thread(char *fname, symbol_table *symtab) {
     data = atoi(pch);
     pch = strtok(NULL, " ");
     pch = strtok(NULL, " ");
-    m_regs.back()[reg] = data;
+    reg_slot_t &slot = reg_slot(reg);
+    slot.m_sym = reg;
+    slot.m_value = data;
   }
   fclose(fp2);
 }
@@ -227,9 +247,8 @@ void ptx_thread_info::resume_reg_thread(char *fname, symbol_table *symtab) {
 ptx_reg_t ptx_thread_info::get_reg(const symbol *reg) {
   static bool unfound_register_warned = false;
   assert(reg != NULL);
-  assert(!m_regs.empty());
-  reg_map_t::iterator regs_iter = m_regs.back().find(reg);
-  if (regs_iter == m_regs.back().end()) {
+  reg_slot_t *slot = &reg_slot(reg);
+  if (slot->m_sym == NULL) {
     assert(reg->type()->get_key().is_reg());
     const std::string &name = reg->name();
     unsigned call_uid = m_callstack.back().m_call_uid;
@@ -238,20 +257,20 @@ ptx_reg_t ptx_thread_info::get_reg(const symbol *reg) {
     set_reg(reg, uninit_reg);  // give it a value since we are going to warn the
                                // user anyway
     std::string file_loc = get_location();
-    if (!unfound_register_warned) {
+    // warn once, whichever cluster's thread gets here first
+    if (__sync_bool_compare_and_swap(&unfound_register_warned, false, true)) {
       printf(
           "GPGPU-Sim PTX: WARNING (%s) ** reading undefined register \'%s\' "
           "(cuid:%u). Setting to 0X00000000. This is okay if you are "
           "simulating the native ISA"
           "\n",
           file_loc.c_str(), name.c_str(), call_uid);
-      unfound_register_warned = true;
     }
-    regs_iter = m_regs.back().find(reg);
+    slot = &reg_slot(reg);
   }
   if (m_enable_debug_trace)
-    m_debug_trace_regs_read.back()[reg] = regs_iter->second;
-  return regs_iter->second;
+    m_debug_trace_regs_read.back()[reg] = slot->m_value;
+  return slot->m_value;
 }
 
 ptx_reg_t ptx_thread_info::get_operand_value(const operand_info &op,
@@ -531,9 +550,9 @@ void ptx_thread_info::get_vector_operand_values(const operand_info &op,
     const symbol *sym = NULL;
     sym = op.vec_symbol(idx);
     if (strcmp(sym->name().c_str(), "_") != 0) {
-      reg_map_t::iterator reg_iter = m_regs.back().find(sym);
-      assert(reg_iter != m_regs.back().end());
-      ptx_regs[idx] = reg_iter->second;
+      const reg_slot_t &slot = reg_slot(sym);
+      assert(slot.m_sym != NULL);
+      ptx_regs[idx] = slot.m_value;
     }
   }
 }
@@ -568,7 +587,7 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
     ptx_reg_t predValue;
 
     const symbol *sym = dst.vec_symbol(0);
-    predValue.u64 = (m_regs.back()[sym].u64) & ~(0x0C);
+    predValue.u64 = (reg_slot(sym).m_value.u64) & ~(0x0C);
     predValue.u64 |= ((overflow & 0x01) << 3);
     predValue.u64 |= ((carry & 0x01) << 2);
 
@@ -680,10 +699,10 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
       }
 
       if (dst.get_operand_lohi() == 1) {
-        setValue.u64 =
-            ((m_regs.back()[regName].u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
+        setValue.u64 = ((reg_slot(regName).m_value.u64) & (~(0xFFFF))) +
+                       (data.u64 & 0xFFFF);
       } else if (dst.get_operand_lohi() == 2) {
-        setValue.u64 = ((m_regs.back()[regName].u64) & (~(0xFFFF0000))) +
+        setValue.u64 = ((reg_slot(regName).m_value.u64) & (~(0xFFFF0000))) +
                        ((data.u64 << 16) & 0xFFFF0000);
       }
 
@@ -731,11 +750,12 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
       set_reg(name2, setValue2);
     } else {
       if (dst.get_operand_lohi() == 1) {
-        setValue.u64 = ((m_regs.back()[dst.get_symbol()].u64) & (~(0xFFFF))) +
-                       (data.u64 & 0xFFFF);
+        setValue.u64 =
+            ((reg_slot(dst.get_symbol()).m_value.u64) & (~(0xFFFF))) +
+            (data.u64 & 0xFFFF);
       } else if (dst.get_operand_lohi() == 2) {
         setValue.u64 =
-            ((m_regs.back()[dst.get_symbol()].u64) & (~(0xFFFF0000))) +
+            ((reg_slot(dst.get_symbol()).m_value.u64) & (~(0xFFFF0000))) +
             ((data.u64 << 16) & 0xFFFF0000);
       }
       set_reg(dst.get_symbol(), setValue);
@@ -2208,7 +2228,8 @@ void call_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
   }
 
   thread->callstack_push(callee_pc + pI->inst_size(), callee_rpc,
-                         return_var_src, return_var_dst, call_uid_next++);
+                         return_var_src, return_var_dst,
+                         __sync_fetch_and_add(&call_uid_next, 1));
 
   copy_buffer_list_into_frame(thread, arg_values);
 
@@ -2235,7 +2256,8 @@ void callp_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
   }
 
   thread->callstack_push_plus(callee_pc + pI->inst_size(), callee_rpc,
-                              return_var_src, return_var_dst, call_uid_next++);
+                              return_var_src, return_var_dst,
+                         __sync_fetch_and_add(&call_uid_next, 1));
   thread->set_npc(target_pc);
 }
 
@@ -6015,13 +6037,10 @@ void tex_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
   unsigned c_type = pI->get_type2();
   fflush(stdout);
   ptx_reg_t data1, data2, data3, data4;
-  if (!thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs)
-    thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs = new ptx_reg_t[4];
+  ptx_reg_t ptx_tex_regs[4];
   unsigned nelem = src2.get_vect_nelem();
-  thread->get_vector_operand_values(
-      src2, thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs,
-      nelem);  // ptx_reg should be 4 entry vector type...coordinates into
-               // texture
+  // ptx_reg should be 4 entry vector type...coordinates into texture
+  thread->get_vector_operand_values(src2, ptx_tex_regs, nelem);
   /*
     For programs with many streams, textures can be bound and unbound
     asynchronously.  This means we need to use the kernel's "snapshot" of
@@ -6058,7 +6077,7 @@ void tex_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
       height = cuArray->height;
       if (texref->normalized) {
         assert(c_type == F32_TYPE);
-        x_f32 = thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[0].f32;
+        x_f32 = ptx_tex_regs[0].f32;
         if (texref->addressMode[0] == cudaAddressModeClamp) {
           x_f32 = (x_f32 > 1.0) ? 1.0 : x_f32;
           x_f32 = (x_f32 < 0.0) ? 0.0 : x_f32;
@@ -6081,11 +6100,11 @@ void tex_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
       } else {
         switch (c_type) {
           case S32_TYPE:
-            x = thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[0].s32;
+            x = ptx_tex_regs[0].s32;
             assert(texref->filterMode == cudaFilterModePoint);
             break;
           case F32_TYPE:
-            x_f32 = thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[0].f32;
+            x_f32 = ptx_tex_regs[0].f32;
             alpha = x_f32 -
                     floor(x_f32);  // offset into subtexel (for linear sampling)
             x = (int)x_f32;
@@ -6114,10 +6133,8 @@ void tex_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
       width = cuArray->width;
       height = cuArray->height;
       if (texref->normalized) {
-        x_f32 = reduce_precision(
-            thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[0].f32, 16);
-        y_f32 = reduce_precision(
-            thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[1].f32, 15);
+        x_f32 = reduce_precision(ptx_tex_regs[0].f32, 16);
+        y_f32 = reduce_precision(ptx_tex_regs[1].f32, 15);
 
         if (texref->addressMode[0]) {  // clamp
           if (x_f32 < 0) x_f32 = 0;
@@ -6147,8 +6164,8 @@ void tex_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
           y = (int)floor(y_f32 * height);
         }
       } else {
-        x_f32 = thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[0].f32;
-        y_f32 = thread->get_gpu()->gpgpu_ctx->func_sim->ptx_tex_regs[1].f32;
+        x_f32 = ptx_tex_regs[0].f32;
+        y_f32 = ptx_tex_regs[1].f32;
 
         alpha = x_f32 - floor(x_f32);
         beta = y_f32 - floor(y_f32);
@@ -6361,12 +6378,13 @@ void vsub_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
 }
 
 void vote_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
-  static bool first_in_warp = true;
-  static bool and_all;
-  static bool or_all;
-  static unsigned int ballot_result;
-  static std::list<ptx_thread_info *> threads_in_warp;
-  static unsigned last_tid;
+  // a warp's lanes all run on the host thread ticking its cluster
+  static thread_local bool first_in_warp = true;
+  static thread_local bool and_all;
+  static thread_local bool or_all;
+  static thread_local unsigned int ballot_result;
+  static thread_local std::list<ptx_thread_info *> threads_in_warp;
+  static thread_local unsigned last_tid;
 
   if (first_in_warp) {
     first_in_warp = false;
@@ -32,10 +32,12 @@
 #include "../debug.h"
 
 template <unsigned BSIZE>
-memory_space_impl<BSIZE>::memory_space_impl(std::string name,
-                                            unsigned hash_size) {
+memory_space_impl<BSIZE>::memory_space_impl(std::string name) {
   m_name = name;
-  MEM_MAP_RESIZE(hash_size);
+  m_chunk_blocks = 0;
+  m_chunk_used = 0;
+  m_table = new table_dir();
+  pthread_mutex_init(&m_lock, NULL);
 
   m_log2_block_size = -1;
   for (unsigned n = 0, mask = 1; mask != 0; mask <<= 1, n++) {
@@ -47,10 +49,120 @@ memory_space_impl<BSIZE>::memory_space_impl(std::string name,
   assert(m_log2_block_size != (unsigned)-1);
 }
 
+template <unsigned BSIZE>
+memory_space_impl<BSIZE>::~memory_space_impl() {
+  for (unsigned i = 0; i < m_table->leaves.size(); i++)
+    free(m_table->leaves[i]);
+  delete m_table;
+  for (unsigned i = 0; i < m_old_tables.size(); i++) delete m_old_tables[i];
+  for (unsigned i = 0; i < m_chunks.size(); i++) free(m_chunks[i]);
+  for (unsigned i = 0; i < m_bulk_chunks.size(); i++) free(m_bulk_chunks[i]);
+  pthread_mutex_destroy(&m_lock);
+}
+
+template <unsigned BSIZE>
+void memory_space_impl<BSIZE>::set_block(mem_addr_t blk_idx,
+                                         unsigned char *block) {
+  mem_addr_t dir = blk_idx >> MEM_TABLE_LEAF_BITS;
+  table_dir *table = m_table;
+  if (dir >= table->leaves.size()) {
+    table_dir *grown = new table_dir(*table);
+    grown->leaves.resize(dir + 1, NULL);
+    __sync_synchronize();
+    m_table = grown;
+    m_old_tables.push_back(table);
+    table = grown;
+  }
+  if (table->leaves[dir] == NULL) {
+    unsigned char **leaf = (unsigned char **)calloc(1 << MEM_TABLE_LEAF_BITS,
+                                                    sizeof(unsigned char *));
+    __sync_synchronize();
+    table->leaves[dir] = leaf;
+  }
+  // the block was zeroed by calloc; make that visible before the pointer
+  __sync_synchronize();
+  table->leaves[dir][blk_idx & ((1 << MEM_TABLE_LEAF_BITS) - 1)] = block;
+}
+
+template <unsigned BSIZE>
+unsigned char *memory_space_impl<BSIZE>::new_block(mem_addr_t blk_idx) {
+  if (m_chunk_used == m_chunk_blocks) {
+    // double the chunk each time, starting from a single block
+    unsigned max_blocks = MEM_CHUNK_MAX_BYTES / BSIZE;
+    if (max_blocks == 0) max_blocks = 1;
+    m_chunk_blocks = m_chunks.empty() ? 1 : 2 * m_chunk_blocks;
+    if (m_chunk_blocks > max_blocks) m_chunk_blocks = max_blocks;
+    m_chunks.push_back((unsigned char *)calloc(m_chunk_blocks, BSIZE));
+    m_chunk_used = 0;
+  }
+  unsigned char *block = m_chunks.back() + (size_t)m_chunk_used * BSIZE;
+  m_chunk_used++;
+  set_block(blk_idx, block);
+  return block;
+}
+
+template <unsigned BSIZE>
+unsigned char *memory_space_impl<BSIZE>::alloc_block(mem_addr_t blk_idx) {
+  pthread_mutex_lock(&m_lock);
+  // another thread may have backed the block since the caller looked
+  unsigned char *block = find_block(blk_idx);
+  if (block == NULL) block = new_block(blk_idx);
+  pthread_mutex_unlock(&m_lock);
+  return block;
+}
+
+// Backs up to n unallocated blocks starting at blk_idx with one contiguous
+// chunk, so large copies see a single span instead of one per block.
+template <unsigned BSIZE>
+unsigned char *memory_space_impl<BSIZE>::alloc_blocks(mem_addr_t blk_idx,
+                                                      mem_addr_t n) {
+  pthread_mutex_lock(&m_lock);
+  unsigned char *chunk = find_block(blk_idx);
+  if (chunk == NULL) {
+    mem_addr_t run = 1;
+    while (run < n && find_block(blk_idx + run) == NULL) run++;
+    if (run * BSIZE <= MEM_CHUNK_MAX_BYTES) {
+      chunk = new_block(blk_idx);
+    } else {
+      chunk = (unsigned char *)calloc(run, BSIZE);
+      m_bulk_chunks.push_back(chunk);
+      for (mem_addr_t b = 0; b < run; b++)
+        set_block(blk_idx + b, chunk + (size_t)b * BSIZE);
+    }
+  }
+  pthread_mutex_unlock(&m_lock);
+  return chunk;
+}
+
+template <unsigned BSIZE>
+void memory_space_impl<BSIZE>::map(mem_addr_t addr, size_t length, bool alloc,
+                                   std::vector<mem_span> &spans) {
+  spans.clear();
+  while (length > 0) {
+    mem_addr_t blk_idx = addr >> m_log2_block_size;
+    size_t offset = addr & (BSIZE - 1);
+    size_t n = BSIZE - offset;
+    if (n > length) n = length;
+    unsigned char *block = find_block(blk_idx);
+    if (block == NULL && alloc)
+      block = alloc_blocks(blk_idx, (offset + length + BSIZE - 1) / BSIZE);
+    unsigned char *data = block ? block + offset : NULL;
+    mem_span *last = spans.empty() ? NULL : &spans.back();
+    if (last && (data ? last->data && last->data + last->length == data
+                      : last->data == NULL))
+      last->length += n;
+    else
+      spans.push_back(mem_span(data, n));
+    addr += n;
+    length -= n;
+  }
+}
+
 template <unsigned BSIZE>
 void memory_space_impl<BSIZE>::write_only(mem_addr_t offset, mem_addr_t index,
                                           size_t length, const void *data) {
-  m_data[index].write(offset, length, (const unsigned char *)data);
+  assert(offset + length <= BSIZE);
+  memcpy(get_block(index) + offset, data, length);
 }
 
 template <unsigned BSIZE>
@@ -63,25 +175,24 @@ void memory_space_impl<BSIZE>::write(mem_addr_t addr, size_t length,
   if ((addr + length) <= (index + 1) * BSIZE) {
     // fast route for intra-block access
     unsigned offset = addr & (BSIZE - 1);
-    unsigned nbytes = length;
-    m_data[index].write(offset, nbytes, (const unsigned char *)data);
+    memcpy(get_block(index) + offset, data, length);
   } else {
     // slow route for inter-block access
-    unsigned nbytes_remain = length;
-    unsigned src_offset = 0;
+    size_t nbytes_remain = length;
+    size_t src_offset = 0;
     mem_addr_t current_addr = addr;
 
     while (nbytes_remain > 0) {
       unsigned offset = current_addr & (BSIZE - 1);
       mem_addr_t page = current_addr >> m_log2_block_size;
-      mem_addr_t access_limit = offset + nbytes_remain;
+      size_t access_limit = offset + nbytes_remain;
       if (access_limit > BSIZE) {
         access_limit = BSIZE;
       }
 
       size_t tx_bytes = access_limit - offset;
-      m_data[page].write(offset, tx_bytes,
-                         &((const unsigned char *)data)[src_offset]);
+      memcpy(get_block(page) + offset,
+             &((const unsigned char *)data)[src_offset], tx_bytes);
 
       // advance pointers
       src_offset += tx_bytes;
@@ -117,16 +228,14 @@ void memory_space_impl<BSIZE>::read_single_block(mem_addr_t blk_idx,
         (addr + length), (blk_idx + 1) * BSIZE, blk_idx, BSIZE);
     throw 1;
   }
-  typename map_t::const_iterator i = m_data.find(blk_idx);
-  if (i == m_data.end()) {
-    for (size_t n = 0; n < length; n++)
-      ((unsigned char *)data)[n] = (unsigned char)0;
+  const unsigned char *block = find_block(blk_idx);
+  if (block == NULL) {
+    memset(data, 0, length);
     // printf("GPGPU-Sim PTX:  WARNING reading %zu bytes from unititialized
     // memory at address 0x%x in space %s\n", length, addr, m_name.c_str() );
   } else {
     unsigned offset = addr & (BSIZE - 1);
-    unsigned nbytes = length;
-    i->second.read(offset, nbytes, (unsigned char *)data);
+    memcpy(data, block + offset, length);
   }
 }
 
@@ -139,14 +248,14 @@ void memory_space_impl<BSIZE>::read(mem_addr_t addr, size_t length,
     read_single_block(index, addr, length, data);
   } else {
     // slow route for inter-block access
-    unsigned nbytes_remain = length;
-    unsigned dst_offset = 0;
+    size_t nbytes_remain = length;
+    size_t dst_offset = 0;
     mem_addr_t current_addr = addr;
 
     while (nbytes_remain > 0) {
       unsigned offset = current_addr & (BSIZE - 1);
       mem_addr_t page = current_addr >> m_log2_block_size;
-      mem_addr_t access_limit = offset + nbytes_remain;
+      size_t access_limit = offset + nbytes_remain;
       if (access_limit > BSIZE) {
         access_limit = BSIZE;
       }
@@ -166,11 +275,22 @@ void memory_space_impl<BSIZE>::read(mem_addr_t addr, size_t length,
 
 template <unsigned BSIZE>
 void memory_space_impl<BSIZE>::print(const char *format, FILE *fout) const {
-  typename map_t::const_iterator i_page;
-
-  for (i_page = m_data.begin(); i_page != m_data.end(); ++i_page) {
-    fprintf(fout, "%s %08x:", m_name.c_str(), i_page->first);
-    i_page->second.print(format, fout);
+  const table_dir *table = m_table;
+  for (mem_addr_t dir = 0; dir < table->leaves.size(); dir++) {
+    if (table->leaves[dir] == NULL) continue;
+    for (unsigned b = 0; b < (1 << MEM_TABLE_LEAF_BITS); b++) {
+      const unsigned int *i_data = (const unsigned int *)table->leaves[dir][b];
+      if (i_data == NULL) continue;
+      fprintf(fout, "%s %08x:", m_name.c_str(),
+              (dir << MEM_TABLE_LEAF_BITS) | b);
+      for (unsigned d = 0; d < (BSIZE / sizeof(unsigned int)); d++) {
+        fprintf(fout, "\n");
+        fprintf(fout, format, i_data[d]);
+        fprintf(fout, " ");
+      }
+      fprintf(fout, "\n");
+      fflush(fout);
+    }
   }
 }
 
@@ -184,6 +304,58 @@ template class memory_space_impl<64>;
 template class memory_space_impl<8192>;
 template class memory_space_impl<16 * 1024>;
 
+void mem_spans_write(const std::vector<mem_span> &spans, const void *src) {
+  const unsigned char *p = (const unsigned char *)src;
+  for (unsigned i = 0; i < spans.size(); i++) {
+    assert(spans[i].data);
+    memcpy(spans[i].data, p, spans[i].length);
+    p += spans[i].length;
+  }
+}
+
+void mem_spans_read(const std::vector<mem_span> &spans, void *dst) {
+  unsigned char *p = (unsigned char *)dst;
+  for (unsigned i = 0; i < spans.size(); i++) {
+    if (spans[i].data)
+      memcpy(p, spans[i].data, spans[i].length);
+    else
+      memset(p, 0, spans[i].length);
+    p += spans[i].length;
+  }
+}
+
+void mem_spans_copy(const std::vector<mem_span> &dst,
+                    const std::vector<mem_span> &src) {
+  unsigned d = 0, s = 0;
+  size_t d_off = 0, s_off = 0;
+  while (d < dst.size() && s < src.size()) {
+    size_t n = dst[d].length - d_off;
+    if (n > src[s].length - s_off) n = src[s].length - s_off;
+    assert(dst[d].data);
+    if (src[s].data)
+      memmove(dst[d].data + d_off, src[s].data + s_off, n);
+    else
+      memset(dst[d].data + d_off, 0, n);
+    d_off += n;
+    s_off += n;
+    if (d_off == dst[d].length) {
+      d++;
+      d_off = 0;
+    }
+    if (s_off == src[s].length) {
+      s++;
+      s_off = 0;
+    }
+  }
+}
+
+void mem_spans_fill(const std::vector<mem_span> &spans, unsigned char value) {
+  for (unsigned i = 0; i < spans.size(); i++) {
+    assert(spans[i].data);
+    memset(spans[i].data, value, spans[i].length);
+  }
+}
+
 void g_print_memory_space(memory_space *mem, const char *format = "%08x",
                           FILE *fout = stdout) {
   mem->print(format, fout);
@@ -193,7 +365,7 @@ void g_print_memory_space(memory_space *mem, const char *format = "%08x",
 
 int main(int argc, char *argv[]) {
   int errors_found = 0;
-  memory_space *mem = new memory_space_impl<32>("test", 4);
+  memory_space *mem = new memory_space_impl<32>("test");
   // write address to [address]
   for (mem_addr_t addr = 0; addr < 16 * 1024; addr += 4)
     mem->write(addr, 4, &addr, NULL, NULL);
@@ -31,69 +31,52 @@
 
 #include "../abstract_hardware_model.h"
 
-#include "../tr1_hash_map.h"
-#define mem_map tr1_hash_map
-#if tr1_hash_map_ismap == 1
-#define MEM_MAP_RESIZE(hash_size)
-#else
-#define MEM_MAP_RESIZE(hash_size) (m_data.rehash(hash_size))
-#endif
-
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <map>
 #include <string>
+#include <vector>
 
 typedef address_type mem_addr_t;
 
 #define MEM_BLOCK_SIZE (4 * 1024)
 
-template <unsigned BSIZE>
-class mem_storage {
- public:
-  mem_storage(const mem_storage &another) {
-    m_data = (unsigned char *)calloc(1, BSIZE);
-    memcpy(m_data, another.m_data, BSIZE);
-  }
-  mem_storage() { m_data = (unsigned char *)calloc(1, BSIZE); }
-  ~mem_storage() { free(m_data); }
-
-  void write(unsigned offset, size_t length, const unsigned char *data) {
-    assert(offset + length <= BSIZE);
-    memcpy(m_data + offset, data, length);
-  }
+// Block storage is carved out of zeroed chunks that grow geometrically up to
+// this size, so small spaces (e.g. per-thread local memory) stay small.
+#define MEM_CHUNK_MAX_BYTES (64 * 1024)
+// log2 of the number of block pointers per leaf of the block table
+#define MEM_TABLE_LEAF_BITS 8
 
-  void read(unsigned offset, size_t length, unsigned char *data) const {
-    assert(offset + length <= BSIZE);
-    memcpy(data, m_data + offset, length);
-  }
-
-  void print(const char *format, FILE *fout) const {
-    unsigned int *i_data = (unsigned int *)m_data;
-    for (int d = 0; d < (BSIZE / sizeof(unsigned int)); d++) {
-      if (d % 1 == 0) {
-        fprintf(fout, "\n");
-      }
-      fprintf(fout, format, i_data[d]);
-      fprintf(fout, " ");
-    }
-    fprintf(fout, "\n");
-    fflush(fout);
-  }
+class ptx_thread_info;
+class ptx_instruction;
 
- private:
-  unsigned m_nbytes;
-  unsigned char *m_data;
+// A run of contiguous backing storage.  data is NULL for a hole that was never
+// written and reads as zero.
+struct mem_span {
+  mem_span(unsigned char *d, size_t n) : data(d), length(n) {}
+  unsigned char *data;
+  size_t length;
 };
 
-class ptx_thread_info;
-class ptx_instruction;
+// Bulk copies between host buffers and storage described by
+// memory_space::map().
+void mem_spans_write(const std::vector<mem_span> &spans, const void *src);
+void mem_spans_read(const std::vector<mem_span> &spans, void *dst);
+void mem_spans_copy(const std::vector<mem_span> &dst,
+                    const std::vector<mem_span> &src);
+void mem_spans_fill(const std::vector<mem_span> &spans, unsigned char value);
 
 class memory_space {
  public:
   virtual ~memory_space() {}
+  // Describes [addr, addr+length) as runs of backing storage, allocating
+  // missing blocks when alloc is set.  Blocks never move once allocated, so
+  // the spans may be used from another thread while the space is in use.
+  virtual void map(mem_addr_t addr, size_t length, bool alloc,
+                   std::vector<mem_span> &spans) = 0;
   virtual void write(mem_addr_t addr, size_t length, const void *data,
                      ptx_thread_info *thd, const ptx_instruction *pI) = 0;
   virtual void write_only(mem_addr_t index, mem_addr_t offset, size_t length,
@@ -106,24 +89,63 @@ class memory_space {
 template <unsigned BSIZE>
 class memory_space_impl : public memory_space {
  public:
-  memory_space_impl(std::string name, unsigned hash_size);
+  memory_space_impl(std::string name);
+  virtual ~memory_space_impl();
 
   virtual void write(mem_addr_t addr, size_t length, const void *data,
                      ptx_thread_info *thd, const ptx_instruction *pI);
   virtual void write_only(mem_addr_t index, mem_addr_t offset, size_t length,
                           const void *data);
   virtual void read(mem_addr_t addr, size_t length, void *data) const;
+  virtual void map(mem_addr_t addr, size_t length, bool alloc,
+                   std::vector<mem_span> &spans);
   virtual void print(const char *format, FILE *fout) const;
 
   virtual void set_watch(addr_t addr, unsigned watchpoint);
 
  private:
+  // not copyable: owns its block storage
+  memory_space_impl(const memory_space_impl &);
+  memory_space_impl &operator=(const memory_space_impl &);
+
   void read_single_block(mem_addr_t blk_idx, mem_addr_t addr, size_t length,
                          void *data) const;
+
+  // Two-level radix table over block indices: leaves[blk_idx >> LEAF_BITS]
+  // is a leaf of block pointers, NULL for blocks never written (which read
+  // as zero).  Global memory is written from the -gpgpu_sim_threads workers
+  // (atomics executed in the L2 sub-partitions), so lookups take no lock: a
+  // leaf or block is published only once it is zeroed, and a directory that
+  // has to grow is replaced by a larger copy rather than resized in place.
+  // Allocation is serialized by m_lock.
+  struct table_dir {
+    std::vector<unsigned char **> leaves;
+  };
+  unsigned char *find_block(mem_addr_t blk_idx) const {
+    const table_dir *table = m_table;
+    mem_addr_t dir = blk_idx >> MEM_TABLE_LEAF_BITS;
+    if (dir >= table->leaves.size() || table->leaves[dir] == NULL) return NULL;
+    return table->leaves[dir][blk_idx & ((1 << MEM_TABLE_LEAF_BITS) - 1)];
+  }
+  unsigned char *get_block(mem_addr_t blk_idx) {
+    unsigned char *block = find_block(blk_idx);
+    return block ? block : alloc_block(blk_idx);
+  }
+  unsigned char *alloc_block(mem_addr_t blk_idx);
+  unsigned char *alloc_blocks(mem_addr_t blk_idx, mem_addr_t n);
+  // with m_lock held
+  unsigned char *new_block(mem_addr_t blk_idx);
+  void set_block(mem_addr_t blk_idx, unsigned char *block);
+
   std::string m_name;
   unsigned m_log2_block_size;
-  typedef mem_map<mem_addr_t, mem_storage<BSIZE> > map_t;
-  map_t m_data;
+  table_dir *volatile m_table;
+  std::vector<table_dir *> m_old_tables;  // may still be read, freed with us
+  pthread_mutex_t m_lock;
+  std::vector<unsigned char *> m_chunks;
+  std::vector<unsigned char *> m_bulk_chunks;  // whole runs from alloc_blocks
+  unsigned m_chunk_blocks;  // blocks in the current chunk
+  unsigned m_chunk_used;    // blocks handed out from the current chunk
   std::map<unsigned, mem_addr_t> m_watchpoints;
 };
 
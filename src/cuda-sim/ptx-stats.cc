@@ -27,8 +27,10 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "ptx-stats.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <map>
+#include <vector>
 #include "../../libcuda/gpgpu_context.h"
 #include "../option_parser.h"
 #include "../tr1_hash_map.h"
@@ -105,6 +107,18 @@ class ptx_file_line_stats {
                                        // (attributed to this instruction)
   unsigned long long
       warp_divergence;  // number of warp divergence occured at this instruction
+
+  void add(const ptx_file_line_stats &other) {
+    exec_count += other.exec_count;
+    latency += other.latency;
+    dram_traffic += other.dram_traffic;
+    smem_n_way_bank_conflict_total += other.smem_n_way_bank_conflict_total;
+    smem_warp_count += other.smem_warp_count;
+    gmem_n_access_total += other.gmem_n_access_total;
+    gmem_warp_count += other.gmem_warp_count;
+    exposed_latency += other.exposed_latency;
+    warp_divergence += other.warp_divergence;
+  }
 };
 
 #if (tr1_hash_map_ismap == 1)
@@ -121,14 +135,44 @@ typedef tr1_hash_map<ptx_file_line, ptx_file_line_stats, hash_ptx_file_line>
     ptx_file_line_stats_map_t;
 #endif
 
-static ptx_file_line_stats_map_t ptx_file_line_stats_tracker;
+// The counts come from whichever -gpgpu_sim_threads worker ticks the unit
+// that executed the instruction, so each host thread counts into a map of
+// its own; the maps are summed when the file is written.
+static pthread_mutex_t ptx_file_line_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<ptx_file_line_stats_map_t *> ptx_file_line_stats_trackers;
+static thread_local ptx_file_line_stats_map_t *ptx_file_line_stats_tracker =
+    NULL;
+
+// statistics of the source line of pInsn, as seen by the calling thread
+static ptx_file_line_stats &ptx_file_line_stats_of(
+    const ptx_instruction *pInsn) {
+  if (ptx_file_line_stats_tracker == NULL) {
+    ptx_file_line_stats_tracker = new ptx_file_line_stats_map_t();
+    pthread_mutex_lock(&ptx_file_line_stats_lock);
+    ptx_file_line_stats_trackers.push_back(ptx_file_line_stats_tracker);
+    pthread_mutex_unlock(&ptx_file_line_stats_lock);
+  }
+  return (*ptx_file_line_stats_tracker)[ptx_file_line(pInsn->source_file(),
+                                                      pInsn->source_line())];
+}
 
 // output statistics to a file
 void ptx_stats::ptx_file_line_stats_write_file() {
   // check if stat collection is turned on
   if (enable_ptx_file_line_stats == 0) return;
 
-  ptx_file_line_stats_map_t::iterator it;
+  // sorted by file and line, whichever threads the counts came from
+  std::map<ptx_file_line, ptx_file_line_stats> merged;
+  pthread_mutex_lock(&ptx_file_line_stats_lock);
+  for (unsigned t = 0; t < ptx_file_line_stats_trackers.size(); t++) {
+    ptx_file_line_stats_map_t::const_iterator i;
+    for (i = ptx_file_line_stats_trackers[t]->begin();
+         i != ptx_file_line_stats_trackers[t]->end(); i++)
+      merged[i->first].add(i->second);
+  }
+  pthread_mutex_unlock(&ptx_file_line_stats_lock);
+
+  std::map<ptx_file_line, ptx_file_line_stats>::iterator it;
   FILE *pfile;
 
   pfile = fopen(ptx_line_stats_filename, "w");
@@ -136,8 +180,7 @@ void ptx_stats::ptx_file_line_stats_write_file() {
       pfile,
       "kernel line : count latency dram_traffic smem_bk_conflicts smem_warp "
       "gmem_access_generated gmem_warp exposed_latency warp_divergence\n");
-  for (it = ptx_file_line_stats_tracker.begin();
-       it != ptx_file_line_stats_tracker.end(); it++) {
+  for (it = merged.begin(); it != merged.end(); it++) {
     fprintf(pfile, "%s %i : ", it->first.st.c_str(), it->first.line);
     fprintf(pfile, "%lu ", it->second.exec_count);
     fprintf(pfile, "%llu ", it->second.latency);
@@ -157,33 +200,29 @@ void ptx_stats::ptx_file_line_stats_write_file() {
 // attribute one more execution count to this ptx instruction
 // counting the number of threads (not warps) executing this instruction
 void ptx_file_line_stats_add_exec_count(const ptx_instruction *pInsn) {
-  ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                            pInsn->source_line())]
-      .exec_count += 1;
+  ptx_file_line_stats_of(pInsn).exec_count += 1;
 }
 
 // attribute pipeline latency to this ptx instruction (specified by the pc)
 // pipeline latency is the number of cycles a warp with this instruction spent
 // in the pipeline
 void ptx_stats::ptx_file_line_stats_add_latency(unsigned pc, unsigned latency) {
+  if (!enable_ptx_file_line_stats) return;
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL)
-    ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                              pInsn->source_line())]
-        .latency += latency;
+    ptx_file_line_stats_of(pInsn).latency += latency;
 }
 
 // attribute dram traffic to this ptx instruction (specified by the pc)
 // dram traffic is counted in number of requests
 void ptx_stats::ptx_file_line_stats_add_dram_traffic(unsigned pc,
                                                      unsigned dram_traffic) {
+  if (!enable_ptx_file_line_stats) return;
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL)
-    ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                              pInsn->source_line())]
-        .dram_traffic += dram_traffic;
+    ptx_file_line_stats_of(pInsn).dram_traffic += dram_traffic;
 }
 
 // attribute the number of shared memory access cycles to a ptx instruction
@@ -191,11 +230,11 @@ void ptx_stats::ptx_file_line_stats_add_dram_traffic(unsigned pc,
 // cycles involved
 void ptx_stats::ptx_file_line_stats_add_smem_bank_conflict(
     unsigned pc, unsigned n_way_bkconflict) {
+  if (!enable_ptx_file_line_stats) return;
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL) {
-    ptx_file_line_stats &line_stats = ptx_file_line_stats_tracker[ptx_file_line(
-        pInsn->source_file(), pInsn->source_line())];
+    ptx_file_line_stats &line_stats = ptx_file_line_stats_of(pInsn);
     line_stats.smem_n_way_bank_conflict_total += n_way_bkconflict;
     line_stats.smem_warp_count += 1;
   }
@@ -206,11 +245,11 @@ void ptx_stats::ptx_file_line_stats_add_smem_bank_conflict(
 // requests generated
 void ptx_stats::ptx_file_line_stats_add_uncoalesced_gmem(unsigned pc,
                                                          unsigned n_access) {
+  if (!enable_ptx_file_line_stats) return;
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL) {
-    ptx_file_line_stats &line_stats = ptx_file_line_stats_tracker[ptx_file_line(
-        pInsn->source_file(), pInsn->source_line())];
+    ptx_file_line_stats &line_stats = ptx_file_line_stats_of(pInsn);
     line_stats.gmem_n_access_total += n_access;
     line_stats.gmem_warp_count += 1;
   }
@@ -246,9 +285,7 @@ class ptx_inflight_memory_insn_tracker {
     i_exlatinsn = exlat_insnmap.begin();
     for (; i_exlatinsn != exlat_insnmap.end(); ++i_exlatinsn) {
       const ptx_instruction *pInsn = i_exlatinsn->first;
-      ptx_file_line_stats &line_stats =
-          ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                                    pInsn->source_line())];
+      ptx_file_line_stats &line_stats = ptx_file_line_stats_of(pInsn);
       line_stats.exposed_latency += count;
     }
   }
@@ -289,9 +326,9 @@ void ptx_file_line_stats_commit_exposed_latency(int sc_id,
 // attribute the number of warp divergence to a ptx instruction
 void ptx_stats::ptx_file_line_stats_add_warp_divergence(
     unsigned pc, unsigned n_way_divergence) {
+  if (!enable_ptx_file_line_stats) return;
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
-  ptx_file_line_stats &line_stats = ptx_file_line_stats_tracker[ptx_file_line(
-      pInsn->source_file(), pInsn->source_line())];
+  ptx_file_line_stats &line_stats = ptx_file_line_stats_of(pInsn);
   line_stats.warp_divergence += n_way_divergence;
 }
@@ -602,6 +602,20 @@ bool function_info::connect_break_targets()  // connecting break instructions
 
   return modified;
 }
+bool function_info::needs_serial_clusters() const {
+  std::list<ptx_instruction *>::const_iterator i;
+  for (i = m_instructions.begin(); i != m_instructions.end(); i++) {
+    const ptx_instruction *pI = *i;
+    if (pI->get_opcode() == CALL_OP || pI->get_opcode() == CALLP_OP)
+      return true;
+    if (pI->get_opcode() == BAR_OP) {
+      for (unsigned n = 0; n < pI->get_num_operands(); n++)
+        if (pI->operand_lookup(n).is_reg()) return true;
+    }
+  }
+  return false;
+}
+
 void function_info::do_pdom() {
   create_basic_blocks();
   connect_basic_blocks();
@@ -1494,6 +1508,7 @@ function_info::function_info(int entry_point, gpgpu_context *ctx) {
   m_kernel_info.regs = 0;
   m_kernel_info.smem = 0;
   m_local_mem_framesize = 0;
+  m_num_reg_slots = 0;
   m_args_aligned_size = -1;
   pdom_done = false;  // initialize it to false
 }
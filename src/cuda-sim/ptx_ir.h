@@ -325,6 +325,7 @@ class symbol_table {
   type_info *get_array_type(type_info *base_type, unsigned array_dim);
   void set_label_address(const symbol *label, unsigned addr);
   unsigned next_reg_num() { return ++m_reg_allocator; }
+  unsigned reg_count() const { return m_reg_allocator; }
   addr_t get_shared_next() { return m_shared_next; }
   addr_t get_sstarr_next() { return m_sstarr_next; }
   addr_t get_global_next() { return m_global_next; }
@@ -934,6 +935,27 @@ struct gpgpu_recon_t {
   class ptx_instruction *target_inst;
 };
 
+typedef void (*ptx_exec_fn)(const class ptx_instruction *pI,
+                            class ptx_thread_info *thread);
+
+// Execution record resolved once per instruction by
+// function_info::ptx_assemble() so that the interpreter dispatches straight
+// to the handler instead of switching on the opcode every time.
+struct ptx_uop {
+  ptx_uop()
+      : m_exec(NULL),
+        m_classification(0),
+        m_warp_op(-1),
+        m_tensorcore(false),
+        m_copy_warp_mask(false) {}
+
+  ptx_exec_fn m_exec;     // NULL for opcodes implemented at warp level
+  int m_classification;   // CLASSIFICATION column of opcodes.def
+  int m_warp_op;          // lane kernel of the warp-wide path, -1 if none
+  bool m_tensorcore;      // warp synchronous, executed by lane 0 only
+  bool m_copy_warp_mask;  // vote/activemask read the warp's active mask
+};
+
 class ptx_instruction : public warp_inst_t {
  public:
   ptx_instruction(int opcode, const symbol *pred, int neg_pred, int pred_mod,
@@ -950,6 +972,8 @@ class ptx_instruction : public warp_inst_t {
   unsigned inst_size() const { return m_inst_size; }
   unsigned uid() const { return m_uid; }
   int get_opcode() const { return m_opcode; }
+  const ptx_uop &uop() const { return m_uop; }
+  void build_uop();
   const char *get_opcode_cstr() const {
     if (m_opcode != -1) {
       return g_opcode_string[m_opcode];
@@ -1172,6 +1196,7 @@ class ptx_instruction : public warp_inst_t {
   int m_membar_level;
   int m_instr_mem_index;  // index into m_instr_mem array
   unsigned m_inst_size;   // bytes
+  ptx_uop m_uop;
 
   virtual void pre_decode();
   friend class function_info;
@@ -1301,6 +1326,11 @@ class function_info {
 
   unsigned get_function_size() { return m_instructions.size(); }
 
+  // true if running the function on concurrently ticked clusters could race:
+  // a bar with register operands stores each CTA's barrier id and count in
+  // the shared ptx_instruction, and calls leave the instructions scanned here
+  bool needs_serial_clusters() const;
+
   void ptx_assemble();
 
   unsigned ptx_get_inst_op(ptx_thread_info *thread);
@@ -1355,6 +1385,8 @@ class function_info {
 
   unsigned local_mem_framesize() const { return m_local_mem_framesize; }
   void set_framesize(unsigned sz) { m_local_mem_framesize = sz; }
+  // size of a register frame for this function (indexed by reg_num())
+  unsigned num_reg_slots() const { return m_num_reg_slots; }
   bool is_entry_point() const { return m_entry_point; }
   bool is_pdom_set() const { return pdom_done; }  // return pdom flag
   void set_pdom() { pdom_done = true; }           // set pdom flag
@@ -1389,6 +1421,7 @@ class function_info {
   unsigned maxnt_id;
   unsigned m_uid;
   unsigned m_local_mem_framesize;
+  unsigned m_num_reg_slots;
   bool m_entry_point;
   bool m_extern;
   bool m_assembled;
@@ -173,7 +173,7 @@ ptx_thread_info::ptx_thread_info(kernel_info_t &kernel) : m_kernel(kernel) {
   m_hw_sid = -1;
   m_last_dram_callback.function = NULL;
   m_last_dram_callback.instruction = NULL;
-  m_regs.push_back(reg_map_t());
+  m_regs.push_back(reg_frame_t());
   m_debug_trace_regs_modified.push_back(reg_map_t());
   m_debug_trace_regs_read.push_back(reg_map_t());
   m_callstack.push_back(stack_entry());
@@ -308,6 +308,7 @@ void ptx_thread_info::set_info(function_info *func) {
   m_symbol_table = func->get_symtab();
   m_func_info = func;
   m_PC = func->get_start_PC();
+  size_reg_frame(func);
 }
 
 void ptx_thread_info::cpy_tid_to_reg(dim3 tid) {
@@ -413,7 +414,7 @@ void ptx_thread_info::callstack_push(unsigned pc, unsigned rpc,
   assert(m_func_info != NULL);
   m_callstack.push_back(stack_entry(m_symbol_table, m_func_info, pc, rpc,
                                     return_var_src, return_var_dst, call_uid));
-  m_regs.push_back(reg_map_t());
+  m_regs.push_back(reg_frame_t());
   m_debug_trace_regs_modified.push_back(reg_map_t());
   m_debug_trace_regs_read.push_back(reg_map_t());
   m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -430,7 +431,7 @@ void ptx_thread_info::callstack_push_plus(unsigned pc, unsigned rpc,
   assert(m_func_info != NULL);
   m_callstack.push_back(stack_entry(m_symbol_table, m_func_info, pc, rpc,
                                     return_var_src, return_var_dst, call_uid));
-  // m_regs.push_back( reg_map_t() );
+  // m_regs.push_back( reg_frame_t() );
   // m_debug_trace_regs_modified.push_back( reg_map_t() );
   // m_debug_trace_regs_read.push_back( reg_map_t() );
   m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -507,22 +508,23 @@ bool ptx_thread_info::callstack_pop_plus() {
 
 void ptx_thread_info::dump_callstack() const {
   std::list<stack_entry>::const_iterator c = m_callstack.begin();
-  std::list<reg_map_t>::const_iterator r = m_regs.begin();
+  std::list<reg_frame_t>::const_iterator r = m_regs.begin();
 
   printf("\n\n");
   printf("Call stack for thread uid = %u (sc=%u, hwtid=%u)\n", m_uid, m_hw_sid,
          m_hw_tid);
   while (c != m_callstack.end() && r != m_regs.end()) {
     const stack_entry &c_e = *c;
-    const reg_map_t &regs = *r;
+    size_t n_regs = 0;
+    for (reg_frame_t::const_iterator s = r->begin(); s != r->end(); ++s)
+      if (s->m_sym) n_regs++;
     if (!c_e.m_valid) {
-      printf("  <entry>                              #regs = %zu\n",
-             regs.size());
+      printf("  <entry>                              #regs = %zu\n", n_regs);
     } else {
       printf("  %20s  PC=%3u RV= (callee=\'%s\',caller=\'%s\') #regs = %zu\n",
              c_e.m_func_info->get_name().c_str(), c_e.m_PC,
              c_e.m_return_var_src->name().c_str(),
-             c_e.m_return_var_dst->name().c_str(), regs.size());
+             c_e.m_return_var_dst->name().c_str(), n_regs);
     }
     c++;
     r++;
@@ -550,13 +552,17 @@ const ptx_instruction *ptx_thread_info::get_inst(addr_t pc) const {
 
 void ptx_thread_info::dump_regs(FILE *fp) {
   if (m_regs.empty()) return;
-  if (m_regs.back().empty()) return;
-  fprintf(fp, "Register File Contents:\n");
-  fflush(fp);
-  reg_map_t::const_iterator r;
+  bool printed_header = false;
+  reg_frame_t::const_iterator r;
   for (r = m_regs.back().begin(); r != m_regs.back().end(); ++r) {
-    const symbol *sym = r->first;
-    ptx_reg_t value = r->second;
+    const symbol *sym = r->m_sym;
+    if (sym == NULL) continue;
+    if (!printed_header) {
+      fprintf(fp, "Register File Contents:\n");
+      fflush(fp);
+      printed_header = true;
+    }
+    ptx_reg_t value = r->m_value;
     std::string name = sym->name();
     print_reg(fp, name, value, m_symbol_table);
   }
@@ -609,6 +615,7 @@ void ptx_thread_info::set_npc(const function_info *f) {
   m_NPC = f->get_start_PC();
   m_func_info = const_cast<function_info *>(f);
   m_symbol_table = m_func_info->get_symtab();
+  size_reg_frame(f);
 }
 
 void feature_not_implemented(const char *f) {
@@ -40,6 +40,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "memory.h"
 
@@ -306,6 +307,15 @@ class ptx_thread_info {
 
   void ptx_fetch_inst(inst_t &inst) const;
   void ptx_exec_inst(warp_inst_t &inst, unsigned lane_id);
+  // Executes inst for every active lane of a warp at once.  Returns false,
+  // without touching any thread state, if the instruction is not supported
+  // by the warp-wide path; lanes whose guard predicate is false are returned
+  // in skipped and must be deactivated by the caller.
+  static bool ptx_exec_warp_inst(warp_inst_t &inst, ptx_thread_info **lanes,
+                                 unsigned warp_size, active_mask_t &skipped);
+  // Lane kernel used by ptx_exec_warp_inst() for pI, or -1 if pI must be
+  // executed per thread; evaluated once when the function is assembled.
+  static int decode_warp_exec_op(const ptx_instruction *pI);
 
   const ptx_version &get_ptx_version() const;
   void set_reg(const symbol *reg, const ptx_reg_t &value);
@@ -472,6 +482,8 @@ class ptx_thread_info {
   ptx_reg_t m_last_set_operand_value;
 
  private:
+  void retire_inst(const ptx_instruction *pI, int op_classification);
+
   bool m_functionalSimulationMode;
   unsigned m_uid;
   kernel_info_t &m_kernel;
@@ -506,8 +518,20 @@ class ptx_thread_info {
   std::list<stack_entry> m_callstack;
   unsigned m_local_mem_stack_pointer;
 
+  // One register frame per call level, indexed by symbol::reg_num().  The
+  // symbol is recorded on the first write so that reads of undefined
+  // registers are still caught and the frame can be dumped by name.
+  struct reg_slot_t {
+    reg_slot_t() : m_sym(NULL) {}
+    const symbol *m_sym;
+    ptx_reg_t m_value;
+  };
+  typedef std::vector<reg_slot_t> reg_frame_t;
+  reg_slot_t &reg_slot(const symbol *reg);
+  void size_reg_frame(const function_info *func);
+  std::list<reg_frame_t> m_regs;
+
   typedef tr1_hash_map<const symbol *, ptx_reg_t> reg_map_t;
-  std::list<reg_map_t> m_regs;
   std::list<reg_map_t> m_debug_trace_regs_modified;
   std::list<reg_map_t> m_debug_trace_regs_read;
   bool m_enable_debug_trace;
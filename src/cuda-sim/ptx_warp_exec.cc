@@ -0,0 +1,810 @@
+// Warp-wide functional execution of common PTX instructions.
+//
+// ptx_thread_info::ptx_exec_inst() decodes the guard predicate and operands of
+// an instruction once for every active lane.  For the integer and floating
+// point add/sub/mul/mad/fma, logic, shift, move and setp instructions handled
+// here, and for the address generation of plain global and shared ld/st, the
+// instruction is decoded once per warp, the source operands of all active
+// lanes are gathered into structure-of-arrays lane vectors, the operation is
+// applied in one branch-free loop over the lanes (which the compiler turns
+// into SSE/AVX code when built for those targets) and the results are
+// scattered back to the register frames.  Loads and stores then access memory
+// lane by lane.  Every other instruction goes through the per-thread
+// interpreter.
+
+#include "ptx_sim.h"
+#include <assert.h>
+#include <fenv.h>
+#include <string.h>
+#include <cmath>
+#include "cuda-sim.h"
+#include "decuda_pred_table/decuda_pred_table.h"
+#include "memory.h"
+#include "opcodes.h"
+#include "ptx_ir.h"
+class ptx_recognizer;
+typedef void *yyscan_t;
+#include "ptx.tab.h"
+
+// defined in instructions.cc
+void sign_extend(ptx_reg_t &data, unsigned src_size, const operand_info &dst);
+
+typedef unsigned long long lane_vec_t[MAX_WARP_SIZE];
+
+enum warp_alu_op {
+  WARP_ADD32,
+  WARP_ADD64,
+  WARP_ADD_F32,
+  WARP_ADD_F64,
+  WARP_SUB32,
+  WARP_SUB64,
+  WARP_SUB_F32,
+  WARP_SUB_F64,
+  WARP_AND,
+  WARP_OR,
+  WARP_XOR,
+  WARP_SHL16,
+  WARP_SHL32,
+  WARP_MOV,
+  WARP_MUL_LO32,
+  WARP_MUL_HI_S32,
+  WARP_MUL_HI_U32,
+  WARP_MUL_WIDE_S32,
+  WARP_MUL_WIDE_U32,
+  WARP_MUL64,
+  WARP_MUL_F32,
+  WARP_MUL_F64,
+  WARP_MAD_LO32,
+  WARP_MAD64,
+  WARP_MAD_F32,
+  WARP_MAD_F64,
+  WARP_SETP,
+  WARP_LD,
+  WARP_ST
+};
+
+// the floating point rounding modes mul_impl() and mad_def() accept
+static bool rn_or_rz(const ptx_instruction *pI) {
+  return pI->rounding_mode() == RN_OPTION || pI->rounding_mode() == RZ_OPTION;
+}
+
+// comparisons that CmpOp() implements for type
+static bool setp_cmpop_supported(unsigned type, unsigned cmpop) {
+  switch (cmpop) {
+    case EQ_OPTION:
+    case NE_OPTION:
+      return true;
+    case LT_OPTION:
+    case LE_OPTION:
+    case GT_OPTION:
+    case GE_OPTION:
+      return type != B32_TYPE && type != B64_TYPE;
+    case LO_OPTION:
+    case LS_OPTION:
+    case HI_OPTION:
+    case HS_OPTION:
+      return type == U32_TYPE || type == U64_TYPE;
+    case EQU_OPTION:
+    case NEU_OPTION:
+    case LTU_OPTION:
+    case LEU_OPTION:
+    case GTU_OPTION:
+    case GEU_OPTION:
+    case NUM_OPTION:
+    case NAN_OPTION:
+      return type == F32_TYPE || type == F64_TYPE;
+    default:
+      return false;
+  }
+}
+
+// Maps an instruction onto a lane kernel.  The kernels reproduce bit for bit
+// what the corresponding *_impl() leaves in the destination register.
+static bool decode_warp_alu_op(const ptx_instruction *pI, warp_alu_op &op) {
+  switch (pI->get_opcode()) {
+    case ADD_OP:
+    case SUB_OP:
+    case AND_OP:
+    case OR_OP:
+    case XOR_OP:
+    case SHL_OP:
+    case MOV_OP:
+    case MUL_OP:
+    case MAD_OP:
+    case FMA_OP:
+    case SETP_OP:
+    case LD_OP:
+    case ST_OP:
+      break;
+    default:
+      // may not carry a type at all (bra, ret, bar, ...)
+      return false;
+  }
+  unsigned type = pI->get_type();
+  switch (pI->get_opcode()) {
+    case ADD_OP:
+      if (!rn_or_rz(pI)) return false;
+      switch (type) {
+        case S32_TYPE:
+        case U32_TYPE:
+          op = WARP_ADD32;
+          return true;
+        case S64_TYPE:
+        case U64_TYPE:
+          op = WARP_ADD64;
+          return true;
+        case F32_TYPE:
+          op = WARP_ADD_F32;
+          return true;
+        case F64_TYPE:
+          op = WARP_ADD_F64;
+          return true;
+      }
+      return false;
+    case SUB_OP:
+      switch (type) {
+        case S32_TYPE:
+        case U32_TYPE:
+        case B32_TYPE:
+          op = WARP_SUB32;
+          return true;
+        case S64_TYPE:
+        case U64_TYPE:
+        case B64_TYPE:
+          op = WARP_SUB64;
+          return true;
+        case F32_TYPE:
+          op = WARP_SUB_F32;
+          return true;
+        case F64_TYPE:
+          op = WARP_SUB_F64;
+          return true;
+      }
+      return false;
+    case AND_OP:
+      op = WARP_AND;
+      return type != PRED_TYPE;
+    case OR_OP:
+      op = WARP_OR;
+      return type != PRED_TYPE;
+    case XOR_OP:
+      op = WARP_XOR;
+      return type != PRED_TYPE;
+    case SHL_OP:
+      switch (type) {
+        case B16_TYPE:
+        case U16_TYPE:
+          op = WARP_SHL16;
+          return true;
+        case B32_TYPE:
+        case U32_TYPE:
+          op = WARP_SHL32;
+          return true;
+      }
+      return false;
+    case MOV_OP:
+      op = WARP_MOV;
+      return type != PRED_TYPE;
+    case MUL_OP:
+      switch (type) {
+        case S32_TYPE:
+        case U32_TYPE:
+          if (pI->is_wide())
+            op = type == S32_TYPE ? WARP_MUL_WIDE_S32 : WARP_MUL_WIDE_U32;
+          else if (pI->is_hi())
+            op = type == S32_TYPE ? WARP_MUL_HI_S32 : WARP_MUL_HI_U32;
+          else if (pI->is_lo())
+            op = WARP_MUL_LO32;
+          else
+            return false;
+          return true;
+        case S64_TYPE:
+        case U64_TYPE:
+          op = WARP_MUL64;
+          return pI->is_lo() && !pI->is_hi() && !pI->is_wide();
+        case F32_TYPE:
+          op = WARP_MUL_F32;
+          return rn_or_rz(pI);
+        case F64_TYPE:
+          op = WARP_MUL_F64;
+          return rn_or_rz(pI);
+      }
+      return false;
+    case MAD_OP:
+    case FMA_OP:
+      // fma goes through mad_def() as well; mad.hi and mad.wide keep the
+      // per-thread path, which computes the product in 32 bits
+      switch (type) {
+        case S32_TYPE:
+        case U32_TYPE:
+          op = WARP_MAD_LO32;
+          return pI->get_opcode() == MAD_OP && pI->is_lo() && !pI->is_hi() &&
+                 !pI->is_wide();
+        case S64_TYPE:
+        case U64_TYPE:
+          op = WARP_MAD64;
+          return pI->get_opcode() == MAD_OP && pI->is_lo() && !pI->is_hi() &&
+                 !pI->is_wide();
+        case F32_TYPE:
+          op = WARP_MAD_F32;
+          return rn_or_rz(pI);
+        case F64_TYPE:
+          op = WARP_MAD_F64;
+          return rn_or_rz(pI);
+      }
+      return false;
+    case SETP_OP:
+      switch (type) {
+        case S32_TYPE:
+        case U32_TYPE:
+        case B32_TYPE:
+        case S64_TYPE:
+        case U64_TYPE:
+        case B64_TYPE:
+        case F32_TYPE:
+        case F64_TYPE:
+          // setp with a combining predicate (the "c" operand) is per-thread
+          op = WARP_SETP;
+          return pI->get_num_operands() == 3 &&
+                 setp_cmpop_supported(type, pI->get_cmpop());
+      }
+      return false;
+    case LD_OP:
+    case ST_OP:
+      switch (pI->get_space().get_type()) {
+        case global_space:
+        case shared_space:
+          break;
+        default:
+          return false;
+      }
+      if (pI->get_vector()) return false;
+      switch (type) {
+        case S32_TYPE:
+        case U32_TYPE:
+        case B32_TYPE:
+        case F32_TYPE:
+        case S64_TYPE:
+        case U64_TYPE:
+        case B64_TYPE:
+        case F64_TYPE:
+          op = pI->get_opcode() == LD_OP ? WARP_LD : WARP_ST;
+          return true;
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+static unsigned warp_alu_num_src(warp_alu_op op) {
+  switch (op) {
+    case WARP_MOV:
+    case WARP_LD:
+      return 1;
+    case WARP_MAD_LO32:
+    case WARP_MAD64:
+    case WARP_MAD_F32:
+    case WARP_MAD_F64:
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+// ops whose *_impl() switches to round-towards-zero for .rz
+static bool warp_alu_op_rounds(warp_alu_op op) {
+  switch (op) {
+    case WARP_ADD32:
+    case WARP_ADD64:
+    case WARP_ADD_F32:
+    case WARP_ADD_F64:
+    case WARP_MUL_F32:
+    case WARP_MUL_F64:
+    case WARP_MAD_F32:
+    case WARP_MAD_F64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// plain registers and literals only: no vectors, ptxplus register pairs,
+// memory operands, half-register selects or negation
+static bool simple_operand(const operand_info &op, bool is_dst) {
+  if (op.is_vector() || op.get_double_operand_type() != 0 ||
+      op.get_addr_space() != undefined_space || op.get_operand_lohi() != 0 ||
+      op.get_operand_neg())
+    return false;
+  if (op.is_reg()) return true;
+  return !is_dst && op.is_literal();
+}
+
+// [reg] and [reg+offset] addresses of ld/st
+static bool simple_address(const operand_info &op) {
+  if (!op.is_memory_operand() || op.get_double_operand_type() != 0 ||
+      op.get_addr_space() != undefined_space || op.get_operand_lohi() != 0 ||
+      op.get_operand_neg())
+    return false;
+  const symbol *sym = op.get_symbol();
+  return sym && sym->type() && sym->type()->get_key().is_reg();
+}
+
+int ptx_thread_info::decode_warp_exec_op(const ptx_instruction *pI) {
+  warp_alu_op op;
+  if (pI->is_exit() || !decode_warp_alu_op(pI, op)) return -1;
+  switch (op) {
+    case WARP_LD:
+      if (!simple_operand(pI->dst(), true) || !simple_address(pI->src1()))
+        return -1;
+      return op;
+    case WARP_ST:
+      if (!simple_address(pI->dst()) || !simple_operand(pI->src1(), false))
+        return -1;
+      return op;
+    default:
+      break;
+  }
+  if (!simple_operand(pI->dst(), true) || !simple_operand(pI->src1(), false))
+    return -1;
+  unsigned nsrc = warp_alu_num_src(op);
+  if (nsrc >= 2 && !simple_operand(pI->src2(), false)) return -1;
+  if (nsrc >= 3 && !simple_operand(pI->src3(), false)) return -1;
+  return op;
+}
+
+static inline float lane_f32(unsigned long long v) {
+  unsigned u = (unsigned)v;
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+static inline unsigned long long lane_bits(float f) {
+  unsigned u;
+  memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+static inline double lane_f64(unsigned long long v) {
+  double d;
+  memcpy(&d, &v, sizeof(d));
+  return d;
+}
+
+static inline unsigned long long lane_bits(double d) {
+  unsigned long long u;
+  memcpy(&u, &d, sizeof(u));
+  return u;
+}
+
+static inline float lane_saturate(float f) {
+  return f < 0 ? 0.0f : (f > 1.0f ? 1.0f : f);
+}
+
+static inline double lane_saturate(double d) {
+  return d < 0 ? 0.0 : (d > 1.0 ? 1.0 : d);
+}
+
+// Applies op to all n lanes.  Lanes that do not execute carry zeros and their
+// results are discarded, so the loops stay free of per-lane control flow.
+static void run_warp_alu_op(warp_alu_op op, bool saturate, unsigned n,
+                            const lane_vec_t a, const lane_vec_t b,
+                            const lane_vec_t c, lane_vec_t d) {
+  const unsigned long long M32 = 0xFFFFFFFFULL;
+  switch (op) {
+    case WARP_ADD32:
+      for (unsigned t = 0; t < n; t++) d[t] = (a[t] & M32) + (b[t] & M32);
+      break;
+    case WARP_ADD64:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] + b[t];
+      break;
+    case WARP_ADD_F32:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = lane_bits(lane_f32(a[t]) + lane_f32(b[t]));
+      break;
+    case WARP_ADD_F64:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = lane_bits(lane_f64(a[t]) + lane_f64(b[t]));
+      break;
+    case WARP_SUB32:
+      // the borrow constant keeps the carry bit consistent with sub_impl()
+      for (unsigned t = 0; t < n; t++)
+        d[t] = (a[t] & M32) - (b[t] & M32) + 0x100000000ULL;
+      break;
+    case WARP_SUB64:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] - b[t];
+      break;
+    case WARP_SUB_F32:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = lane_bits(lane_f32(a[t]) - lane_f32(b[t]));
+      break;
+    case WARP_SUB_F64:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = lane_bits(lane_f64(a[t]) - lane_f64(b[t]));
+      break;
+    case WARP_AND:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] & b[t];
+      break;
+    case WARP_OR:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] | b[t];
+      break;
+    case WARP_XOR:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] ^ b[t];
+      break;
+    case WARP_SHL16:
+      for (unsigned t = 0; t < n; t++) {
+        unsigned s = b[t] & 0xFFFF;
+        d[t] = s >= 16 ? 0 : ((a[t] & 0xFFFF) << (s & 15)) & 0xFFFF;
+      }
+      break;
+    case WARP_SHL32:
+      for (unsigned t = 0; t < n; t++) {
+        unsigned s = b[t] & M32;
+        d[t] = s >= 32 ? 0 : ((a[t] & M32) << (s & 31)) & M32;
+      }
+      break;
+    case WARP_MOV:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t];
+      break;
+    case WARP_MUL_LO32:
+      for (unsigned t = 0; t < n; t++) d[t] = (a[t] * b[t]) & M32;
+      break;
+    case WARP_MUL_HI_S32:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = (unsigned long long)(((long long)(int)a[t] *
+                                     (long long)(int)b[t]) >>
+                                    32) &
+               M32;
+      break;
+    case WARP_MUL_HI_U32:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = ((a[t] & M32) * (b[t] & M32)) >> 32;
+      break;
+    case WARP_MUL_WIDE_S32:
+      for (unsigned t = 0; t < n; t++)
+        d[t] = (unsigned long long)((long long)(int)a[t] *
+                                    (long long)(int)b[t]);
+      break;
+    case WARP_MUL_WIDE_U32:
+      for (unsigned t = 0; t < n; t++) d[t] = (a[t] & M32) * (b[t] & M32);
+      break;
+    case WARP_MUL64:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] * b[t];
+      break;
+    case WARP_MUL_F32:
+      for (unsigned t = 0; t < n; t++) {
+        float f = lane_f32(a[t]) * lane_f32(b[t]);
+        d[t] = lane_bits(saturate ? lane_saturate(f) : f);
+      }
+      break;
+    case WARP_MUL_F64:
+      for (unsigned t = 0; t < n; t++) {
+        double f = lane_f64(a[t]) * lane_f64(b[t]);
+        d[t] = lane_bits(saturate ? lane_saturate(f) : f);
+      }
+      break;
+    case WARP_MAD_LO32:
+      for (unsigned t = 0; t < n; t++) d[t] = (a[t] * b[t] + c[t]) & M32;
+      break;
+    case WARP_MAD64:
+      for (unsigned t = 0; t < n; t++) d[t] = a[t] * b[t] + c[t];
+      break;
+    case WARP_MAD_F32:
+      // mad_def() evaluates fma the same way, as a * b + c
+      for (unsigned t = 0; t < n; t++) {
+        float f = lane_f32(a[t]) * lane_f32(b[t]) + lane_f32(c[t]);
+        d[t] = lane_bits(saturate ? lane_saturate(f) : f);
+      }
+      break;
+    case WARP_MAD_F64:
+      for (unsigned t = 0; t < n; t++) {
+        double f = lane_f64(a[t]) * lane_f64(b[t]) + lane_f64(c[t]);
+        d[t] = lane_bits(saturate ? lane_saturate(f) : f);
+      }
+      break;
+    default:
+      assert(0);
+  }
+}
+
+// CmpOp() on lane values converted to T.  Integers are always ordered.
+template <class T>
+static inline bool lane_unordered(T x) {
+  return false;
+}
+template <>
+inline bool lane_unordered<float>(float x) {
+  return std::isnan(x);
+}
+template <>
+inline bool lane_unordered<double>(double x) {
+  return std::isnan(x);
+}
+
+template <class T>
+static void run_warp_cmp(unsigned cmpop, unsigned n, const T *x, const T *y,
+                         bool *r) {
+  switch (cmpop) {
+    case EQ_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] == y[t] && !lane_unordered(x[t]) && !lane_unordered(y[t]);
+      break;
+    case NE_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] != y[t] && !lane_unordered(x[t]) && !lane_unordered(y[t]);
+      break;
+    case LT_OPTION:
+    case LO_OPTION:
+      for (unsigned t = 0; t < n; t++) r[t] = x[t] < y[t];
+      break;
+    case LE_OPTION:
+    case LS_OPTION:
+      for (unsigned t = 0; t < n; t++) r[t] = x[t] <= y[t];
+      break;
+    case GT_OPTION:
+    case HI_OPTION:
+      for (unsigned t = 0; t < n; t++) r[t] = x[t] > y[t];
+      break;
+    case GE_OPTION:
+    case HS_OPTION:
+      for (unsigned t = 0; t < n; t++) r[t] = x[t] >= y[t];
+      break;
+    case EQU_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] == y[t] || lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    case NEU_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] != y[t] || lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    case LTU_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] < y[t] || lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    case LEU_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] <= y[t] || lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    case GTU_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] > y[t] || lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    case GEU_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = x[t] >= y[t] || lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    case NUM_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = !lane_unordered(x[t]) && !lane_unordered(y[t]);
+      break;
+    case NAN_OPTION:
+      for (unsigned t = 0; t < n; t++)
+        r[t] = lane_unordered(x[t]) || lane_unordered(y[t]);
+      break;
+    default:
+      assert(0);
+  }
+}
+
+// setp_impl(): the predicate register is 1 when the comparison is false
+static void run_warp_setp(unsigned type, unsigned cmpop, unsigned n,
+                          const lane_vec_t a, const lane_vec_t b,
+                          lane_vec_t d) {
+  bool r[MAX_WARP_SIZE];
+  switch (type) {
+    case S32_TYPE: {
+      int x[MAX_WARP_SIZE], y[MAX_WARP_SIZE];
+      for (unsigned t = 0; t < n; t++) x[t] = (int)a[t], y[t] = (int)b[t];
+      run_warp_cmp(cmpop, n, x, y, r);
+      break;
+    }
+    case U32_TYPE: {
+      unsigned x[MAX_WARP_SIZE], y[MAX_WARP_SIZE];
+      for (unsigned t = 0; t < n; t++)
+        x[t] = (unsigned)a[t], y[t] = (unsigned)b[t];
+      run_warp_cmp(cmpop, n, x, y, r);
+      break;
+    }
+    case S64_TYPE: {
+      long long x[MAX_WARP_SIZE], y[MAX_WARP_SIZE];
+      for (unsigned t = 0; t < n; t++)
+        x[t] = (long long)a[t], y[t] = (long long)b[t];
+      run_warp_cmp(cmpop, n, x, y, r);
+      break;
+    }
+    case B32_TYPE:  // CmpOp() falls through to the 64-bit compare
+    case B64_TYPE:
+    case U64_TYPE:
+      run_warp_cmp(cmpop, n, a, b, r);
+      break;
+    case F32_TYPE: {
+      float x[MAX_WARP_SIZE], y[MAX_WARP_SIZE];
+      for (unsigned t = 0; t < n; t++)
+        x[t] = lane_f32(a[t]), y[t] = lane_f32(b[t]);
+      run_warp_cmp(cmpop, n, x, y, r);
+      break;
+    }
+    case F64_TYPE: {
+      double x[MAX_WARP_SIZE], y[MAX_WARP_SIZE];
+      for (unsigned t = 0; t < n; t++)
+        x[t] = lane_f64(a[t]), y[t] = lane_f64(b[t]);
+      run_warp_cmp(cmpop, n, x, y, r);
+      break;
+    }
+    default:
+      assert(0);
+  }
+  for (unsigned t = 0; t < n; t++) d[t] = !r[t];
+}
+
+bool ptx_thread_info::ptx_exec_warp_inst(warp_inst_t &inst,
+                                         ptx_thread_info **lanes,
+                                         unsigned warp_size,
+                                         active_mask_t &skipped) {
+  assert(warp_size <= MAX_WARP_SIZE);
+  skipped.reset();
+
+  // anything that traces individual threads stays on the per-thread path
+  if (g_debug_execution >= 5) return false;
+
+  unsigned first = 0;
+  while (first < warp_size && !inst.active(first)) first++;
+  if (first == warp_size) return false;
+  ptx_thread_info *lead = lanes[first];
+  if (lead == NULL || lead->m_gpu->get_config().get_ptx_inst_debug_to_file())
+    return false;
+
+  addr_t pc = inst.pc;
+  const ptx_instruction *pI = lead->m_func_info->get_instruction(pc);
+  if (pI == NULL || pI->uop().m_warp_op < 0) return false;
+  warp_alu_op op = (warp_alu_op)pI->uop().m_warp_op;
+  bool is_load = op == WARP_LD, is_store = op == WARP_ST;
+  unsigned nsrc = warp_alu_num_src(op);
+  const operand_info &dst = pI->dst();
+  const operand_info &src1 = pI->src1();
+
+  // all lanes must be at the same instruction before any state is modified
+  for (unsigned t = first; t < warp_size; t++) {
+    if (!inst.active(t)) continue;
+    ptx_thread_info *thd = lanes[t];
+    if (thd == NULL || thd->m_enable_debug_trace || thd->get_pc() != pc ||
+        thd->m_func_info->get_instruction(pc) != pI)
+      return false;
+  }
+
+  // per-lane prologue and guard predicate, as in ptx_exec_inst()
+  active_mask_t exec;
+  for (unsigned t = first; t < warp_size; t++) {
+    if (!inst.active(t)) continue;
+    ptx_thread_info *thd = lanes[t];
+    thd->next_instr();
+    thd->set_npc(pc + pI->inst_size());
+    thd->clearRPC();
+    thd->m_last_set_operand_value.u64 = 0;
+    if (thd->is_done()) {
+      printf(
+          "attempted to execute instruction on a thread that is already "
+          "done.\n");
+      assert(0);
+    }
+    bool skip = false;
+    if (pI->has_pred()) {
+      const operand_info &pred = pI->get_pred();
+      ptx_reg_t pred_value =
+          thd->get_operand_value(pred, pred, PRED_TYPE, thd, 0);
+      if (pI->get_pred_mod() == -1) {
+        skip = (pred_value.pred & 0x0001) ^ pI->get_pred_neg();
+      } else {
+        skip = !pred_lookup(pI->get_pred_mod(), pred_value.pred & 0x000F);
+      }
+    }
+    skipped.set(t, skip);
+    exec.set(t, !skip);
+  }
+
+  // gather: the address register of ld/st comes first, then the sources
+  lane_vec_t a, b, c, d;
+  const operand_info *src[3];
+  if (is_load) {
+    src[0] = &src1;
+  } else if (is_store) {
+    src[0] = &dst;
+    src[1] = &src1;
+  } else {
+    src[0] = &src1;
+    src[1] = nsrc >= 2 ? &pI->src2() : NULL;
+    src[2] = nsrc >= 3 ? &pI->src3() : NULL;
+  }
+  unsigned long long *vec[3] = {a, b, c};
+  for (unsigned s = 0; s < 3; s++) {
+    unsigned long long *v = vec[s];
+    if (s >= nsrc) {
+      memset(v, 0, sizeof(lane_vec_t));
+      continue;
+    }
+    const operand_info &opnd = *src[s];
+    if (opnd.is_literal()) {
+      unsigned long long lit = opnd.get_literal_value().u64;
+      for (unsigned t = 0; t < warp_size; t++) v[t] = exec.test(t) ? lit : 0;
+      continue;
+    }
+    const symbol *sym = opnd.get_symbol();
+    for (unsigned t = 0; t < warp_size; t++) {
+      v[t] = 0;
+      if (!exec.test(t)) continue;
+      reg_slot_t &slot = lanes[t]->reg_slot(sym);
+      v[t] = slot.m_sym ? slot.m_value.u64 : lanes[t]->get_reg(sym).u64;
+    }
+  }
+
+  // execute
+  unsigned type = pI->get_type();
+  memory_space_t space = pI->get_space();
+  size_t size = 0;
+  if (is_load || is_store) {
+    // ld_exec() and st_impl() address memory with the low 32 bits
+    int t_class;
+    type_info_key::type_decode(type, size, t_class);
+    unsigned long long offset =
+        (unsigned long long)(long long)(is_load ? src1 : dst).get_addr_offset();
+    for (unsigned t = 0; t < warp_size; t++)
+      a[t] = (a[t] + offset) & 0xFFFFFFFFULL;
+    for (unsigned t = first; t < warp_size; t++) {
+      if (!exec.test(t)) continue;
+      ptx_thread_info *thd = lanes[t];
+      memory_space *mem = space == shared_space ? thd->m_shared_mem
+                                                : thd->get_global_memory();
+      ptx_reg_t data;
+      if (is_load) {
+        mem->read(a[t], size / 8, &data.s64);
+        if (type == S32_TYPE) sign_extend(data, size, dst);
+        d[t] = data.u64;
+      } else {
+        data.u64 = b[t];
+        mem->write(a[t], size / 8, &data.s64, thd, pI);
+      }
+      thd->m_last_effective_address = a[t];
+      thd->m_last_memory_space = space;
+    }
+  } else if (exec.any()) {
+    if (op == WARP_SETP) {
+      run_warp_setp(type, pI->get_cmpop(), warp_size, a, b, d);
+    } else {
+      int orig_rm = fegetround();
+      if (warp_alu_op_rounds(op) && pI->rounding_mode() == RZ_OPTION)
+        fesetround(FE_TOWARDZERO);
+      run_warp_alu_op(op, pI->saturation_mode(), warp_size, a, b, c, d);
+      fesetround(orig_rm);
+    }
+  }
+
+  // scatter and retire in lane order so that global counters and liveness
+  // messages advance exactly as with per-thread execution
+  const symbol *dst_sym = is_store ? NULL : dst.get_symbol();
+  int classification = pI->uop().m_classification;
+  for (unsigned t = first; t < warp_size; t++) {
+    if (!inst.active(t)) continue;
+    ptx_thread_info *thd = lanes[t];
+    if (exec.test(t) && !is_store) {
+      ptx_reg_t value;
+      value.u64 = d[t];
+      thd->set_reg(dst_sym, value);
+    }
+    // as in ptx_exec_inst(), lanes skipped by the guard are not classified
+    thd->retire_inst(pI, exec.test(t) ? classification : 0);
+    if (!exec.test(t)) continue;
+    if (is_load || is_store) {
+      inst.space = space;
+      inst.set_addr(t, a[t]);
+      inst.data_size = size / 8;
+      assert(inst.memory_op == (is_load ? memory_load : memory_store));
+    } else {
+      inst.space = undefined_space;
+      inst.set_addr(t, 0xFEEBDAED);
+      inst.data_size = 0;
+      assert(inst.memory_op == no_memory_op);
+    }
+  }
+  return true;
+}
@@ -66,6 +66,9 @@ class linear_to_raw_address_translation {
   // accessors
   void addrdec_tlx(new_addr_type addr, addrdec_t *tlx) const;
   new_addr_type partition_address(new_addr_type addr) const;
+  partition_index_function get_partition_indexing() const {
+    return memory_partition_indexing;
+  }
 
  private:
   void addrdec_parseoption(const char *option);
@@ -0,0 +1,220 @@
+// Analytical crossbar between the SM clusters and the memory sub-partitions.
+// See analytical_interconnect.h for the timing model.
+
+#include <assert.h>
+#include <algorithm>
+
+#include "analytical_interconnect.h"
+
+// the wheel covers at least this many cycles past the base latency; packets
+// due later wait in their slot for a later turn
+#define ANALYTICAL_ICNT_MIN_WHEEL_SPAN 256
+
+AnalyticalInterconnect* AnalyticalInterconnect::New(
+    const struct inct_config& m_inct_config) {
+  AnalyticalInterconnect* icnt_interface =
+      new AnalyticalInterconnect(m_inct_config);
+
+  return icnt_interface;
+}
+
+AnalyticalInterconnect::AnalyticalInterconnect(
+    const struct inct_config& m_inct_config)
+    : m_inct_config(m_inct_config) {
+  n_shader = 0;
+  n_mem = 0;
+  total_nodes = 0;
+  cycle = 0;
+  n_blocked = 0;
+  n_pending = 0;
+  wheel_mask = 0;
+}
+
+AnalyticalInterconnect::~AnalyticalInterconnect() {}
+
+void AnalyticalInterconnect::CreateInterconnect(unsigned m_n_shader,
+                                                unsigned m_n_mem) {
+  assert(m_inct_config.port_bandwidth > 0);
+  assert(m_inct_config.in_buffer_limit > 0);
+  assert(m_inct_config.out_buffer_limit > 0);
+
+  n_shader = m_n_shader;
+  n_mem = m_n_mem;
+  total_nodes = n_shader + n_mem;
+
+  in_port_free.resize(total_nodes, 0);
+  out_port_free.resize(total_nodes, 0);
+  in_flight.resize(total_nodes, 0);
+  out_buffers.resize(total_nodes);
+  out_blocked.resize(total_nodes);
+
+  unsigned wheel_size = 1;
+  while (wheel_size <
+         m_inct_config.base_latency + ANALYTICAL_ICNT_MIN_WHEEL_SPAN)
+    wheel_size <<= 1;
+  wheel.resize(wheel_size);
+  wheel_mask = wheel_size - 1;
+}
+
+void AnalyticalInterconnect::Init() {
+  // empty
+  // there is nothing to do
+}
+
+void AnalyticalInterconnect::Push(unsigned input_deviceID,
+                                  unsigned output_deviceID, void* data,
+                                  unsigned int size) {
+  assert(input_deviceID < total_nodes && output_deviceID < total_nodes);
+  // it should have free buffer
+  assert(HasBuffer(input_deviceID, size));
+
+  unsigned long long service =
+      std::max(1u, (size + m_inct_config.port_bandwidth - 1) /
+                       m_inct_config.port_bandwidth);
+  unsigned long long in_start = std::max(cycle, in_port_free[input_deviceID]);
+  in_port_free[input_deviceID] = in_start + service;
+  unsigned long long out_start =
+      std::max(in_start + m_inct_config.base_latency,
+               out_port_free[output_deviceID]);
+  out_port_free[output_deviceID] = out_start + service;
+  unsigned long long ready_cycle = out_start + service;
+
+  wheel[ready_cycle & wheel_mask].push_back(
+      Packet(data, input_deviceID, output_deviceID, cycle, ready_cycle));
+  n_pending++;
+  in_flight[input_deviceID]++;
+
+  net_stats& stats = m_stats[input_deviceID < n_shader ? REQ_NET : REPLY_NET];
+  stats.packets_num++;
+  stats.total_queueing += out_start - cycle - m_inct_config.base_latency;
+}
+
+void* AnalyticalInterconnect::Pop(unsigned ouput_deviceID) {
+  assert(ouput_deviceID < total_nodes);
+  void* data = NULL;
+
+  if (!out_buffers[ouput_deviceID].empty()) {
+    data = out_buffers[ouput_deviceID].front().data;
+    out_buffers[ouput_deviceID].pop();
+  }
+
+  return data;
+}
+
+void AnalyticalInterconnect::Eject(const Packet& packet) {
+  out_buffers[packet.output_deviceID].push(packet);
+  in_flight[packet.input_deviceID]--;
+  net_stats& stats =
+      m_stats[packet.input_deviceID < n_shader ? REQ_NET : REPLY_NET];
+  stats.delivered_num++;
+  stats.total_latency += cycle - packet.push_cycle;
+}
+
+// packets for an output with a full ejection queue wait behind earlier ones
+void AnalyticalInterconnect::Deliver(const Packet& packet) {
+  unsigned output = packet.output_deviceID;
+  if (!out_blocked[output].empty() ||
+      out_buffers[output].size() >= m_inct_config.out_buffer_limit) {
+    out_blocked[output].push(packet);
+    n_blocked++;
+    m_stats[packet.input_deviceID < n_shader ? REQ_NET : REPLY_NET]
+        .out_buffer_full++;
+    return;
+  }
+  Eject(packet);
+}
+
+void AnalyticalInterconnect::Advance() {
+  // packets held back by a full ejection queue go first, in order
+  if (n_blocked) {
+    for (unsigned i = 0; i < total_nodes; ++i) {
+      while (!out_blocked[i].empty() &&
+             out_buffers[i].size() < m_inct_config.out_buffer_limit) {
+        Eject(out_blocked[i].front());
+        out_blocked[i].pop();
+        n_blocked--;
+      }
+    }
+  }
+
+  vector<Packet>& slot = wheel[cycle & wheel_mask];
+  if (!slot.empty()) {
+    // keep the packets due in a later turn, in push order
+    unsigned kept = 0;
+    for (unsigned i = 0; i < slot.size(); ++i) {
+      if (slot[i].ready_cycle == cycle) {
+        Deliver(slot[i]);
+        n_pending--;
+      } else {
+        assert(slot[i].ready_cycle > cycle);
+        if (kept != i) slot[kept] = slot[i];
+        kept++;
+      }
+    }
+    slot.erase(slot.begin() + kept, slot.end());
+  }
+
+  cycle++;
+}
+
+bool AnalyticalInterconnect::Busy() const {
+  if (n_pending || n_blocked) return true;
+  for (unsigned i = 0; i < total_nodes; ++i) {
+    if (!out_buffers[i].empty()) return true;
+  }
+  return false;
+}
+
+bool AnalyticalInterconnect::HasBuffer(unsigned deviceID, unsigned int size,
+                                       unsigned queued,
+                                       unsigned queued_flits) const {
+  assert(deviceID < total_nodes);
+  bool has_buffer =
+      in_flight[deviceID] + queued < m_inct_config.in_buffer_limit;
+  // the cores of different clusters query their inputs concurrently
+  if (!has_buffer)
+    __sync_fetch_and_add(
+        &m_stats[deviceID < n_shader ? REQ_NET : REPLY_NET].in_buffer_full, 1);
+
+  return has_buffer;
+}
+
+void AnalyticalInterconnect::DisplayNetStats(const char* name,
+                                             const net_stats& stats) const {
+  printf("%s_Network_injected_packets_num = %llu\n", name, stats.packets_num);
+  printf("%s_Network_cycles = %llu\n", name, cycle);
+  printf("%s_Network_injected_packets_per_cycle = %12.4f \n", name,
+         (float)(stats.packets_num) / cycle);
+  printf("%s_Network_avg_latency = %12.4f\n", name,
+         (float)(stats.total_latency) / stats.delivered_num);
+  printf("%s_Network_avg_queueing_delay = %12.4f\n", name,
+         (float)(stats.total_queueing) / stats.packets_num);
+  printf("%s_Network_in_buffer_full_per_cycle = %12.4f\n", name,
+         (float)(stats.in_buffer_full) / cycle);
+  printf("%s_Network_out_buffer_full_per_cycle = %12.4f\n", name,
+         (float)(stats.out_buffer_full) / cycle);
+}
+
+void AnalyticalInterconnect::DisplayStats() const {
+  DisplayNetStats("Req", m_stats[REQ_NET]);
+  printf("\n");
+  DisplayNetStats("Reply", m_stats[REPLY_NET]);
+}
+
+void AnalyticalInterconnect::DisplayOverallStats() const {}
+
+unsigned AnalyticalInterconnect::GetFlitSize() const {
+  return m_inct_config.port_bandwidth;
+}
+
+void AnalyticalInterconnect::DisplayState(FILE* fp) const {
+  fprintf(fp,
+          "GPGPU-Sim uArch: ICNT:Display State: cycle %llu, %llu packets in "
+          "flight, %u held at full ejection queues\n",
+          cycle, n_pending, n_blocked);
+  for (unsigned i = 0; i < total_nodes; ++i) {
+    if (in_flight[i] || !out_buffers[i].empty())
+      fprintf(fp, "  node %u: %u in flight, %zu to pop\n", i, in_flight[i],
+              out_buffers[i].size());
+  }
+}
@@ -0,0 +1,109 @@
+// Analytical crossbar between the SM clusters and the memory sub-partitions
+// (network_mode 3).  Nothing is simulated per flit: each packet is given its
+// delivery cycle when it is pushed and waits for it in a timing wheel.
+
+#ifndef _ANALYTICAL_INTERCONNECT_HPP_
+#define _ANALYTICAL_INTERCONNECT_HPP_
+
+#include <stdio.h>
+#include <queue>
+#include <vector>
+#include "local_interconnect.h"
+using namespace std;
+
+// Every node has one injection and one ejection port of port_bandwidth bytes
+// per interconnect cycle.  A packet of S bytes holds a port for
+// ceil(S / port_bandwidth) cycles; each port hands out its cycles in push
+// order, so the wait for a port stands in for the queueing delay of a FIFO
+// with deterministic service.  A packet pushed at cycle t is delivered at
+//   out_start + service, with
+//   in_start  = max(t, input port free)
+//   out_start = max(in_start + base_latency, output port free)
+// Arbitration and head-of-line blocking inside the switch are not modelled.
+// in_buffer_limit bounds the packets a node has in flight and
+// out_buffer_limit the delivered packets waiting to be popped; a full
+// ejection queue holds deliveries back until the node pops.
+class AnalyticalInterconnect {
+ public:
+  AnalyticalInterconnect(const struct inct_config& m_inct_config);
+  ~AnalyticalInterconnect();
+  static AnalyticalInterconnect* New(const struct inct_config& m_inct_config);
+  void CreateInterconnect(unsigned n_shader, unsigned n_mem);
+
+  // node side functions
+  void Init();
+  void Push(unsigned input_deviceID, unsigned output_deviceID, void* data,
+            unsigned int size);
+  void* Pop(unsigned ouput_deviceID);
+  void Advance();
+  bool Busy() const;
+  bool HasBuffer(unsigned deviceID, unsigned int size, unsigned queued = 0,
+                 unsigned queued_flits = 0) const;
+  void DisplayStats() const;
+  void DisplayOverallStats() const;
+  unsigned GetFlitSize() const;
+
+  void DisplayState(FILE* fp) const;
+
+ private:
+  struct Packet {
+    Packet(void* m_data, unsigned m_input_deviceID, unsigned m_output_deviceID,
+           unsigned long long m_push_cycle, unsigned long long m_ready_cycle) {
+      data = m_data;
+      input_deviceID = m_input_deviceID;
+      output_deviceID = m_output_deviceID;
+      push_cycle = m_push_cycle;
+      ready_cycle = m_ready_cycle;
+    }
+    void* data;
+    unsigned input_deviceID;
+    unsigned output_deviceID;
+    unsigned long long push_cycle;
+    unsigned long long ready_cycle;
+  };
+
+  // requests come from the SM clusters, replies from the memory nodes
+  struct net_stats {
+    net_stats()
+        : packets_num(0),
+          delivered_num(0),
+          total_latency(0),
+          total_queueing(0),
+          in_buffer_full(0),
+          out_buffer_full(0) {}
+    unsigned long long packets_num;
+    unsigned long long delivered_num;
+    unsigned long long total_latency;
+    unsigned long long total_queueing;
+    mutable unsigned long long in_buffer_full;
+    unsigned long long out_buffer_full;
+  };
+
+  void Eject(const Packet& packet);
+  void Deliver(const Packet& packet);
+  void DisplayNetStats(const char* name, const net_stats& stats) const;
+
+  const inct_config& m_inct_config;
+
+  unsigned n_shader, n_mem, total_nodes;
+  unsigned long long cycle;
+
+  // first cycle at which each port is free again
+  vector<unsigned long long> in_port_free;
+  vector<unsigned long long> out_port_free;
+  // packets pushed by a node and not yet in an ejection queue
+  vector<unsigned> in_flight;
+  // delivered packets, and packets held back by a full ejection queue
+  vector<queue<Packet> > out_buffers;
+  vector<queue<Packet> > out_blocked;
+  unsigned n_blocked;
+
+  // slot (ready_cycle % wheel size); a slot may hold packets of later turns
+  vector<vector<Packet> > wheel;
+  unsigned wheel_mask;
+  unsigned long long n_pending;
+
+  net_stats m_stats[2];
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "shader.h"
 #include "gpu-cache.h"
+#include "gpu-sim.h"
 #include "stat-tool.h"
 #define CRITICAL_PERCENTAGE 0.5
 
@@ -18,6 +19,14 @@ void ldst_unit::print_cacp_stats() const
   m_L1D->print_cacp_stats();
 }
 
+static bool cpl_in_critical_range(float cpl, float min, float max)
+{
+  return (cpl - min) / (max - min) > CRITICAL_PERCENTAGE;
+}
+
+// Rebuilds the CPL range.  CPLs only change in calc_shader_cpl() and when a
+// warp slot is reset, so every access in between sees the same range.  In
+// epoch mode the flags are frozen until the next refresh as well.
 void shader_core_ctx::calc_warp_criticality()
 {
   float max = -1.0 * 0xFFFFFFFF, min = 1.0 * 0xFFFFFFF;
@@ -29,17 +38,25 @@ void shader_core_ctx::calc_warp_criticality()
       min = m_warp[i]->get_cpl();
     }
   }
+  m_cpl_min = min;
+  m_cpl_max = max;
+  m_cpl_range_valid = true;
+  m_cpl_range_cycle = m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle;
+  if (m_config->cacp_criticality_epoch == 0)
+    return;
   for (unsigned i = 0; i < m_warp.size(); ++i)
-    if ((m_warp[i]->get_cpl() - min) / (max - min) >
-            CRITICAL_PERCENTAGE) {
-      m_warp[i]->cpl_is_critical = true;
-    } else {
-      m_warp[i]->cpl_is_critical = false;
-    }
+    m_warp[i]->cpl_is_critical =
+        cpl_in_critical_range(m_warp[i]->get_cpl(), min, max);
 }
 
 bool shader_core_ctx::get_warp_criticality(unsigned warp_id) {
-  calc_warp_criticality();
+  if (!m_cpl_range_valid) {
+    calc_warp_criticality();
+  }
+  if (m_config->cacp_criticality_epoch == 0) {
+    m_warp[warp_id]->cpl_is_critical = cpl_in_critical_range(
+        m_warp[warp_id]->get_cpl(), m_cpl_min, m_cpl_max);
+  }
   return m_warp[warp_id]->cpl_is_critical;
 }
 
@@ -128,36 +145,12 @@ enum cache_request_status cacp_tag_array::probe(
 
   bool all_reserved = true;
 
-  for (unsigned way = 0; way < m_config.m_assoc; ++way) {
-    unsigned index = set_index * m_config.m_assoc + way;
-    cache_block_t *line = m_lines[index];
-    // Update CACP predictor on hit.
-    if (line->m_tag == tag) {
-      if (line->get_status(mask) == RESERVED) {
-        idx = index;
-        this->cache_hit(idx, mf->is_critical());
-        return HIT_RESERVED;
-      } else if (line->get_status(mask) == VALID) {
-        idx = index;
-        this->cache_hit(idx, mf->is_critical());
-        return HIT;
-      } else if (line->get_status(mask) == MODIFIED) {
-        if (line->is_readable(mask)) {
-          idx = index;
-          cache_hit(idx, mf->is_critical());
-          return HIT;
-        } else {
-          idx = index;
-          return SECTOR_MISS;
-        }
-
-      } else if (line->is_valid_line() && line->get_status(mask) == INVALID) {
-        idx = index;
-        return SECTOR_MISS;
-      } else {
-        assert(line->get_status(mask) == INVALID);
-      }
-    }
+  // Update CACP predictor on hit.
+  enum cache_request_status status;
+  if (probe_tag(set_index, tag, mask, idx, status)) {
+    if (status == HIT_RESERVED || status == HIT)
+      this->cache_hit(idx, mf->is_critical());
+    return status;
   }
 
   // Make prediction.
@@ -250,8 +243,7 @@ enum cache_request_status cacp_tag_array::access(
           // Update CACP predictor.
           evict_line(idx, /*set_index=*/ m_config.tag(addr));
         }
-        m_lines[idx]->allocate(m_config.tag(addr), m_config.block_addr(addr),
-                               time, mf->get_access_sector_mask());
+        allocate_line(idx, addr, time, mf->get_access_sector_mask());
       }
       break;
     case SECTOR_MISS:
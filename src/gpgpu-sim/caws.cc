@@ -2,21 +2,131 @@
 
 #include "shader.h"
 
-static bool cmp_warps_by_criticality(shd_warp_t* lhs, shd_warp_t* rhs)
+// cpl_warp_order
+
+// Same ordering as the original comparison of two warps: exited and waiting
+// warps never come first, otherwise higher CPL first and the older dynamic
+// warp on a tie.  NaN CPLs compare equal to everything, which the caller
+// handles with the plain selection sort.
+bool cpl_warp_order::before(unsigned lhs, unsigned rhs) const
 {
-  assert(lhs != NULL && rhs != NULL);
-  if (lhs->done_exit() || lhs->waiting()) {
+  const key &l = m_keys[lhs];
+  const key &r = m_keys[rhs];
+  if (l.idle) {
     return false;
   }
-  if (rhs->done_exit() || rhs->waiting()) {
+  if (r.idle) {
     return true;
   }
-  if (lhs->get_cpl() == rhs->get_cpl()) {
-    return lhs->get_dynamic_warp_id() < rhs->get_dynamic_warp_id();
+  if (l.cpl == r.cpl) {
+    return l.dynamic_warp_id < r.dynamic_warp_id;
+  }
+  return l.cpl > r.cpl;
+}
+
+void cpl_warp_order::selection_sort(std::vector<shd_warp_t *> &warps) const
+{
+  for (unsigned i = 0; i + 1 < warps.size(); ++i) {
+    unsigned jMax = i;
+    for (unsigned j = i + 1; j < warps.size(); ++j) {
+      if (before(warps[j]->get_warp_id(), warps[jMax]->get_warp_id())) {
+        jMax = j;
+      }
+    }
+    if (jMax != i) {
+      shd_warp_t *tmp = warps[i];
+      warps[i] = warps[jMax];
+      warps[jMax] = tmp;
+    }
   }
-  return lhs->get_cpl() > rhs->get_cpl();
 }
 
+void cpl_warp_order::sort(std::vector<shd_warp_t *> &warps)
+{
+  // A selection sort never inspects a single warp, and only inspects the
+  // first one when some other warp can issue: keep waiting() (which may clear
+  // a memory barrier) from being called any more often than it was.
+  unsigned n = warps.size();
+  if (n < 2) {
+    return;
+  }
+  m_stamp += 2;
+  bool any_issuable = false;
+  bool has_nan = false;
+  for (unsigned i = n; i-- > 0;) {
+    shd_warp_t *w = warps[i];
+    assert(w != NULL);
+    if (i == 0 && !any_issuable) {
+      return;
+    }
+    unsigned wid = w->get_warp_id();
+    if (wid >= m_keys.size()) {
+      m_keys.resize(wid + 1);
+      m_pos.resize(wid + 1);
+      m_in_list.resize(wid + 1, 0);
+    }
+    key &k = m_keys[wid];
+    k.idle = w->done_exit() || w->waiting();
+    k.cpl = w->get_cpl();
+    k.dynamic_warp_id = w->get_dynamic_warp_id();
+    m_pos[wid] = i;
+    m_in_list[wid] = m_stamp;
+    if (!k.idle) {
+      any_issuable = true;
+      has_nan |= k.cpl != k.cpl;
+    }
+  }
+  if (has_nan) {
+    selection_sort(warps);
+    return;
+  }
+
+  // Issuable warps in last cycle's order, then the newly issuable ones.
+  unsigned kept = 0;
+  for (unsigned i = 0; i < m_sorted.size(); ++i) {
+    unsigned wid = m_sorted[i];
+    if (m_in_list[wid] == m_stamp && !m_keys[wid].idle) {
+      m_in_list[wid] = m_stamp + 1;
+      m_sorted[kept++] = wid;
+    }
+  }
+  m_sorted.resize(kept);
+  for (unsigned i = 0; i < n; ++i) {
+    unsigned wid = warps[i]->get_warp_id();
+    if (m_in_list[wid] == m_stamp && !m_keys[wid].idle) {
+      m_sorted.push_back(wid);
+    }
+  }
+
+  // Insertion sort: linear when the ranking did not change.
+  for (unsigned i = 1; i < m_sorted.size(); ++i) {
+    unsigned wid = m_sorted[i];
+    unsigned j = i;
+    while (j > 0 && before(wid, m_sorted[j - 1])) {
+      m_sorted[j] = m_sorted[j - 1];
+      j--;
+    }
+    m_sorted[j] = wid;
+  }
+
+  // Replay the swaps of the selection sort so that the waiting warps end up
+  // in the same positions as well.  The keys of issuable warps are distinct,
+  // so step i always picks m_sorted[i].
+  for (unsigned i = 0; i < m_sorted.size(); ++i) {
+    unsigned wid = m_sorted[i];
+    unsigned p = m_pos[wid];
+    if (p == i) {
+      continue;
+    }
+    shd_warp_t *displaced = warps[i];
+    warps[i] = warps[p];
+    warps[p] = displaced;
+    m_pos[displaced->get_warp_id()] = p;
+    m_pos[wid] = i;
+  }
+}
+// End cpl_warp_order
+
 // CAWS
 caws_scheduler::caws_scheduler(
     shader_core_stats *stats, shader_core_ctx *shader,
@@ -57,19 +167,7 @@ void caws_scheduler::order_by_priority(
 
 void caws_scheduler::sort_warps(std::vector<shd_warp_t*>& temp)
 {
-  for (unsigned i = 0; i < temp.size() - 1; ++i) {
-    unsigned jMax = i;
-    for (unsigned j = i + 1; j < temp.size(); ++j) {
-      if (cmp_warps_by_criticality(temp[j], temp[jMax])) {
-        jMax = j;
-      }
-    }
-    if (jMax != i) {
-      shd_warp_t *tmp = temp[i];
-      temp[i] = temp[jMax];
-      temp[jMax] = tmp;
-    }
-  }
+  m_cpl_order.sort(temp);
 }
 // End CAWS
 
@@ -124,18 +222,6 @@ void gcaws_scheduler::order_by_priority(
 }
 
 void gcaws_scheduler::sort_warps(std::vector<shd_warp_t*>& temp) {
-  for (unsigned i = 0; i < temp.size()-1; ++i) {
-    unsigned jMax = i;
-    for (unsigned j = i+1; j < temp.size(); ++j) {
-      if (cmp_warps_by_criticality(temp[j], temp[jMax])) {
-        jMax = j;
-      }
-    }
-    if (jMax != i) {
-      shd_warp_t* tmp = temp[i];
-      temp[i] = temp[jMax];
-      temp[jMax] = tmp;
-    }
-  }
+  m_cpl_order.sort(temp);
 }
 // End GCAWS
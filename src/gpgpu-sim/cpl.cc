@@ -13,8 +13,22 @@ void gpgpu_sim::print_cpl_accuracy() const
 {
   m_shader_stats->print_cpl_accuracy(stdout);
 }
+
+float gpgpu_sim::get_warp_cpl(unsigned sid, unsigned wid) const
+{
+  if (sid >= m_shader_config->num_shader()) return 0;
+  return m_cluster[m_shader_config->sid_to_cluster(sid)]->get_warp_cpl(
+      m_shader_config->sid_to_cid(sid), wid);
+}
 // End gpgpu_sim
 
+// simt_core_cluster
+float simt_core_cluster::get_warp_cpl(unsigned cid, unsigned warp_id) const
+{
+  return m_core[cid]->get_warp_cpl(warp_id);
+}
+// End simt_core_cluster
+
 // shader_core_stats
 void shader_core_stats::cpl_launch_kernel(unsigned kid, unsigned total_cta,
                                           unsigned num_warps_per_cta)
@@ -51,6 +65,10 @@ void shader_core_config::cawa_reg_options(class OptionParser * opp)
   option_parser_register(
       opp, "-enable_cacp_l1_cache", OPT_BOOL, &enable_cacp_l1_cache,
       "Enable CACP L1 cache", "0");
+  option_parser_register(
+      opp, "-cacp_criticality_epoch", OPT_UINT32, &cacp_criticality_epoch,
+      "Cycles between warp criticality reclassifications for CACP "
+      "(0 = whenever the CPLs change)", "0");
 }
 // End shader_core_config
 
@@ -76,6 +94,12 @@ std::vector<float> shader_core_ctx::get_current_cpl_counters() const
   return ret;
 }
 
+float shader_core_ctx::get_warp_cpl(unsigned warp_id) const
+{
+  if (warp_id >= m_warp.size()) return 0;
+  return m_warp[warp_id]->get_cpl();
+}
+
 void shader_core_ctx::print_cpl_counters(unsigned start_id,
                                          unsigned end_id) const
 {
@@ -108,10 +132,10 @@ void shader_core_ctx::calc_shader_cpl_accuracy() const
       }
     }
     if (num_larger >= (end_warp_id-start_warp_id) / 2) {
-      m_stats->cpl_accurate_cpl_for_accuracy++;
+      __sync_fetch_and_add(&m_stats->cpl_accurate_cpl_for_accuracy, 1);
     }
 
-    m_stats->cpl_total_cpl_for_accuracy++;
+    __sync_fetch_and_add(&m_stats->cpl_total_cpl_for_accuracy, 1);
   }
 }
 
@@ -120,6 +144,10 @@ void shader_core_ctx::calc_shader_cpl(unsigned cycle)
   for (unsigned i = 0; i < m_warp.size(); ++i) {
     m_warp[i]->calc_warp_cpl(cycle);
   }
+  unsigned epoch = m_config->cacp_criticality_epoch;
+  if (epoch == 0 || cycle >= m_cpl_range_cycle + epoch) {
+    m_cpl_range_valid = false;
+  }
 
   calc_shader_cpl_accuracy();
 }
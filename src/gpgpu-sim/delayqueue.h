@@ -36,12 +36,9 @@
 #include "../statwrapper.h"
 #include "gpu-misc.h"
 
-template <class T>
-struct fifo_data {
-  T* m_data;
-  fifo_data* m_next;
-};
-
+// Fixed-capacity ring buffer.  Slots holding NULL are delay bubbles: the queue
+// is kept at least m_min_len long by padding it with NULL entries, and a push
+// onto a trailing bubble fills it in place instead of growing the queue.
 template <class T>
 class fifo_pipeline {
  public:
@@ -52,54 +49,32 @@ class fifo_pipeline {
     m_max_len = maxlen;
     m_length = 0;
     m_n_element = 0;
-    m_head = NULL;
-    m_tail = NULL;
+    m_head = 0;
+    // power-of-two capacity so that indices wrap with a mask
+    unsigned capacity = 1;
+    while (capacity < m_max_len) capacity <<= 1;
+    m_mask = capacity - 1;
+    m_slots = new T*[capacity];
     for (unsigned i = 0; i < m_min_len; i++) push(NULL);
   }
 
-  ~fifo_pipeline() {
-    while (m_head) {
-      m_tail = m_head;
-      m_head = m_head->m_next;
-      delete m_tail;
-    }
-  }
+  ~fifo_pipeline() { delete[] m_slots; }
 
   void push(T* data) {
     assert(m_length < m_max_len);
-    if (m_head) {
-      if (m_tail->m_data || m_length < m_min_len) {
-        m_tail->m_next = new fifo_data<T>();
-        m_tail = m_tail->m_next;
-        m_length++;
-        m_n_element++;
-      }
-    } else {
-      m_head = m_tail = new fifo_data<T>();
+    if (m_length == 0 || m_slots[tail()] || m_length < m_min_len) {
       m_length++;
       m_n_element++;
     }
-    m_tail->m_next = NULL;
-    m_tail->m_data = data;
+    m_slots[tail()] = data;
   }
 
   T* pop() {
-    fifo_data<T>* next;
     T* data;
-    if (m_head) {
-      next = m_head->m_next;
-      data = m_head->m_data;
-      if (m_head == m_tail) {
-        assert(next == NULL);
-        m_tail = NULL;
-      }
-      delete m_head;
-      m_head = next;
+    if (m_length) {
+      data = m_slots[m_head];
+      m_head = (m_head + 1) & m_mask;
       m_length--;
-      if (m_length == 0) {
-        assert(m_head == NULL);
-        m_tail = m_head;
-      }
       m_n_element--;
       if (m_min_len && m_length < m_min_len) {
         push(NULL);
@@ -111,12 +86,23 @@ class fifo_pipeline {
     return data;
   }
 
-  T* top() const {
-    if (m_head) {
-      return m_head->m_data;
-    } else {
-      return NULL;
-    }
+  T* top() const { return m_length ? m_slots[m_head] : NULL; }
+
+  // Moves the oldest entry for which pred holds to the head, keeping the
+  // order of the others.  Returns false if there is no such entry.
+  template <class Pred>
+  bool promote(Pred pred) {
+    unsigned i = 0;
+    while (i < m_length &&
+           !(m_slots[(m_head + i) & m_mask] &&
+             pred(m_slots[(m_head + i) & m_mask])))
+      i++;
+    if (i == m_length) return false;
+    T* data = m_slots[(m_head + i) & m_mask];
+    for (; i > 0; i--)
+      m_slots[(m_head + i) & m_mask] = m_slots[(m_head + i - 1) & m_mask];
+    m_slots[m_head] = data;
+    return true;
   }
 
   void set_min_length(unsigned int new_min_len) {
@@ -130,23 +116,15 @@ class fifo_pipeline {
       }
     } else {
       // in this branch imply that the original min_len is larger then 0
-      // ie. head != 0
-      assert(m_head);
+      // ie. the queue is not empty
+      assert(m_length);
       m_min_len = new_min_len;
-      while ((m_length > m_min_len) && (m_tail->m_data == 0)) {
-        fifo_data<T>* iter;
-        iter = m_head;
-        while (iter && (iter->m_next != m_tail)) iter = iter->m_next;
-        if (!iter) {
-          // there is only one node, and that node is empty
-          assert(m_head->m_data == 0);
+      while ((m_length > m_min_len) && (m_slots[tail()] == 0)) {
+        if (m_length == 1) {
+          // there is only one entry, and that entry is empty
           pop();
         } else {
-          // there are more than one node, and tail node is empty
-          assert(iter->m_next == m_tail);
-          delete m_tail;
-          m_tail = iter;
-          m_tail->m_next = 0;
+          // drop the trailing bubble
           m_length--;
         }
       }
@@ -157,22 +135,25 @@ class fifo_pipeline {
   bool is_avilable_size(unsigned size) const {
     return (m_max_len && m_length + size - 1 >= m_max_len);
   }
-  bool empty() const { return m_head == NULL; }
+  bool empty() const { return m_length == 0; }
   unsigned get_n_element() const { return m_n_element; }
   unsigned get_length() const { return m_length; }
   unsigned get_max_len() const { return m_max_len; }
 
   void print() const {
-    fifo_data<T>* ddp = m_head;
     printf("%s(%d): ", m_name, m_length);
-    while (ddp) {
-      printf("%p ", ddp->m_data);
-      ddp = ddp->m_next;
-    }
+    for (unsigned i = 0; i < m_length; i++)
+      printf("%p ", m_slots[(m_head + i) & m_mask]);
     printf("\n");
   }
 
  private:
+  // not copyable: the slot array is owned
+  fifo_pipeline(const fifo_pipeline&);
+  fifo_pipeline& operator=(const fifo_pipeline&);
+
+  unsigned tail() const { return (m_head + m_length - 1) & m_mask; }
+
   const char* m_name;
 
   unsigned int m_min_len;
@@ -180,8 +161,9 @@ class fifo_pipeline {
   unsigned int m_length;
   unsigned int m_n_element;
 
-  fifo_data<T>* m_head;
-  fifo_data<T>* m_tail;
+  T** m_slots;
+  unsigned int m_mask;
+  unsigned int m_head;  // index of the oldest entry
 };
 
 #endif
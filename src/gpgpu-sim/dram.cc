@@ -62,6 +62,8 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
   banks_1time = 0;
   banks_acess_total = 0;
   banks_acess_total_after = 0;
+  banks_time_rw = 0;
+  banks_access_rw_total = 0;
   banks_time_ready = 0;
   banks_access_ready_total = 0;
   issued_two = 0;
@@ -119,14 +121,16 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
       m_config->gpgpu_dram_return_queue_size == 0
           ? 1024
           : m_config->gpgpu_dram_return_queue_size);
-  m_frfcfs_scheduler = NULL;
+  m_scheduler = NULL;
   if (m_config->scheduler_type == DRAM_FRFCFS)
-    m_frfcfs_scheduler = new frfcfs_scheduler(m_config, this, stats);
+    m_scheduler = create_dram_scheduler(m_config->dram_sched_policy, m_config,
+                                        this, stats);
   n_cmd = 0;
   n_activity = 0;
   n_nop = 0;
   n_act = 0;
   n_pre = 0;
+  n_ref = 0;
   n_rd = 0;
   n_wr = 0;
   n_wr_WB = 0;
@@ -163,13 +167,13 @@ bool dram_t::full(bool is_write) const {
     if (m_config->gpgpu_frfcfs_dram_sched_queue_size == 0) return false;
     if (m_config->seperate_write_queue_enabled) {
       if (is_write)
-        return m_frfcfs_scheduler->num_write_pending() >=
+        return m_scheduler->num_write_pending() >=
                m_config->gpgpu_frfcfs_dram_write_queue_size;
       else
-        return m_frfcfs_scheduler->num_pending() >=
+        return m_scheduler->num_pending() >=
                m_config->gpgpu_frfcfs_dram_sched_queue_size;
     } else
-      return m_frfcfs_scheduler->num_pending() >=
+      return m_scheduler->num_pending() >=
              m_config->gpgpu_frfcfs_dram_sched_queue_size;
   } else
     return mrqq->full();
@@ -178,7 +182,7 @@ bool dram_t::full(bool is_write) const {
 unsigned dram_t::que_length() const {
   unsigned nreqs = 0;
   if (m_config->scheduler_type == DRAM_FRFCFS) {
-    nreqs = m_frfcfs_scheduler->num_pending();
+    nreqs = m_scheduler->num_pending();
   } else {
     nreqs = mrqq->get_length();
   }
@@ -257,7 +261,7 @@ void dram_t::push(class mem_fetch *data) {
   n_req += 1;
   n_req_partial += 1;
   if (m_config->scheduler_type == DRAM_FRFCFS) {
-    unsigned nreqs = m_frfcfs_scheduler->num_pending();
+    unsigned nreqs = m_scheduler->num_pending();
     if (nreqs > max_mrqs_temp) max_mrqs_temp = nreqs;
   } else {
     max_mrqs_temp = (max_mrqs_temp > mrqq->get_length()) ? max_mrqs_temp
@@ -322,14 +326,14 @@ void dram_t::cycle() {
       scheduler_fifo();
       break;
     case DRAM_FRFCFS:
-      scheduler_frfcfs();
+      scheduler_queue();
       break;
     default:
       printf("Error: Unknown DRAM scheduler type\n");
       assert(0);
   }
   if (m_config->scheduler_type == DRAM_FRFCFS) {
-    unsigned nreqs = m_frfcfs_scheduler->num_pending();
+    unsigned nreqs = m_scheduler->num_pending();
     if (nreqs > max_mrqs) {
       max_mrqs = nreqs;
     }
@@ -777,6 +781,7 @@ void dram_t::print(FILE *simFile) const {
   if (m_config->scheduler_type == DRAM_FRFCFS)
     fprintf(simFile, "mrqq: max=%d avg=%g\n", max_mrqs,
             (float)ave_mrqs / n_cmd);
+  if (m_scheduler) m_scheduler->print_stat(simFile);
 }
 
 void dram_t::visualize() const {
@@ -790,7 +795,7 @@ void dram_t::visualize() const {
       printf("txf: %d %d", bk[i]->mrq->nbytes, bk[i]->mrq->txbytes);
     printf("\n");
   }
-  if (m_frfcfs_scheduler) m_frfcfs_scheduler->print(stdout);
+  if (m_scheduler) m_scheduler->print(stdout);
 }
 
 void dram_t::print_stat(FILE *simFile) {
@@ -148,7 +148,7 @@ class dram_t {
   unsigned get_bankgrp_number(unsigned i);
 
   void scheduler_fifo();
-  void scheduler_frfcfs();
+  void scheduler_queue();
 
   bool issue_col_command(int j);
   bool issue_row_command(int j);
@@ -227,7 +227,7 @@ class dram_t {
   unsigned int max_mrqs;
   unsigned int ave_mrqs;
 
-  class frfcfs_scheduler *m_frfcfs_scheduler;
+  class dram_scheduler *m_scheduler;
 
   unsigned int n_cmd_partial;
   unsigned int n_activity_partial;
@@ -241,7 +241,7 @@ class dram_t {
   class memory_stats_t *m_stats;
   class Stats *mrqq_Dist;  // memory request queue inside DRAM
 
-  friend class frfcfs_scheduler;
+  friend class dram_scheduler;
 };
 
 #endif /*DRAM_H*/
@@ -32,61 +32,28 @@
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
 
-frfcfs_scheduler::frfcfs_scheduler(const memory_config *config, dram_t *dm,
-                                   memory_stats_t *stats) {
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <string>
+
+dram_scheduler::dram_scheduler(const memory_config *config, dram_t *dm,
+                               memory_stats_t *stats) {
   m_config = config;
   m_stats = stats;
   m_num_pending = 0;
   m_num_write_pending = 0;
+  m_mode = READ_MODE;
   m_dram = dm;
-  m_queue = new std::list<dram_req_t *>[m_config->nbk];
-  m_bins = new std::map<
-      unsigned, std::list<std::list<dram_req_t *>::iterator> >[m_config->nbk];
-  m_last_row =
-      new std::list<std::list<dram_req_t *>::iterator> *[m_config->nbk];
   curr_row_service_time = new unsigned[m_config->nbk];
   row_service_timestamp = new unsigned[m_config->nbk];
   for (unsigned i = 0; i < m_config->nbk; i++) {
-    m_queue[i].clear();
-    m_bins[i].clear();
-    m_last_row[i] = NULL;
     curr_row_service_time[i] = 0;
     row_service_timestamp[i] = 0;
   }
-  if (m_config->seperate_write_queue_enabled) {
-    m_write_queue = new std::list<dram_req_t *>[m_config->nbk];
-    m_write_bins = new std::map<
-        unsigned, std::list<std::list<dram_req_t *>::iterator> >[m_config->nbk];
-    m_last_write_row =
-        new std::list<std::list<dram_req_t *>::iterator> *[m_config->nbk];
-
-    for (unsigned i = 0; i < m_config->nbk; i++) {
-      m_write_queue[i].clear();
-      m_write_bins[i].clear();
-      m_last_write_row[i] = NULL;
-    }
-  }
-  m_mode = READ_MODE;
 }
 
-void frfcfs_scheduler::add_req(dram_req_t *req) {
-  if (m_config->seperate_write_queue_enabled && req->data->is_write()) {
-    assert(m_num_write_pending < m_config->gpgpu_frfcfs_dram_write_queue_size);
-    m_num_write_pending++;
-    m_write_queue[req->bk].push_front(req);
-    std::list<dram_req_t *>::iterator ptr = m_write_queue[req->bk].begin();
-    m_write_bins[req->bk][req->row].push_front(ptr);  // newest reqs to the
-                                                      // front
-  } else {
-    assert(m_num_pending < m_config->gpgpu_frfcfs_dram_sched_queue_size);
-    m_num_pending++;
-    m_queue[req->bk].push_front(req);
-    std::list<dram_req_t *>::iterator ptr = m_queue[req->bk].begin();
-    m_bins[req->bk][req->row].push_front(ptr);  // newest reqs to the front
-  }
-}
-
-void frfcfs_scheduler::data_collection(unsigned int bank) {
+void dram_scheduler::data_collection(unsigned int bank) {
   if (m_dram->m_gpu->gpu_sim_cycle > row_service_timestamp[bank]) {
     curr_row_service_time[bank] =
         m_dram->m_gpu->gpu_sim_cycle - row_service_timestamp[bank];
@@ -106,56 +73,8 @@ void frfcfs_scheduler::data_collection(unsigned int bank) {
   m_stats->num_activates[m_dram->id][bank]++;
 }
 
-dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
-  // row
-  bool rowhit = true;
-  std::list<dram_req_t *> *m_current_queue = m_queue;
-  std::map<unsigned, std::list<std::list<dram_req_t *>::iterator> >
-      *m_current_bins = m_bins;
-  std::list<std::list<dram_req_t *>::iterator> **m_current_last_row =
-      m_last_row;
-
-  if (m_config->seperate_write_queue_enabled) {
-    if (m_mode == READ_MODE &&
-        ((m_num_write_pending >= m_config->write_high_watermark)
-         // || (m_queue[bank].empty() && !m_write_queue[bank].empty())
-         )) {
-      m_mode = WRITE_MODE;
-    } else if (m_mode == WRITE_MODE &&
-               ((m_num_write_pending < m_config->write_low_watermark)
-                //  || (!m_queue[bank].empty() && m_write_queue[bank].empty())
-                )) {
-      m_mode = READ_MODE;
-    }
-  }
-
-  if (m_mode == WRITE_MODE) {
-    m_current_queue = m_write_queue;
-    m_current_bins = m_write_bins;
-    m_current_last_row = m_last_write_row;
-  }
-
-  if (m_current_last_row[bank] == NULL) {
-    if (m_current_queue[bank].empty()) return NULL;
-
-    std::map<unsigned, std::list<std::list<dram_req_t *>::iterator> >::iterator
-        bin_ptr = m_current_bins[bank].find(curr_row);
-    if (bin_ptr == m_current_bins[bank].end()) {
-      dram_req_t *req = m_current_queue[bank].back();
-      bin_ptr = m_current_bins[bank].find(req->row);
-      assert(bin_ptr !=
-             m_current_bins[bank].end());  // where did the request go???
-      m_current_last_row[bank] = &(bin_ptr->second);
-      data_collection(bank);
-      rowhit = false;
-    } else {
-      m_current_last_row[bank] = &(bin_ptr->second);
-      rowhit = true;
-    }
-  }
-  std::list<dram_req_t *>::iterator next = m_current_last_row[bank]->back();
-  dram_req_t *req = (*next);
-
+void dram_scheduler::record_access(unsigned bank, const dram_req_t *req,
+                                   bool rowhit) {
   // rowblp stats
   m_dram->access_num++;
   bool is_write = req->data->is_write();
@@ -174,13 +93,262 @@ dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
 
   m_stats->concurrent_row_access[m_dram->id][bank]++;
   m_stats->row_access[m_dram->id][bank]++;
-  m_current_last_row[bank]->pop_back();
+}
+
+unsigned long long dram_scheduler::sim_cycle() const {
+  return m_dram->m_gpu->gpu_sim_cycle + m_dram->m_gpu->gpu_tot_sim_cycle;
+}
+
+float dram_scheduler::warp_cpl(const dram_req_t *req) const {
+  return m_dram->m_gpu->get_warp_cpl(req->data->get_sid(),
+                                     req->data->get_wid());
+}
+
+void dram_scheduler::update_mode() {
+  if (!m_config->seperate_write_queue_enabled) return;
+  if (m_mode == READ_MODE &&
+      m_num_write_pending >= m_config->write_high_watermark)
+    m_mode = WRITE_MODE;
+  else if (m_mode == WRITE_MODE &&
+           m_num_write_pending < m_config->write_low_watermark)
+    m_mode = READ_MODE;
+}
+
+typedef std::map<std::string, dram_scheduler_factory> dram_scheduler_map;
+
+static dram_scheduler_map &dram_scheduler_registry() {
+  static dram_scheduler_map registry;
+  return registry;
+}
+
+void register_dram_scheduler(const char *name,
+                             dram_scheduler_factory factory) {
+  dram_scheduler_registry()[name] = factory;
+}
+
+dram_scheduler *create_dram_scheduler(const char *name,
+                                      const memory_config *config,
+                                      dram_t *dm, memory_stats_t *stats) {
+  dram_scheduler_map &registry = dram_scheduler_registry();
+  dram_scheduler_map::iterator f = registry.find(name);
+  if (f == registry.end()) {
+    printf("GPGPU-Sim uArch: ERROR ** unknown DRAM scheduler policy \"%s\"; "
+           "available:",
+           name);
+    for (f = registry.begin(); f != registry.end(); ++f)
+      printf(" %s", f->first.c_str());
+    printf("\n");
+    abort();
+  }
+  return f->second(config, dm, stats);
+}
+
+REGISTER_DRAM_SCHEDULER(frfcfs_scheduler, "frfcfs");
+REGISTER_DRAM_SCHEDULER(parbs_scheduler, "parbs");
+REGISTER_DRAM_SCHEDULER(atlas_scheduler, "atlas");
+REGISTER_DRAM_SCHEDULER(bliss_scheduler, "bliss");
+
+#define FRFCFS_INITIAL_BINS 16
+
+frfcfs_queue::frfcfs_queue(unsigned nbk) : m_free(-1), m_banks(nbk) {
+  for (unsigned b = 0; b < nbk; b++) {
+    bank_queue &bq = m_banks[b];
+    bq.newest = bq.oldest = -1;
+    bq.size = 0;
+    bq.n_bins = 0;
+    bq.bins.resize(FRFCFS_INITIAL_BINS);
+    for (unsigned i = 0; i < bq.bins.size(); i++) bq.bins[i].newest = -1;
+  }
+}
+
+int frfcfs_queue::alloc_node() {
+  if (m_free < 0) {
+    m_nodes.push_back(node());
+    return m_nodes.size() - 1;
+  }
+  int n = m_free;
+  m_free = m_nodes[n].older;
+  return n;
+}
+
+int frfcfs_queue::find_bin(const bank_queue &bq, unsigned row) const {
+  unsigned mask = bq.bins.size() - 1;
+  for (unsigned i = hash_row(row, mask);; i = (i + 1) & mask) {
+    if (bq.bins[i].newest < 0) return -1;
+    if (bq.bins[i].row == row) return i;
+  }
+}
+
+int frfcfs_queue::insert_bin(bank_queue &bq, unsigned row) {
+  if (2 * (bq.n_bins + 1) > bq.bins.size()) grow_bins(bq);
+  unsigned mask = bq.bins.size() - 1;
+  unsigned i = hash_row(row, mask);
+  while (bq.bins[i].newest >= 0) i = (i + 1) & mask;
+  bq.bins[i].row = row;
+  bq.n_bins++;
+  return i;
+}
+
+// linear probing with backward-shift deletion, so lookups never have to step
+// over tombstones
+void frfcfs_queue::erase_bin(bank_queue &bq, int slot) {
+  unsigned mask = bq.bins.size() - 1;
+  unsigned hole = slot;
+  for (unsigned i = (hole + 1) & mask; bq.bins[i].newest >= 0;
+       i = (i + 1) & mask) {
+    unsigned home = hash_row(bq.bins[i].row, mask);
+    // move the entry into the hole unless its home lies cyclically in
+    // (hole, i]
+    bool stays = (hole <= i) ? (hole < home && home <= i)
+                             : (hole < home || home <= i);
+    if (stays) continue;
+    bq.bins[hole] = bq.bins[i];
+    hole = i;
+  }
+  bq.bins[hole].newest = -1;
+  bq.n_bins--;
+}
+
+void frfcfs_queue::grow_bins(bank_queue &bq) {
+  std::vector<row_bin> old(2 * bq.bins.size());
+  old.swap(bq.bins);
+  for (unsigned i = 0; i < bq.bins.size(); i++) bq.bins[i].newest = -1;
+  unsigned mask = bq.bins.size() - 1;
+  for (unsigned j = 0; j < old.size(); j++) {
+    if (old[j].newest < 0) continue;
+    unsigned i = hash_row(old[j].row, mask);
+    while (bq.bins[i].newest >= 0) i = (i + 1) & mask;
+    bq.bins[i] = old[j];
+  }
+}
+
+void frfcfs_queue::push(dram_req_t *req) {
+  bank_queue &bq = m_banks[req->bk];
+  int n = alloc_node();
+  node &nd = m_nodes[n];
+  nd.req = req;
+
+  // newest reqs to the front
+  nd.newer = -1;
+  nd.older = bq.newest;
+  if (bq.newest >= 0)
+    m_nodes[bq.newest].newer = n;
+  else
+    bq.oldest = n;
+  bq.newest = n;
+  bq.size++;
+
+  int slot = find_bin(bq, req->row);
+  if (slot < 0) {
+    slot = insert_bin(bq, req->row);
+    bq.bins[slot].oldest = n;
+  } else {
+    m_nodes[bq.bins[slot].newest].row_newer = n;
+  }
+  nd.row_newer = -1;
+  nd.row_older = bq.bins[slot].newest;
+  bq.bins[slot].newest = n;
+}
+
+dram_req_t *frfcfs_queue::oldest_critical(unsigned bank) const {
+  for (int n = m_banks[bank].oldest; n >= 0; n = m_nodes[n].newer)
+    if (m_nodes[n].req->data->is_critical()) return m_nodes[n].req;
+  return NULL;
+}
+
+dram_req_t *frfcfs_queue::pop(unsigned bank, unsigned row, bool &row_done) {
+  bank_queue &bq = m_banks[bank];
+  int slot = find_bin(bq, row);
+  assert(slot >= 0);  // where did the request go???
+  row_bin &bin = bq.bins[slot];
+  int n = bin.oldest;
+  node &nd = m_nodes[n];
+
+  bin.oldest = nd.row_newer;
+  row_done = (bin.oldest < 0);
+  if (row_done)
+    erase_bin(bq, slot);
+  else
+    m_nodes[bin.oldest].row_older = -1;
+
+  if (nd.newer >= 0)
+    m_nodes[nd.newer].older = nd.older;
+  else
+    bq.newest = nd.older;
+  if (nd.older >= 0)
+    m_nodes[nd.older].newer = nd.newer;
+  else
+    bq.oldest = nd.newer;
+  bq.size--;
+
+  dram_req_t *req = nd.req;
+  nd.req = NULL;
+  nd.older = m_free;
+  m_free = n;
+  return req;
+}
+
+frfcfs_scheduler::frfcfs_scheduler(const memory_config *config, dram_t *dm,
+                                   memory_stats_t *stats)
+    : dram_scheduler(config, dm, stats),
+      m_queue(config->nbk),
+      m_row_open(config->nbk, false),
+      m_last_row(config->nbk, 0),
+      m_write_queue(config->seperate_write_queue_enabled ? config->nbk : 0),
+      m_write_row_open(config->nbk, false),
+      m_last_write_row(config->nbk, 0) {}
+
+void frfcfs_scheduler::add_req(dram_req_t *req) {
+  if (m_config->seperate_write_queue_enabled && req->data->is_write()) {
+    assert(m_num_write_pending < m_config->gpgpu_frfcfs_dram_write_queue_size);
+    m_num_write_pending++;
+    m_write_queue.push(req);
+  } else {
+    assert(m_num_pending < m_config->gpgpu_frfcfs_dram_sched_queue_size);
+    m_num_pending++;
+    m_queue.push(req);
+  }
+}
+
+dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
+  // row
+  bool rowhit = true;
+  frfcfs_queue *m_current_queue = &m_queue;
+  std::vector<bool> *m_current_row_open = &m_row_open;
+  std::vector<unsigned> *m_current_last_row = &m_last_row;
 
-  m_current_queue[bank].erase(next);
-  if (m_current_last_row[bank]->empty()) {
-    m_current_bins[bank].erase(req->row);
-    m_current_last_row[bank] = NULL;
+  update_mode();
+  if (m_mode == WRITE_MODE) {
+    m_current_queue = &m_write_queue;
+    m_current_row_open = &m_write_row_open;
+    m_current_last_row = &m_last_write_row;
   }
+
+  if (!(*m_current_row_open)[bank]) {
+    if (m_current_queue->empty(bank)) return NULL;
+
+    if (!m_current_queue->has_row(bank, curr_row)) {
+      // with -gpgpu_mem_cpl_priority the oldest critical request picks the
+      // row to open
+      dram_req_t *first = NULL;
+      if (m_config->gpgpu_mem_cpl_priority)
+        first = m_current_queue->oldest_critical(bank);
+      if (first == NULL) first = m_current_queue->oldest(bank);
+      (*m_current_last_row)[bank] = first->row;
+      data_collection(bank);
+      rowhit = false;
+    } else {
+      (*m_current_last_row)[bank] = curr_row;
+      rowhit = true;
+    }
+    (*m_current_row_open)[bank] = true;
+  }
+  bool row_done;
+  dram_req_t *req =
+      m_current_queue->pop(bank, (*m_current_last_row)[bank], row_done);
+  if (row_done) (*m_current_row_open)[bank] = false;
+
+  record_access(bank, req, rowhit);
 #ifdef DEBUG_FAST_IDEAL_SCHED
   if (req)
     printf("%08u : DRAM(%u) scheduling memory request to bank=%u, row=%u\n",
@@ -200,19 +368,240 @@ dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
 
 void frfcfs_scheduler::print(FILE *fp) {
   for (unsigned b = 0; b < m_config->nbk; b++) {
-    printf(" %u: queue length = %u\n", b, (unsigned)m_queue[b].size());
+    printf(" %u: queue length = %u\n", b, m_queue.size(b));
+  }
+}
+
+dram_app_scheduler::dram_app_scheduler(const memory_config *config,
+                                       dram_t *dm, memory_stats_t *stats)
+    : dram_scheduler(config, dm, stats), m_bank_queue(config->nbk) {
+  m_n_sources = dm->m_gpu->get_config().get_max_concurrent_kernel();
+}
+
+void dram_app_scheduler::add_req(dram_req_t *req) {
+  if (m_config->seperate_write_queue_enabled && req->data->is_write()) {
+    assert(m_num_write_pending < m_config->gpgpu_frfcfs_dram_write_queue_size);
+    m_num_write_pending++;
+  } else {
+    assert(m_num_pending < m_config->gpgpu_frfcfs_dram_sched_queue_size);
+    m_num_pending++;
+  }
+  entry e;
+  e.req = req;
+  e.kernel_uid = req->data->get_kernel_uid();
+  e.source = e.kernel_uid % m_n_sources;
+  e.arrival = sim_cycle();
+  e.marked = false;
+  e.cpl = 0;
+  m_bank_queue[req->bk].push_back(e);
+}
+
+dram_req_t *dram_app_scheduler::schedule(unsigned bank, unsigned curr_row) {
+  std::vector<entry> &q = m_bank_queue[bank];
+  if (q.empty()) return NULL;
+  update_mode();
+  // with the write queue enabled only requests of the current mode are
+  // eligible
+  bool writes = m_mode == WRITE_MODE;
+  unsigned best = 0;
+  if (m_config->seperate_write_queue_enabled) {
+    while (best < q.size() && q[best].req->data->is_write() != writes) best++;
+    if (best == q.size()) return NULL;
+  }
+  update(sim_cycle());
+
+  if (m_config->dram_sched_cpl_priority)
+    for (unsigned i = 0; i < q.size(); i++) q[i].cpl = warp_cpl(q[i].req);
+
+  // q is in arrival order, so the first of equally ranked requests wins
+  for (unsigned i = best + 1; i < q.size(); i++) {
+    if (m_config->seperate_write_queue_enabled &&
+        q[i].req->data->is_write() != writes)
+      continue;
+    if (better(q[i], q[best], curr_row)) best = i;
+  }
+  entry e = q[best];
+  q.erase(q.begin() + best);
+
+  kernel_stats &ks = m_kernel_stats[e.kernel_uid];
+  ks.served++;
+  ks.bytes += e.req->nbytes;
+  ks.wait += sim_cycle() - e.arrival;
+
+  bool rowhit = row_hit(e, curr_row);
+  if (!rowhit) data_collection(bank);
+  record_access(bank, e.req, rowhit);
+  served(e);
+
+  if (m_config->seperate_write_queue_enabled && e.req->data->is_write()) {
+    assert(m_num_write_pending != 0);
+    m_num_write_pending--;
+  } else {
+    assert(m_num_pending != 0);
+    m_num_pending--;
+  }
+  return e.req;
+}
+
+void dram_app_scheduler::print(FILE *fp) {
+  for (unsigned b = 0; b < m_config->nbk; b++) {
+    printf(" %u: queue length = %u\n", b, (unsigned)m_bank_queue[b].size());
+  }
+}
+
+void dram_app_scheduler::print_stat(FILE *fp) const {
+  double fastest = 0;
+  std::map<unsigned, kernel_stats>::const_iterator k;
+  for (k = m_kernel_stats.begin(); k != m_kernel_stats.end(); ++k) {
+    double wait = (double)k->second.wait / k->second.served;
+    if (k == m_kernel_stats.begin() || wait < fastest) fastest = wait;
+  }
+  for (k = m_kernel_stats.begin(); k != m_kernel_stats.end(); ++k) {
+    double wait = (double)k->second.wait / k->second.served;
+    fprintf(fp,
+            "DRAM[%d] kernel %u: served=%llu bytes=%llu avg_wait=%.2f "
+            "slowdown=%.3f\n",
+            m_dram->id, k->first, k->second.served, k->second.bytes, wait,
+            fastest > 0 ? wait / fastest : 1.0);
+  }
+}
+
+parbs_scheduler::parbs_scheduler(const memory_config *config, dram_t *dm,
+                                 memory_stats_t *stats)
+    : dram_app_scheduler(config, dm, stats), m_rank(m_n_sources, 0) {
+  m_marked_left = 0;
+}
+
+void parbs_scheduler::form_batch() {
+  std::vector<unsigned> max_load(m_n_sources, 0);
+  std::vector<unsigned> total(m_n_sources, 0);
+  std::vector<unsigned> load(m_n_sources);
+  for (unsigned b = 0; b < m_bank_queue.size(); b++) {
+    std::fill(load.begin(), load.end(), 0);
+    std::vector<entry> &q = m_bank_queue[b];
+    for (unsigned i = 0; i < q.size(); i++) {
+      unsigned src = q[i].source;
+      if (load[src] == m_config->dram_parbs_marking_cap) continue;
+      q[i].marked = true;
+      load[src]++;
+      m_marked_left++;
+    }
+    for (unsigned src = 0; src < m_n_sources; src++) {
+      max_load[src] = std::max(max_load[src], load[src]);
+      total[src] += load[src];
+    }
+  }
+
+  std::vector<std::pair<std::pair<unsigned, unsigned>, unsigned> > order;
+  for (unsigned src = 0; src < m_n_sources; src++)
+    order.push_back(std::make_pair(std::make_pair(max_load[src], total[src]),
+                                   src));
+  std::sort(order.begin(), order.end());
+  for (unsigned r = 0; r < order.size(); r++) m_rank[order[r].second] = r;
+}
+
+void parbs_scheduler::update(unsigned long long cycle) {
+  if (m_marked_left == 0) form_batch();
+}
+
+bool parbs_scheduler::better(const entry &a, const entry &b,
+                             unsigned curr_row) const {
+  if (a.marked != b.marked) return a.marked;
+  if (row_hit(a, curr_row) != row_hit(b, curr_row)) return row_hit(a, curr_row);
+  if (m_rank[a.source] != m_rank[b.source])
+    return m_rank[a.source] < m_rank[b.source];
+  return cpl_better(a, b);
+}
+
+void parbs_scheduler::served(const entry &e) {
+  if (e.marked) m_marked_left--;
+}
+
+atlas_scheduler::atlas_scheduler(const memory_config *config, dram_t *dm,
+                                 memory_stats_t *stats)
+    : dram_app_scheduler(config, dm, stats),
+      m_total_service(m_n_sources, 0),
+      m_quantum_service(m_n_sources, 0),
+      m_rank(m_n_sources, 0) {
+  m_next_quantum = m_config->dram_atlas_quantum;
+  m_now = 0;
+}
+
+void atlas_scheduler::update(unsigned long long cycle) {
+  m_now = cycle;
+  if (cycle < m_next_quantum) return;
+  m_next_quantum = cycle + m_config->dram_atlas_quantum;
+
+  double alpha = m_config->dram_atlas_alpha;
+  std::vector<std::pair<double, unsigned> > order;
+  for (unsigned src = 0; src < m_n_sources; src++) {
+    m_total_service[src] =
+        alpha * m_total_service[src] + (1 - alpha) * m_quantum_service[src];
+    m_quantum_service[src] = 0;
+    order.push_back(std::make_pair(m_total_service[src], src));
   }
+  std::sort(order.begin(), order.end());
+  for (unsigned r = 0; r < order.size(); r++) m_rank[order[r].second] = r;
+}
+
+bool atlas_scheduler::better(const entry &a, const entry &b,
+                             unsigned curr_row) const {
+  bool a_late = m_now - a.arrival > m_config->dram_atlas_threshold;
+  bool b_late = m_now - b.arrival > m_config->dram_atlas_threshold;
+  if (a_late != b_late) return a_late;
+  if (m_rank[a.source] != m_rank[b.source])
+    return m_rank[a.source] < m_rank[b.source];
+  if (row_hit(a, curr_row) != row_hit(b, curr_row)) return row_hit(a, curr_row);
+  return cpl_better(a, b);
+}
+
+void atlas_scheduler::served(const entry &e) {
+  m_quantum_service[e.source] += e.req->nbytes;
 }
 
-void dram_t::scheduler_frfcfs() {
+bliss_scheduler::bliss_scheduler(const memory_config *config, dram_t *dm,
+                                 memory_stats_t *stats)
+    : dram_app_scheduler(config, dm, stats), m_blacklisted(m_n_sources, false) {
+  m_next_clear = m_config->dram_bliss_clear_interval;
+  m_last_source = m_n_sources;
+  m_streak = 0;
+}
+
+void bliss_scheduler::update(unsigned long long cycle) {
+  if (cycle < m_next_clear) return;
+  m_next_clear = cycle + m_config->dram_bliss_clear_interval;
+  std::fill(m_blacklisted.begin(), m_blacklisted.end(), false);
+}
+
+bool bliss_scheduler::better(const entry &a, const entry &b,
+                             unsigned curr_row) const {
+  if (m_blacklisted[a.source] != m_blacklisted[b.source])
+    return !m_blacklisted[a.source];
+  if (row_hit(a, curr_row) != row_hit(b, curr_row)) return row_hit(a, curr_row);
+  return cpl_better(a, b);
+}
+
+void bliss_scheduler::served(const entry &e) {
+  if (e.source == m_last_source) {
+    m_streak++;
+  } else {
+    m_last_source = e.source;
+    m_streak = 1;
+  }
+  if (m_streak > m_config->dram_bliss_threshold)
+    m_blacklisted[e.source] = true;
+}
+
+void dram_t::scheduler_queue() {
   unsigned mrq_latency;
-  frfcfs_scheduler *sched = m_frfcfs_scheduler;
+  dram_scheduler *sched = m_scheduler;
   while (!mrqq->empty()) {
     dram_req_t *req = mrqq->pop();
 
     // Power stats
     // if(req->data->get_type() != READ_REPLY && req->data->get_type() !=
     // WRITE_ACK)
+    m_stats->lock_shared();
     m_stats->total_n_access++;
 
     if (req->data->get_type() == WRITE_REQUEST) {
@@ -220,6 +609,7 @@ void dram_t::scheduler_frfcfs() {
     } else if (req->data->get_type() == READ_REQUEST) {
       m_stats->total_n_reads++;
     }
+    m_stats->unlock_shared();
 
     req->data->set_status(IN_PARTITION_MC_INPUT_QUEUE,
                           m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
@@ -241,14 +631,18 @@ void dram_t::scheduler_frfcfs() {
         if (m_config->gpgpu_memlatency_stat) {
           mrq_latency = m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle -
                         bk[b]->mrq->timestamp;
-          m_stats->tot_mrq_latency += mrq_latency;
-          m_stats->tot_mrq_num++;
           bk[b]->mrq->timestamp =
               m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle;
+          m_stats->lock_shared();
+          m_stats->tot_mrq_latency += mrq_latency;
+          m_stats->tot_mrq_num++;
           m_stats->mrq_lat_table[LOGB2(mrq_latency)]++;
           if (mrq_latency > m_stats->max_mrq_latency) {
             m_stats->max_mrq_latency = mrq_latency;
           }
+          m_stats->unlock_shared();
+          m_stats->memlatstat_crit_hop(req->data->is_critical(), CRIT_HOP_MRQ,
+                                       mrq_latency);
         }
 
         break;
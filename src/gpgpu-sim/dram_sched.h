@@ -29,8 +29,8 @@
 #ifndef dram_sched_h_INCLUDED
 #define dram_sched_h_INCLUDED
 
-#include <list>
 #include <map>
+#include <vector>
 #include "dram.h"
 #include "gpu-misc.h"
 #include "gpu-sim.h"
@@ -38,36 +38,279 @@
 
 enum memory_mode { READ_MODE = 0, WRITE_MODE };
 
-class frfcfs_scheduler {
+// Request queue and arbiter of one DRAM channel, used when
+// -gpgpu_dram_scheduler is 1.  dram_t hands every incoming request to
+// add_req() and asks schedule() for the next request of each idle bank.
+// Policies register a factory under a name with REGISTER_DRAM_SCHEDULER and
+// are selected with -gpgpu_dram_sched_policy.
+class dram_scheduler {
  public:
-  frfcfs_scheduler(const memory_config *config, dram_t *dm,
-                   memory_stats_t *stats);
-  void add_req(dram_req_t *req);
-  void data_collection(unsigned bank);
-  dram_req_t *schedule(unsigned bank, unsigned curr_row);
-  void print(FILE *fp);
+  dram_scheduler(const memory_config *config, dram_t *dm,
+                 memory_stats_t *stats);
+  virtual ~dram_scheduler() {}
+
+  virtual void add_req(dram_req_t *req) = 0;
+  // next request for an idle bank whose row buffer holds curr_row
+  virtual dram_req_t *schedule(unsigned bank, unsigned curr_row) = 0;
+  virtual void print(FILE *fp) = 0;
+  // policy statistics, printed with the channel's statistics
+  virtual void print_stat(FILE *fp) const {}
   unsigned num_pending() const { return m_num_pending; }
   unsigned num_write_pending() const { return m_num_write_pending; }
 
- private:
+ protected:
+  void data_collection(unsigned bank);
+  void record_access(unsigned bank, const dram_req_t *req, bool rowhit);
+  unsigned long long sim_cycle() const;
+  // criticality of the warp that issued req, 0 for requests without a warp
+  float warp_cpl(const dram_req_t *req) const;
+  // with -dram_seperate_write_queue_enable, switches to WRITE_MODE when the
+  // pending writes reach the high watermark and back to READ_MODE below the
+  // low one
+  void update_mode();
+
   const memory_config *m_config;
   dram_t *m_dram;
+  memory_stats_t *m_stats;
   unsigned m_num_pending;
   unsigned m_num_write_pending;
-  std::list<dram_req_t *> *m_queue;
-  std::map<unsigned, std::list<std::list<dram_req_t *>::iterator> > *m_bins;
-  std::list<std::list<dram_req_t *>::iterator> **m_last_row;
+  enum memory_mode m_mode;
   unsigned *curr_row_service_time;  // one set of variables for each bank.
   unsigned *row_service_timestamp;  // tracks when scheduler began servicing
                                     // current row
+};
 
-  std::list<dram_req_t *> *m_write_queue;
-  std::map<unsigned, std::list<std::list<dram_req_t *>::iterator> >
-      *m_write_bins;
-  std::list<std::list<dram_req_t *>::iterator> **m_last_write_row;
+typedef dram_scheduler *(*dram_scheduler_factory)(const memory_config *,
+                                                  dram_t *,
+                                                  memory_stats_t *);
 
-  enum memory_mode m_mode;
-  memory_stats_t *m_stats;
+void register_dram_scheduler(const char *name, dram_scheduler_factory factory);
+dram_scheduler *create_dram_scheduler(const char *name,
+                                      const memory_config *config,
+                                      dram_t *dm, memory_stats_t *stats);
+
+template <class T>
+class dram_scheduler_registrar {
+ public:
+  dram_scheduler_registrar(const char *name) {
+    register_dram_scheduler(name, create);
+  }
+
+ private:
+  static dram_scheduler *create(const memory_config *config, dram_t *dm,
+                                memory_stats_t *stats) {
+    return new T(config, dm, stats);
+  }
+};
+
+#define REGISTER_DRAM_SCHEDULER(cls, name) \
+  static dram_scheduler_registrar<cls> cls##_registrar(name)
+
+// Pending requests of every bank of one DRAM channel, kept in arrival order
+// and binned by row.  Requests sit in pool-allocated nodes that are linked by
+// index both into their bank's age list and into their row bin, and each bank
+// finds its bins through a small open-addressed table keyed by row, so adding
+// and scheduling a request never allocates once the pool has warmed up.
+class frfcfs_queue {
+ public:
+  frfcfs_queue(unsigned nbk);
+
+  void push(dram_req_t *req);
+  bool empty(unsigned bank) const { return m_banks[bank].size == 0; }
+  unsigned size(unsigned bank) const { return m_banks[bank].size; }
+  bool has_row(unsigned bank, unsigned row) const {
+    return find_bin(m_banks[bank], row) >= 0;
+  }
+  dram_req_t *oldest(unsigned bank) const {
+    return m_nodes[m_banks[bank].oldest].req;
+  }
+  // oldest request of a CPL-critical warp, NULL if there is none
+  dram_req_t *oldest_critical(unsigned bank) const;
+  // removes the oldest request to row; row_done is set when it was the last
+  dram_req_t *pop(unsigned bank, unsigned row, bool &row_done);
+
+ private:
+  struct node {
+    dram_req_t *req;
+    int older, newer;          // bank age list
+    int row_older, row_newer;  // row bin
+  };
+  struct row_bin {
+    unsigned row;
+    int newest, oldest;  // newest < 0 marks a free slot
+  };
+  struct bank_queue {
+    int newest, oldest;
+    unsigned size;
+    unsigned n_bins;
+    std::vector<row_bin> bins;  // power-of-two sized
+  };
+
+  int alloc_node();
+  int find_bin(const bank_queue &bq, unsigned row) const;
+  int insert_bin(bank_queue &bq, unsigned row);
+  void erase_bin(bank_queue &bq, int slot);
+  void grow_bins(bank_queue &bq);
+  static unsigned hash_row(unsigned row, unsigned mask) {
+    return (row * 2654435761u) & mask;
+  }
+
+  std::vector<node> m_nodes;
+  int m_free;
+  std::vector<bank_queue> m_banks;
+};
+
+// First-ready, first-come-first-serve ("frfcfs"): row hits first, then the
+// oldest request.  With -dram_seperate_write_queue_enable, writes wait in
+// their own queue that is drained between the write watermarks.
+class frfcfs_scheduler : public dram_scheduler {
+ public:
+  frfcfs_scheduler(const memory_config *config, dram_t *dm,
+                   memory_stats_t *stats);
+  virtual void add_req(dram_req_t *req);
+  virtual dram_req_t *schedule(unsigned bank, unsigned curr_row);
+  virtual void print(FILE *fp);
+
+ private:
+  frfcfs_queue m_queue;
+  std::vector<bool> m_row_open;  // bank is draining the bin of m_last_row
+  std::vector<unsigned> m_last_row;
+
+  frfcfs_queue m_write_queue;
+  std::vector<bool> m_write_row_open;
+  std::vector<unsigned> m_last_write_row;
+};
+
+// Common part of the application-aware policies.  Every request is tagged
+// with its source, the kernel that issued it: kernel uids are folded onto
+// -gpgpu_max_concurrent_kernel sources, so kernels that run together rank
+// separately while requests without a kernel (write-backs from L2) share
+// source 0 with every kernel whose uid is a multiple of it.  Each bank keeps
+// its requests in arrival order, and schedule() picks the best pending
+// request of the bank according to better(); the subclasses only keep their
+// ranking state up to date.  With -dram_seperate_write_queue_enable only
+// reads or only writes are eligible, switched between the write watermarks
+// as for frfcfs.
+//
+// print_stat() reports, for every kernel, the requests and bytes served, the
+// mean cycles they waited in the scheduler and the slowdown: that mean over
+// the lowest mean of any kernel served by the channel.
+//
+// With -dram_sched_cpl_priority, requests from warps with a higher CPL
+// (critical path length, see cpl.cc) win ties just before request age.
+class dram_app_scheduler : public dram_scheduler {
+ public:
+  dram_app_scheduler(const memory_config *config, dram_t *dm,
+                     memory_stats_t *stats);
+  virtual void add_req(dram_req_t *req);
+  virtual dram_req_t *schedule(unsigned bank, unsigned curr_row);
+  virtual void print(FILE *fp);
+  virtual void print_stat(FILE *fp) const;
+
+ protected:
+  struct entry {
+    dram_req_t *req;
+    unsigned kernel_uid;
+    unsigned source;
+    unsigned long long arrival;
+    bool marked;
+    float cpl;
+  };
+
+  // called once per schedule() before any comparison
+  virtual void update(unsigned long long cycle) {}
+  // true if a must be served before b; a arrived later than b
+  virtual bool better(const entry &a, const entry &b,
+                      unsigned curr_row) const = 0;
+  virtual void served(const entry &e) {}
+
+  // tie break on warp criticality, applied by all policies before age
+  bool cpl_better(const entry &a, const entry &b) const {
+    return m_config->dram_sched_cpl_priority && a.cpl > b.cpl;
+  }
+  static bool row_hit(const entry &e, unsigned curr_row) {
+    return e.req->row == curr_row;
+  }
+
+  unsigned m_n_sources;
+  std::vector<std::vector<entry> > m_bank_queue;
+
+ private:
+  struct kernel_stats {
+    unsigned long long served;
+    unsigned long long bytes;
+    unsigned long long wait;  // cycles between add_req() and schedule()
+  };
+  std::map<unsigned, kernel_stats> m_kernel_stats;
+};
+
+// Parallelism-aware batch scheduling ("parbs", Mutlu and Moscibroda, ISCA
+// 2008).  When the last marked request is served, up to
+// -dram_parbs_marking_cap of the oldest requests of each source in each bank
+// are marked as a new batch.  Sources are ranked shortest job first: fewest
+// marked requests in their most loaded bank, then fewest marked requests.
+// Priority: marked, row hit, source rank, age.
+class parbs_scheduler : public dram_app_scheduler {
+ public:
+  parbs_scheduler(const memory_config *config, dram_t *dm,
+                  memory_stats_t *stats);
+
+ protected:
+  virtual void update(unsigned long long cycle);
+  virtual bool better(const entry &a, const entry &b, unsigned curr_row) const;
+  virtual void served(const entry &e);
+
+ private:
+  void form_batch();
+
+  unsigned m_marked_left;
+  std::vector<unsigned> m_rank;  // 0 is served first
+};
+
+// Adaptive per-thread least-attained-service ("atlas", Kim et al., HPCA
+// 2010).  Attained service (bytes transferred) of every source is aged by
+// -dram_atlas_alpha every -dram_atlas_quantum cycles and sources are ranked
+// least attained service first.  Priority: requests older than
+// -dram_atlas_threshold cycles, source rank, row hit, age.  The ranking is
+// kept per channel; no service is exchanged between memory controllers.
+class atlas_scheduler : public dram_app_scheduler {
+ public:
+  atlas_scheduler(const memory_config *config, dram_t *dm,
+                  memory_stats_t *stats);
+
+ protected:
+  virtual void update(unsigned long long cycle);
+  virtual bool better(const entry &a, const entry &b, unsigned curr_row) const;
+  virtual void served(const entry &e);
+
+ private:
+  unsigned long long m_next_quantum;
+  unsigned long long m_now;
+  std::vector<double> m_total_service;
+  std::vector<double> m_quantum_service;
+  std::vector<unsigned> m_rank;
+};
+
+// Blacklisting memory scheduler ("bliss", Subramanian et al., ICCD 2014).  A
+// source that has more than -dram_bliss_threshold requests served in a row is
+// blacklisted until the blacklist is cleared, every
+// -dram_bliss_clear_interval cycles.  Priority: not blacklisted, row hit,
+// age.
+class bliss_scheduler : public dram_app_scheduler {
+ public:
+  bliss_scheduler(const memory_config *config, dram_t *dm,
+                  memory_stats_t *stats);
+
+ protected:
+  virtual void update(unsigned long long cycle);
+  virtual bool better(const entry &a, const entry &b, unsigned curr_row) const;
+  virtual void served(const entry &e);
+
+ private:
+  unsigned long long m_next_clear;
+  unsigned m_last_source;
+  unsigned m_streak;
+  std::vector<bool> m_blacklisted;
 };
 
 #endif
@@ -168,11 +168,15 @@ tag_array::~tag_array() {
   unsigned cache_lines_num = m_config.get_max_num_lines();
   for (unsigned i = 0; i < cache_lines_num; ++i) delete m_lines[i];
   delete[] m_lines;
+  delete[] m_tags;
 }
 
 tag_array::tag_array(cache_config &config, int core_id, int type_id,
                      cache_block_t **new_lines)
     : m_config(config), m_lines(new_lines) {
+  unsigned cache_lines_num = config.get_max_num_lines();
+  m_tags = new new_addr_type[cache_lines_num];
+  for (unsigned i = 0; i < cache_lines_num; ++i) m_tags[i] = m_lines[i]->m_tag;
   init(core_id, type_id);
 }
 
@@ -193,6 +197,8 @@ tag_array::tag_array(cache_config &config, int core_id, int type_id)
       m_lines[i] = new sector_cache_block();
   } else
     assert(0);
+  m_tags = new new_addr_type[cache_lines_num];
+  for (unsigned i = 0; i < cache_lines_num; ++i) m_tags[i] = m_lines[i]->m_tag;
 
   init(core_id, type_id);
 }
@@ -230,6 +236,58 @@ void tag_array::remove_pending_line(mem_fetch *mf) {
   }
 }
 
+bool tag_array::probe_tag(unsigned set_index, new_addr_type tag,
+                          mem_access_sector_mask_t mask, unsigned &idx,
+                          enum cache_request_status &status) {
+  const unsigned assoc = m_config.m_assoc;
+  const unsigned base = set_index * assoc;
+  const new_addr_type *tags = m_tags + base;
+
+  // compare up to 64 ways at a time into a match mask, then visit the
+  // matching ways in way order as the original per-line loop did
+  for (unsigned first = 0; first < assoc; first += 64) {
+    unsigned n = assoc - first < 64 ? assoc - first : 64;
+    unsigned long long match = 0;
+    for (unsigned w = 0; w < n; w++)
+      match |= (unsigned long long)(tags[first + w] == tag) << w;
+
+    while (match) {
+      unsigned index = base + first + __builtin_ctzll(match);
+      match &= match - 1;
+      cache_block_t *line = m_lines[index];
+      assert(line->m_tag == tag);
+      enum cache_block_state state = line->get_status(mask);
+      if (state == RESERVED) {
+        idx = index;
+        status = HIT_RESERVED;
+        return true;
+      } else if (state == VALID) {
+        idx = index;
+        status = HIT;
+        return true;
+      } else if (state == MODIFIED) {
+        idx = index;
+        status = line->is_readable(mask) ? HIT : SECTOR_MISS;
+        return true;
+      } else if (line->is_valid_line() && state == INVALID) {
+        idx = index;
+        status = SECTOR_MISS;
+        return true;
+      } else {
+        assert(state == INVALID);
+      }
+    }
+  }
+  return false;
+}
+
+void tag_array::allocate_line(unsigned idx, new_addr_type addr, unsigned time,
+                              mem_access_sector_mask_t mask) {
+  m_lines[idx]->allocate(m_config.tag(addr), m_config.block_addr(addr), time,
+                         mask);
+  m_tags[idx] = m_lines[idx]->m_tag;
+}
+
 enum cache_request_status tag_array::probe(new_addr_type addr, unsigned &idx,
                                            mem_fetch *mf,
                                            bool probe_mode) {
@@ -245,39 +303,20 @@ enum cache_request_status tag_array::probe(new_addr_type addr, unsigned &idx,
   unsigned set_index = m_config.set_index(addr);
   new_addr_type tag = m_config.tag(addr);
 
+  // check for hit or pending hit
+  enum cache_request_status status;
+  if (probe_tag(set_index, tag, mask, idx, status)) return status;
+
   unsigned invalid_line = (unsigned)-1;
   unsigned valid_line = (unsigned)-1;
   unsigned long long valid_timestamp = (unsigned)-1;
 
   bool all_reserved = true;
 
-  // check for hit or pending hit
+  // miss: look for a victim
   for (unsigned way = 0; way < m_config.m_assoc; way++) {
     unsigned index = set_index * m_config.m_assoc + way;
     cache_block_t *line = m_lines[index];
-    if (line->m_tag == tag) {
-      if (line->get_status(mask) == RESERVED) {
-        idx = index;
-        return HIT_RESERVED;
-      } else if (line->get_status(mask) == VALID) {
-        idx = index;
-        return HIT;
-      } else if (line->get_status(mask) == MODIFIED) {
-        if (line->is_readable(mask)) {
-          idx = index;
-          return HIT;
-        } else {
-          idx = index;
-          return SECTOR_MISS;
-        }
-
-      } else if (line->is_valid_line() && line->get_status(mask) == INVALID) {
-        idx = index;
-        return SECTOR_MISS;
-      } else {
-        assert(line->get_status(mask) == INVALID);
-      }
-    }
     if (!line->is_reserved_line()) {
       all_reserved = false;
       if (line->is_invalid_line()) {
@@ -356,8 +395,7 @@ enum cache_request_status tag_array::access(new_addr_type addr, unsigned time,
           evicted.set_info(m_lines[idx]->m_block_addr,
                            m_lines[idx]->get_modified_size());
         }
-        m_lines[idx]->allocate(m_config.tag(addr), m_config.block_addr(addr),
-                               time, mf->get_access_sector_mask());
+        allocate_line(idx, addr, time, mf->get_access_sector_mask());
       }
       break;
     case SECTOR_MISS:
@@ -395,8 +433,7 @@ void tag_array::fill(new_addr_type addr, unsigned time,
   // assert(status==MISS||status==SECTOR_MISS); // MSHR should have prevented
   // redundant memory request
   if (status == MISS)
-    m_lines[idx]->allocate(m_config.tag(addr), m_config.block_addr(addr), time,
-                           mask);
+    allocate_line(idx, addr, time, mask);
   else if (status == SECTOR_MISS) {
     assert(m_config.m_cache_type == SECTOR);
     ((sector_cache_block *)m_lines[idx])->allocate_sector(time, mask);
@@ -524,6 +561,12 @@ bool mshr_table::full(new_addr_type block_addr) const {
     return m_data.size() >= m_num_entries;
 }
 
+bool mshr_table::full(new_addr_type block_addr, const mem_fetch *mf) const {
+  if (m_critical_reserve == 0 || mf->is_critical() || probe(block_addr))
+    return full(block_addr);
+  return m_data.size() + m_critical_reserve >= m_num_entries;
+}
+
 /// Add or merge this access
 void mshr_table::add(new_addr_type block_addr, mem_fetch *mf) {
   m_data[block_addr].m_list.push_back(mf);
@@ -1115,7 +1158,7 @@ void baseline_cache::send_read_request(new_addr_type addr,
                                        bool read_only, bool wa) {
   new_addr_type mshr_addr = m_config.mshr_addr(mf->get_addr());
   bool mshr_hit = m_mshrs.probe(mshr_addr);
-  bool mshr_avail = !m_mshrs.full(mshr_addr);
+  bool mshr_avail = !m_mshrs.full(mshr_addr, mf);
   if (mshr_hit && mshr_avail) {
     if (read_only)
       m_tag_array->access(block_addr, time, cache_index, mf);
@@ -1250,7 +1293,7 @@ enum cache_request_status data_cache::wr_miss_wa_naive(
   // request) Conservatively ensure the worst-case request can be handled this
   // cycle
   bool mshr_hit = m_mshrs.probe(mshr_addr);
-  bool mshr_avail = !m_mshrs.full(mshr_addr);
+  bool mshr_avail = !m_mshrs.full(mshr_addr, mf);
   if (miss_queue_full(2) ||
       (!(mshr_hit && mshr_avail) &&
        !(!mshr_hit && mshr_avail &&
@@ -1280,10 +1323,11 @@ enum cache_request_status data_cache::wr_miss_wa_naive(
                        mf->get_access_warp_mask(), mf->get_access_byte_mask(),
                        mf->get_access_sector_mask(), m_gpu->gpgpu_ctx);
 
-  mem_fetch *n_mf =
-      new mem_fetch(*ma, NULL, mf->get_ctrl_size(), mf->get_wid(),
-                    mf->get_sid(), mf->get_tpc(), mf->get_mem_config(),
-                    m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle);
+  mem_fetch *n_mf = new (m_memfetch_creator->get_pool())
+      mem_fetch(*ma, NULL, mf->get_ctrl_size(), mf->get_wid(), mf->get_sid(),
+                mf->get_tpc(), mf->get_mem_config(),
+                m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle);
+  n_mf->set_critical(mf->is_critical());
 
   bool do_miss = false;
   bool wb = false;
@@ -1363,7 +1407,7 @@ enum cache_request_status data_cache::wr_miss_wa_fetch_on_write(
     return RESERVATION_FAIL;
   } else {
     bool mshr_hit = m_mshrs.probe(mshr_addr);
-    bool mshr_avail = !m_mshrs.full(mshr_addr);
+    bool mshr_avail = !m_mshrs.full(mshr_addr, mf);
     if (miss_queue_full(1) ||
         (!(mshr_hit && mshr_avail) &&
          !(!mshr_hit && mshr_avail &&
@@ -1397,7 +1441,7 @@ enum cache_request_status data_cache::wr_miss_wa_fetch_on_write(
         mf->get_access_warp_mask(), mf->get_access_byte_mask(),
         mf->get_access_sector_mask(), m_gpu->gpgpu_ctx);
 
-    mem_fetch *n_mf = new mem_fetch(
+    mem_fetch *n_mf = new (m_memfetch_creator->get_pool()) mem_fetch(
         *ma, NULL, mf->get_ctrl_size(), mf->get_wid(), mf->get_sid(),
         mf->get_tpc(), mf->get_mem_config(),
         m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle, NULL, mf);
@@ -470,6 +470,7 @@ class cache_config {
     m_data_port_width = 0;
     m_set_index_function = LINEAR_SET_FUNCTION;
     m_is_streaming = false;
+    m_critical_mshr_reserve = 0;
   }
   void init(char *config, FuncCache status) {
     cache_status = status;
@@ -733,6 +734,7 @@ class cache_config {
   char *m_config_stringPrefL1;
   char *m_config_stringPrefShared;
   FuncCache cache_status;
+  unsigned m_critical_mshr_reserve;  // MSHRs only critical misses allocate
 
  protected:
   void exit_parse_error() {
@@ -867,10 +869,22 @@ class tag_array {
             cache_block_t **new_lines);
   void init(int core_id, int type_id);
 
+  // Looks the tag up in its set.  Returns true, with idx and status set, if
+  // the access resolves to a line already holding the tag (hit, pending hit
+  // or sector miss); false means the caller must pick a victim.
+  bool probe_tag(unsigned set_index, new_addr_type tag,
+                 mem_access_sector_mask_t mask, unsigned &idx,
+                 enum cache_request_status &status);
+  void allocate_line(unsigned idx, new_addr_type addr, unsigned time,
+                     mem_access_sector_mask_t mask);
+
  protected:
   cache_config &m_config;
 
   cache_block_t **m_lines; /* nbanks x nset x assoc lines in total */
+  // m_lines[i]->m_tag kept in one contiguous array so that the ways of a set
+  // are compared in a single vectorizable pass; updated by allocate_line()
+  new_addr_type *m_tags;
 
   unsigned m_access;
   unsigned m_miss;
@@ -925,9 +939,14 @@ class cacp_tag_array : public tag_array {
 
 class mshr_table {
  public:
-  mshr_table(unsigned num_entries, unsigned max_merged)
+  mshr_table(unsigned num_entries, unsigned max_merged,
+             unsigned critical_reserve = 0)
       : m_num_entries(num_entries),
-        m_max_merged(max_merged)
+        m_max_merged(max_merged),
+        // keep at least one entry for non-critical misses
+        m_critical_reserve(critical_reserve >= num_entries && num_entries
+                               ? num_entries - 1
+                               : critical_reserve)
 #if (tr1_hash_map_ismap == 0)
         ,
         m_data(2 * num_entries)
@@ -939,6 +958,9 @@ class mshr_table {
   bool probe(new_addr_type block_addr) const;
   /// Checks if there is space for tracking a new memory access
   bool full(new_addr_type block_addr) const;
+  /// Same, but new entries for non-critical fetches must leave the critical
+  /// reserve free
+  bool full(new_addr_type block_addr, const mem_fetch *mf) const;
   /// Add or merge this access
   void add(new_addr_type block_addr, mem_fetch *mf);
   /// Returns true if cannot accept new fill responses
@@ -965,6 +987,7 @@ class mshr_table {
   // merged requests
   const unsigned m_num_entries;
   const unsigned m_max_merged;
+  const unsigned m_critical_reserve;
 
   struct mshr_entry {
     std::list<mem_fetch *> m_list;
@@ -1176,7 +1199,8 @@ class baseline_cache : public cache_t {
                  enum mem_fetch_status status)
       : m_config(config),
         m_tag_array(new tag_array(config, core_id, type_id)),
-        m_mshrs(config.m_mshr_entries, config.m_mshr_max_merge),
+        m_mshrs(config.m_mshr_entries, config.m_mshr_max_merge,
+                config.m_critical_mshr_reserve),
         m_bandwidth_management(config) {
     init(name, config, memport, status);
   }
@@ -1262,7 +1286,8 @@ class baseline_cache : public cache_t {
                  enum mem_fetch_status status, tag_array *new_tag_array)
       : m_config(config),
         m_tag_array(new_tag_array),
-        m_mshrs(config.m_mshr_entries, config.m_mshr_max_merge),
+        m_mshrs(config.m_mshr_entries, config.m_mshr_max_merge,
+                config.m_critical_mshr_reserve),
         m_bandwidth_management(config) {
     init(name, config, memport, status);
   }
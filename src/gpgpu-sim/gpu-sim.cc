@@ -50,6 +50,7 @@
 #include "l2cache.h"
 #include "shader.h"
 #include "stat-tool.h"
+#include "thread_pool.h"
 
 #include "../../libcuda/gpgpu_context.h"
 #include "../abstract_hardware_model.h"
@@ -135,9 +136,56 @@ void memory_config::reg_options(class OptionParser *opp) {
   option_parser_register(opp, "-gpgpu_simple_dram_model", OPT_BOOL,
                          &simple_dram_model,
                          "simple_dram_model with fixed latency and BW", "0");
+  option_parser_register(
+      opp, "-gpgpu_mem_fetch_pool_debug", OPT_BOOL, &m_mf_pool_debug,
+      "Check mem_fetch pools for double deletes and report fetches still "
+      "alive at the end of a kernel",
+      "0");
   option_parser_register(opp, "-gpgpu_dram_scheduler", OPT_INT32,
-                         &scheduler_type, "0 = fifo, 1 = FR-FCFS (defaul)",
+                         &scheduler_type,
+                         "0 = fifo, 1 = queued scheduler selected by "
+                         "-gpgpu_dram_sched_policy (default)",
                          "1");
+  option_parser_register(opp, "-gpgpu_dram_sched_policy", OPT_CSTR,
+                         &dram_sched_policy,
+                         "DRAM scheduling policy: frfcfs, parbs, atlas or "
+                         "bliss (default = frfcfs)",
+                         "frfcfs");
+  option_parser_register(opp, "-dram_sched_cpl_priority", OPT_BOOL,
+                         &dram_sched_cpl_priority,
+                         "parbs/atlas/bliss: prefer requests of warps with a "
+                         "higher CPL before falling back to request age",
+                         "0");
+  option_parser_register(opp, "-dram_parbs_marking_cap", OPT_UINT32,
+                         &dram_parbs_marking_cap,
+                         "parbs: requests marked per source and bank in a "
+                         "batch (default = 5)",
+                         "5");
+  option_parser_register(opp, "-dram_atlas_quantum", OPT_UINT32,
+                         &dram_atlas_quantum,
+                         "atlas: cycles between source rankings "
+                         "(default = 100000)",
+                         "100000");
+  option_parser_register(opp, "-dram_atlas_alpha", OPT_DOUBLE,
+                         &dram_atlas_alpha,
+                         "atlas: weight of past quanta in the attained "
+                         "service (default = 0.875)",
+                         "0.875");
+  option_parser_register(opp, "-dram_atlas_threshold", OPT_UINT32,
+                         &dram_atlas_threshold,
+                         "atlas: cycles after which a request bypasses the "
+                         "ranking (default = 100000)",
+                         "100000");
+  option_parser_register(opp, "-dram_bliss_threshold", OPT_UINT32,
+                         &dram_bliss_threshold,
+                         "bliss: consecutive requests served before a source "
+                         "is blacklisted (default = 4)",
+                         "4");
+  option_parser_register(opp, "-dram_bliss_clear_interval", OPT_UINT32,
+                         &dram_bliss_clear_interval,
+                         "bliss: cycles between blacklist clears "
+                         "(default = 10000)",
+                         "10000");
   option_parser_register(opp, "-gpgpu_dram_partition_queues", OPT_CSTR,
                          &gpgpu_L2_queue_config, "i2$:$2d:d2$:$2i", "8:8:8:8");
 
@@ -152,6 +200,16 @@ void memory_config::reg_options(class OptionParser *opp) {
   option_parser_register(opp, "-gpgpu_cache:dl2_texture_only", OPT_BOOL,
                          &m_L2_texure_only, "L2 cache used for texture only",
                          "1");
+  option_parser_register(opp, "-gpgpu_l2_cpl_mshr_reserve", OPT_UINT32,
+                         &m_L2_config.m_critical_mshr_reserve,
+                         "L2 MSHR entries that only misses of CPL-critical "
+                         "warps may allocate (default = 0)",
+                         "0");
+  option_parser_register(opp, "-gpgpu_mem_cpl_priority", OPT_BOOL,
+                         &gpgpu_mem_cpl_priority,
+                         "serve requests of CPL-critical warps first in the "
+                         "icnt-to-L2 queue and when FR-FCFS opens a new row",
+                         "0");
   option_parser_register(
       opp, "-gpgpu_n_mem", OPT_UINT32, &m_n_mem,
       "number of memory modules (e.g. memory controllers) in gpu", "8");
@@ -535,6 +593,11 @@ void shader_core_config::reg_options(class OptionParser *opp) {
   option_parser_register(opp, "-gpgpu_reg_file_port_throughput", OPT_INT32,
                          &reg_file_port_throughput,
                          "the number ports of the register file", "1");
+  option_parser_register(
+      opp, "-gpgpu_stall_fast_forward", OPT_BOOL, &gpgpu_stall_fast_forward,
+      "skip the scheduler and fetch stages of cores whose warps are all "
+      "stalled on memory (results are unchanged)",
+      "0");
 
   for (unsigned j = 0; j < SPECIALIZED_UNIT_NUM; ++j) {
     std::stringstream ss;
@@ -605,6 +668,43 @@ void gpgpu_sim_config::reg_options(option_parser_t opp) {
   option_parser_register(
       opp, "-gpgpu_max_concurrent_kernel", OPT_INT32, &max_concurrent_kernel,
       "maximum kernels that can run concurrently on GPU", "8");
+  option_parser_register(
+      opp, "-gpgpu_sim_threads", OPT_UINT32, &gpgpu_sim_threads,
+      "number of host threads used to tick memory partitions and L2 "
+      "sub-partitions (and SIMT core clusters, see "
+      "-gpgpu_sim_parallel_clusters) in parallel (1 = serial)",
+      "1");
+  option_parser_register(
+      opp, "-gpgpu_sim_parallel_clusters", OPT_BOOL,
+      &gpgpu_sim_parallel_clusters,
+      "also tick the SIMT core clusters on the -gpgpu_sim_threads threads. "
+      "Clusters ticked together see each other's global stores of the same "
+      "cycle in an order that depends on the host thread schedule, so kernels "
+      "whose CTAs communicate through global memory may give different "
+      "timing from run to run (1 = on)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_async_memcpy", OPT_BOOL, &gpgpu_async_memcpy,
+      "perform functional memcpys issued while kernels run on a copy engine "
+      "thread, overlapped with the simulation",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_sampling", OPT_BOOL, &gpgpu_sampling,
+      "sampled simulation: time one window of CTAs per sampling unit and "
+      "execute the remaining CTAs functionally",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_sampling_window", OPT_UINT32, &gpgpu_sampling_window,
+      "CTAs per detailed sampling window (0 = one wave of CTAs across all "
+      "cores)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_sampling_period", OPT_UINT32, &gpgpu_sampling_period,
+      "length of a sampling unit in windows; one window per unit is timed",
+      "10");
+  option_parser_register(
+      opp, "-gpgpu_sampling_warmup", OPT_BOOL, &gpgpu_sampling_warmup,
+      "warm the L2 tags with the global accesses of functional CTAs", "1");
   option_parser_register(
       opp, "-gpgpu_cflog_interval", OPT_INT32, &gpgpu_cflog_interval,
       "Interval between each snapshot in control flow logger", "0");
@@ -702,6 +802,30 @@ void gpgpu_sim::launch(kernel_info_t *kinfo) {
   m_shader_stats->cpl_launch_kernel(
       kinfo->get_uid(), kinfo->num_blocks(),
       kinfo->threads_per_cta() / m_shader_config->warp_size);
+
+  m_parallel_clusters = parallel_clusters_allowed();
+}
+
+// The clusters are ticked on m_thread_pool only when asked for, since
+// concurrent clusters see each other's global stores of the same cycle in a
+// different order, and even then not where it would break the simulator:
+// trace and debug output would interleave, the instruction classification
+// stats and the perfect memory model (which executes global atomics in the
+// core) are shared, and some kernels write into their shared instructions
+// while they run.
+bool gpgpu_sim::parallel_clusters_allowed() const {
+  if (!m_config.gpgpu_sim_parallel_clusters ||
+      m_thread_pool->num_threads() == 1 || Trace::enabled ||
+      gpgpu_ctx->func_sim->gpgpu_ptx_instruction_classification ||
+      g_debug_execution || get_config().get_ptx_inst_debug_to_file() ||
+      g_interactive_debugger_enabled || m_shader_config->gpgpu_perfect_mem)
+    return false;
+  for (unsigned n = 0; n < m_running_kernels.size(); n++) {
+    kernel_info_t *k = m_running_kernels[n];
+    if (k != NULL && !k->done() && k->entry()->needs_serial_clusters())
+      return false;
+  }
+  return true;
 }
 
 bool gpgpu_sim::can_start_kernel() {
@@ -878,6 +1002,31 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
     }
   }
 
+  // Parallel ticking is only offered where it cannot change the results:
+  // trace output would interleave, and RANDOM partition indexing draws from
+  // the global rand() stream whenever a new line is written back.
+  unsigned n_sim_threads = m_config.gpgpu_sim_threads;
+  if (n_sim_threads > 1 &&
+      (DTRACE(MEMORY_PARTITION_UNIT) || DTRACE(MEMORY_SUBPARTITION_UNIT) ||
+       m_memory_config->m_address_mapping.get_partition_indexing() ==
+           RANDOM)) {
+    printf(
+        "GPGPU-Sim uArch: memory partition tracing or random partition "
+        "indexing is enabled, ignoring -gpgpu_sim_threads %u\n",
+        n_sim_threads);
+    n_sim_threads = 1;
+  }
+  m_thread_pool = new sim_thread_pool(n_sim_threads);
+  m_memory_stats->set_concurrent(m_thread_pool->num_threads() > 1);
+  m_dram_cycle_task =
+      new member_task<gpgpu_sim, &gpgpu_sim::dram_cycle_partition>(this);
+  m_l2_cycle_task =
+      new member_task<gpgpu_sim, &gpgpu_sim::l2_cycle_sub_partition>(this);
+  m_core_cycle_task =
+      new member_task<gpgpu_sim, &gpgpu_sim::core_cycle_cluster>(this);
+  m_parallel_clusters = false;
+  m_cluster_ticked.assign(m_shader_config->n_simt_clusters, 0);
+
   icnt_wrapper_init();
   icnt_create(m_shader_config->n_simt_clusters,
               m_memory_config->m_n_mem_sub_partition);
@@ -898,6 +1047,26 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   // Jin: functional simulation for CDP
   m_functional_sim = false;
   m_functional_sim_kernel = NULL;
+
+  m_sampling_window_open = false;
+  m_sampling_fast_forwarding = false;
+  m_sampling_window_cycle = 0;
+  m_sampling_window_insn = 0;
+  m_sampling_functional_cta = 0;
+  m_sampling_functional_insn = 0;
+}
+
+// The clusters and partitions themselves are not torn down, but the fetches
+// they still hold live in the mem_fetch pools, so the slabs go with the GPU.
+gpgpu_sim::~gpgpu_sim() {
+  delete m_core_cycle_task;
+  delete m_l2_cycle_task;
+  delete m_dram_cycle_task;
+  delete m_thread_pool;
+  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+    delete m_cluster[i]->get_mf_pool();
+  for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++)
+    delete m_memory_sub_partition[i]->get_mf_pool();
 }
 
 int gpgpu_sim::shared_mem_size() const {
@@ -1043,6 +1212,7 @@ void gpgpu_sim::init() {
 }
 
 void gpgpu_sim::update_stats() {
+  if (m_memory_config->m_mf_pool_debug) check_mem_fetch_leaks();
   m_memory_stats->memlatstat_lat_pw();
   gpu_tot_sim_cycle += gpu_sim_cycle;
   gpu_tot_sim_insn += gpu_sim_insn;
@@ -1064,6 +1234,21 @@ void gpgpu_sim::update_stats() {
   gpu_occupancy = occupancy_stats();
 }
 
+// Called once the GPU has gone idle after a kernel: every mem_fetch should
+// have been retired by then unless the run was cut short.
+void gpgpu_sim::check_mem_fetch_leaks() {
+  if (gpu_deadlock || cycle_insn_cta_max_hit()) return;
+  unsigned n_live = 0;
+  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+    n_live += m_cluster[i]->get_mf_pool()->check_leaks(stdout);
+  for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++)
+    n_live += m_memory_sub_partition[i]->get_mf_pool()->check_leaks(stdout);
+  if (n_live)
+    printf("GPGPU-Sim uArch: WARNING: %u mem_fetch(es) still alive at end of "
+           "kernel\n",
+           n_live);
+}
+
 void gpgpu_sim::print_stats() {
   gpgpu_ctx->stats->ptx_file_line_stats_write_file();
   gpu_print_stat();
@@ -1252,6 +1437,10 @@ void gpgpu_sim::gpu_print_stat() {
                                        (gpu_tot_sim_cycle + gpu_sim_cycle));
   printf("gpu_tot_issued_cta = %lld\n",
          gpu_tot_issued_cta + m_total_cta_launched);
+  if (m_config.gpgpu_sampling) {
+    sampling_close_window();
+    print_sampling_stats(statfout);
+  }
   printf("gpu_occupancy = %.4f%% \n", gpu_occupancy.get_occ_fraction() * 100);
   printf("gpu_tot_occupancy = %.4f%% \n",
          (gpu_occupancy + gpu_tot_occupancy).get_occ_fraction() * 100);
@@ -1427,33 +1616,34 @@ unsigned gpgpu_sim::threads_per_core() const {
 void shader_core_ctx::mem_instruction_stats(const warp_inst_t &inst) {
   unsigned active_count = inst.active_count();
   // this breaks some encapsulation: the is_[space] functions, if you change
-  // those, change this.
+  // those, change this.  The counters are shared by the clusters, which may
+  // be ticked concurrently.
   switch (inst.space.get_type()) {
     case undefined_space:
     case reg_space:
       break;
     case shared_space:
-      m_stats->gpgpu_n_shmem_insn += active_count;
+      __sync_fetch_and_add(&m_stats->gpgpu_n_shmem_insn, active_count);
       break;
     case sstarr_space:
-      m_stats->gpgpu_n_sstarr_insn += active_count;
+      __sync_fetch_and_add(&m_stats->gpgpu_n_sstarr_insn, active_count);
       break;
     case const_space:
-      m_stats->gpgpu_n_const_insn += active_count;
+      __sync_fetch_and_add(&m_stats->gpgpu_n_const_insn, active_count);
       break;
     case param_space_kernel:
     case param_space_local:
-      m_stats->gpgpu_n_param_insn += active_count;
+      __sync_fetch_and_add(&m_stats->gpgpu_n_param_insn, active_count);
       break;
     case tex_space:
-      m_stats->gpgpu_n_tex_insn += active_count;
+      __sync_fetch_and_add(&m_stats->gpgpu_n_tex_insn, active_count);
       break;
     case global_space:
     case local_space:
       if (inst.is_store())
-        m_stats->gpgpu_n_store_insn += active_count;
+        __sync_fetch_and_add(&m_stats->gpgpu_n_store_insn, active_count);
       else
-        m_stats->gpgpu_n_load_insn += active_count;
+        __sync_fetch_and_add(&m_stats->gpgpu_n_load_insn, active_count);
       break;
     default:
       abort();
@@ -1584,6 +1774,7 @@ unsigned exec_shader_core_ctx::sim_init_thread(
 }
 
 void shader_core_ctx::issue_block2core(kernel_info_t &kernel) {
+  m_stalled_on_memory = false;
   if (!m_config->gpgpu_concurrent_kernel_sm)
     set_max_cta(kernel);
   else
@@ -1734,7 +1925,149 @@ int gpgpu_sim::next_clock_domain(void) {
   return mask;
 }
 
+// Sampled simulation.  Every kernel is cut into sampling units of
+// gpgpu_sampling_period windows of gpgpu_sampling_window CTAs each.  The
+// first window of a unit goes through the timing model; the CTAs of the
+// remaining windows are executed by functionalCoreSim, optionally warming the
+// L2 tags with their global accesses.  Each detailed window yields one CPI
+// sample and the total is estimated from the mean CPI over all instructions.
+bool gpgpu_sim::sampling_detailed_cta(const kernel_info_t &kernel) const {
+  unsigned window = m_config.gpgpu_sampling_window;
+  if (window == 0) {
+    unsigned warp_size = m_shader_config->warp_size;
+    unsigned padded_cta_size =
+        (kernel.threads_per_cta() + warp_size - 1) / warp_size * warp_size;
+    unsigned cta_per_core =
+        std::max(1u, m_shader_config->n_thread_per_shader / padded_cta_size);
+    window = cta_per_core * m_shader_config->num_shader();
+  }
+  unsigned long long unit = (unsigned long long)window *
+                           std::max(1u, m_config.gpgpu_sampling_period);
+  return kernel.get_next_cta_id_single() % unit < window;
+}
+
+// Returns true while CTA issue has to be held back so that the timing model
+// can drain before a functional fast-forward.
+bool gpgpu_sim::sampling_fast_forward() {
+  bool fast_forward = false;
+  for (unsigned n = 0; n < m_running_kernels.size(); n++) {
+    kernel_info_t *k = m_running_kernels[n];
+    if (kernel_more_cta_left(k) && !sampling_detailed_cta(*k))
+      fast_forward = true;
+  }
+
+  if (fast_forward) {
+    // functional CTAs borrow the thread, shared and local memory contexts of
+    // core 0, so no timed CTA may be resident while they run
+    for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+      if (m_cluster[i]->get_not_completed()) return true;
+    sampling_close_window();
+
+    m_sampling_fast_forwarding = true;
+    for (unsigned n = 0; n < m_running_kernels.size(); n++) {
+      kernel_info_t *k = m_running_kernels[n];
+      if (k == NULL) continue;
+      while (kernel_more_cta_left(k) && !sampling_detailed_cta(*k)) {
+        functionalCoreSim cta(k, this, m_shader_config->warp_size);
+        cta.run(0, k->get_next_cta_id_single());
+        m_sampling_functional_cta++;
+      }
+      if (k->no_more_ctas_to_run() && !k->running()) set_kernel_done(k);
+    }
+    m_sampling_fast_forwarding = false;
+  }
+
+  if (!m_sampling_window_open && get_more_cta_left()) {
+    m_sampling_window_open = true;
+    m_sampling_window_cycle = gpu_tot_sim_cycle + gpu_sim_cycle;
+    m_sampling_window_insn = gpu_tot_sim_insn + gpu_sim_insn;
+  }
+  return false;
+}
+
+void gpgpu_sim::sampling_close_window() {
+  if (!m_sampling_window_open) return;
+  m_sampling_window_open = false;
+  unsigned long long cycles =
+      gpu_tot_sim_cycle + gpu_sim_cycle - m_sampling_window_cycle;
+  unsigned long long insn =
+      gpu_tot_sim_insn + gpu_sim_insn - m_sampling_window_insn;
+  if (cycles && insn) m_sampling_cpi.push_back((double)cycles / insn);
+}
+
+// Called for every warp instruction a functional CTA executes during a
+// fast-forward.
+void gpgpu_sim::sampling_functional_inst(const warp_inst_t &inst) {
+  if (!m_sampling_fast_forwarding) return;
+  m_sampling_functional_insn += inst.active_count();
+
+  if (!m_config.gpgpu_sampling_warmup ||
+      m_memory_config->m_L2_config.disabled())
+    return;
+  if (inst.memory_op == no_memory_op || inst.space.get_type() != global_space)
+    return;
+  new_addr_type last_sector = (new_addr_type)-1;
+  for (unsigned t = 0; t < inst.warp_size(); t++) {
+    if (!inst.active(t)) continue;
+    new_addr_type addr = inst.get_addr(t);
+    if (addr / 32 == last_sector) continue;
+    last_sector = addr / 32;
+    addrdec_t raw_addr;
+    mem_access_sector_mask_t mask;
+    mask.set(addr % 128 / 32);
+    m_memory_config->m_address_mapping.addrdec_tlx(addr, &raw_addr);
+    unsigned partition_id =
+        raw_addr.sub_partition /
+        m_memory_config->m_n_sub_partition_per_memory_channel;
+    m_memory_partition_unit[partition_id]->handle_memcpy_to_gpu(
+        addr & ~(new_addr_type)31, raw_addr.sub_partition, mask);
+  }
+}
+
+// two-sided 95% quantiles of Student's t distribution for 1..30 degrees of
+// freedom; the normal quantile is used beyond that
+static double t_quantile_95(unsigned dof) {
+  static const double t95[30] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (dof == 0) return 0;
+  return dof <= 30 ? t95[dof - 1] : 1.960;
+}
+
+void gpgpu_sim::print_sampling_stats(FILE *fout) const {
+  unsigned n = m_sampling_cpi.size();
+  unsigned long long tot_insn =
+      gpu_tot_sim_insn + gpu_sim_insn + m_sampling_functional_insn;
+  fprintf(fout, "gpu_sampling_windows = %u\n", n);
+  fprintf(fout, "gpu_sampling_functional_cta = %llu\n",
+          m_sampling_functional_cta);
+  fprintf(fout, "gpu_sampling_functional_insn = %llu\n",
+          m_sampling_functional_insn);
+  if (n == 0) return;
+
+  double mean = 0;
+  for (unsigned i = 0; i < n; i++) mean += m_sampling_cpi[i];
+  mean /= n;
+  double var = 0;
+  for (unsigned i = 0; i < n; i++)
+    var += (m_sampling_cpi[i] - mean) * (m_sampling_cpi[i] - mean);
+  if (n > 1) var /= n - 1;
+  double half = t_quantile_95(n - 1) * sqrt(var / n);
+
+  fprintf(fout, "gpu_sampling_ipc = %12.4f\n", 1.0 / mean);
+  fprintf(fout, "gpu_sampling_est_tot_cycle = %.0f\n", tot_insn * mean);
+  if (n > 1) {
+    double cpi_lo = std::max(mean - half, 0.0);
+    fprintf(fout, "gpu_sampling_ipc_95ci = [%.4f, %.4f]\n",
+            1.0 / (mean + half), cpi_lo > 0 ? 1.0 / cpi_lo : INFINITY);
+    fprintf(fout, "gpu_sampling_est_tot_cycle_95ci = [%.0f, %.0f]\n",
+            tot_insn * cpi_lo, tot_insn * (mean + half));
+  }
+}
+
 void gpgpu_sim::issue_block2core() {
+  if (m_config.gpgpu_sampling && sampling_fast_forward()) return;
   unsigned last_issued = m_last_cluster_issue;
   for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
     unsigned idx = (i + last_issued + 1) % m_shader_config->n_simt_clusters;
@@ -1746,6 +2079,32 @@ void gpgpu_sim::issue_block2core() {
   }
 }
 
+void gpgpu_sim::dram_cycle_partition(unsigned i) {
+  if (m_memory_config->simple_dram_model)
+    m_memory_partition_unit[i]->simple_dram_model_cycle();
+  else
+    m_memory_partition_unit[i]
+        ->dram_cycle();  // Issue the dram command (scheduler + delay model)
+  // Update performance counters for DRAM
+  m_memory_partition_unit[i]->set_dram_power_stats(
+      m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
+}
+
+void gpgpu_sim::l2_cycle_sub_partition(unsigned i) {
+  m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle + gpu_tot_sim_cycle);
+}
+
+void gpgpu_sim::core_cycle_cluster(unsigned i) {
+  if (m_cluster_ticked[i]) m_cluster[i]->core_cycle();
+}
+
 unsigned long long g_single_step =
     0;  // set this in gdb to single step the pipeline
 
@@ -1765,7 +2124,8 @@ void gpgpu_sim::cycle() {
       if (mf) {
         unsigned response_size =
             mf->get_is_write() ? mf->get_ctrl_size() : mf->size();
-        if (::icnt_has_buffer(m_shader_config->mem2device(i), response_size)) {
+        if (::icnt_has_buffer(m_shader_config->mem2device(i), response_size, 0,
+                              0)) {
           // if (!mf->get_is_write())
           mf->set_return_timestamp(gpu_sim_cycle + gpu_tot_sim_cycle);
           mf->set_status(IN_ICNT_TO_SHADER, gpu_sim_cycle + gpu_tot_sim_cycle);
@@ -1784,23 +2144,7 @@ void gpgpu_sim::cycle() {
   partiton_replys_in_parallel += partiton_replys_in_parallel_per_cycle;
 
   if (clock_mask & DRAM) {
-    for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
-      if (m_memory_config->simple_dram_model)
-        m_memory_partition_unit[i]->simple_dram_model_cycle();
-      else
-        m_memory_partition_unit[i]
-            ->dram_cycle();  // Issue the dram command (scheduler + delay model)
-      // Update performance counters for DRAM
-      m_memory_partition_unit[i]->set_dram_power_stats(
-          m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
-    }
+    m_thread_pool->run(*m_dram_cycle_task, m_memory_config->m_n_mem);
   }
 
   // L2 operations follow L2 clock domain
@@ -1819,7 +2163,12 @@ void gpgpu_sim::cycle() {
         m_memory_sub_partition[i]->push(mf, gpu_sim_cycle + gpu_tot_sim_cycle);
         if (mf) partiton_reqs_in_parallel_per_cycle++;
       }
-      m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle + gpu_tot_sim_cycle);
+    }
+    // the sub-partitions only exchange requests through the interconnect
+    // (serviced above) and the DRAM domain, so they can be ticked in any order
+    m_thread_pool->run(*m_l2_cycle_task,
+                       m_memory_config->m_n_mem_sub_partition);
+    for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
       m_memory_sub_partition[i]->accumulate_L2cache_stats(
           m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
     }
@@ -1836,12 +2185,22 @@ void gpgpu_sim::cycle() {
 
   if (clock_mask & CORE) {
     // L1 cache + shader core pipeline stages
+    // The clusters only touch their own state while they are ticked, apart
+    // from the functional global memory; their interconnect injections,
+    // retired instructions and CTA exits are then committed in cluster order.
     m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
+    bool more_cta_left = get_more_cta_left();
+    for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+      m_cluster_ticked[i] = m_cluster[i]->get_not_completed() || more_cta_left;
+    if (m_parallel_clusters) {
+      m_thread_pool->run(*m_core_cycle_task, m_shader_config->n_simt_clusters);
+    } else {
+      for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+        core_cycle_cluster(i);
+    }
     for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
-      if (m_cluster[i]->get_not_completed() || get_more_cta_left()) {
-        m_cluster[i]->core_cycle();
-        *active_sms += m_cluster[i]->get_n_active_sms();
-      }
+      if (m_cluster_ticked[i]) *active_sms += m_cluster[i]->get_n_active_sms();
+      m_cluster[i]->commit_cycle();
       // Update core icnt/cache stats for GPUWattch
       m_cluster[i]->get_icnt_stats(
           m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i],
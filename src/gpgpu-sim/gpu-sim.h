@@ -69,7 +69,11 @@ extern tr1_hash_map<new_addr_type, unsigned> address_random_interleaving;
 enum dram_ctrl_t { DRAM_FIFO = 0, DRAM_FRFCFS = 1 };
 
 struct power_config {
-  power_config() { m_valid = true; }
+  power_config() {
+    m_valid = true;
+    // no option sets the nonlinear model
+    g_use_nonlinear_model = false;
+  }
   void init() {
     // initialize file name if it is not set
     time_t curr_time;
@@ -240,6 +244,7 @@ class memory_config {
   bool m_valid;
   mutable l2_cache_config m_L2_config;
   bool m_L2_texure_only;
+  bool gpgpu_mem_cpl_priority;
 
   char *gpgpu_dram_timing_opt;
   char *gpgpu_L2_queue_config;
@@ -247,6 +252,14 @@ class memory_config {
   unsigned gpgpu_frfcfs_dram_sched_queue_size;
   unsigned gpgpu_dram_return_queue_size;
   enum dram_ctrl_t scheduler_type;
+  char *dram_sched_policy;
+  bool dram_sched_cpl_priority;
+  unsigned dram_parbs_marking_cap;
+  unsigned dram_atlas_quantum;
+  double dram_atlas_alpha;
+  unsigned dram_atlas_threshold;
+  unsigned dram_bliss_threshold;
+  unsigned dram_bliss_clear_interval;
   bool gpgpu_memlatency_stat;
   unsigned m_n_mem;
   unsigned m_n_sub_partition_per_memory_channel;
@@ -314,6 +327,7 @@ class memory_config {
   unsigned write_low_watermark;
   bool m_perf_sim_memcpy;
   bool simple_dram_model;
+  bool m_mf_pool_debug;
 
   gpgpu_context *gpgpu_ctx;
 };
@@ -361,6 +375,7 @@ class gpgpu_sim_config : public power_config,
   unsigned num_shader() const { return m_shader_config.num_shader(); }
   unsigned num_cluster() const { return m_shader_config.n_simt_clusters; }
   unsigned get_max_concurrent_kernel() const { return max_concurrent_kernel; }
+  bool async_memcpy() const { return gpgpu_async_memcpy; }
   unsigned checkpoint_option;
 
   size_t stack_limit() const { return stack_size_limit; }
@@ -403,6 +418,16 @@ class gpgpu_sim_config : public power_config,
   int gpgpu_cflog_interval;
   char *gpgpu_clock_domains;
   unsigned max_concurrent_kernel;
+  unsigned gpgpu_sim_threads;
+  bool gpgpu_sim_parallel_clusters;
+  bool gpgpu_async_memcpy;
+
+  // sampled simulation: one detailed window of CTAs per sampling unit, the
+  // rest of the unit runs functionally
+  bool gpgpu_sampling;
+  unsigned gpgpu_sampling_window;
+  unsigned gpgpu_sampling_period;
+  bool gpgpu_sampling_warmup;
 
   // visualizer
   bool g_visualizer_enabled;
@@ -480,6 +505,7 @@ class watchpoint_event {
 class gpgpu_sim : public gpgpu_t {
  public:
   gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx);
+  virtual ~gpgpu_sim();
 
   void set_prop(struct cudaDeviceProp *prop);
 
@@ -505,6 +531,7 @@ class gpgpu_sim : public gpgpu_t {
   void print_stats();
   void update_stats();
   void deadlock_check();
+  void check_mem_fetch_leaks();
   void inc_completed_cta() { gpu_completed_cta++; }
   void get_pdom_stack_top_info(unsigned sid, unsigned tid, unsigned *pc,
                                unsigned *rpc);
@@ -534,6 +561,7 @@ class gpgpu_sim : public gpgpu_t {
   void dump_pipeline(int mask, int s, int m) const;
 
   void perf_memcpy_to_gpu(size_t dst_start_addr, size_t count);
+  void sampling_functional_inst(const warp_inst_t &inst);
 
   // The next three functions added to be used by the functional simulation
   // function
@@ -560,6 +588,8 @@ class gpgpu_sim : public gpgpu_t {
   simt_core_cluster *getSIMTCluster();
 
   void print_cpl_accuracy() const;
+  // CPL of warp wid on core sid; 0 if sid is not a core (e.g. L2 write-backs)
+  float get_warp_cpl(unsigned sid, unsigned wid) const;
 
   void hit_watchpoint(unsigned watchpoint_num, ptx_thread_info *thd,
                       const ptx_instruction *pI);
@@ -580,6 +610,22 @@ class gpgpu_sim : public gpgpu_t {
   void visualizer_printstat();
   void print_shader_cycle_distro(FILE *fout) const;
 
+  // sampled simulation (-gpgpu_sampling)
+  bool sampling_detailed_cta(const kernel_info_t &kernel) const;
+  bool sampling_fast_forward();
+  void sampling_close_window();
+  void print_sampling_stats(FILE *fout) const;
+
+  // per-component work of the DRAM and L2 clock domains; each call only
+  // touches the state of one memory partition / sub-partition, so they can be
+  // dispatched to m_thread_pool
+  void dram_cycle_partition(unsigned i);
+  void l2_cycle_sub_partition(unsigned i);
+  // core side of one SIMT cluster; what it would hand to the rest of the GPU
+  // is held in the cluster until simt_core_cluster::commit_cycle()
+  void core_cycle_cluster(unsigned i);
+  bool parallel_clusters_allowed() const;
+
   void gpgpu_debug();
 
  protected:
@@ -588,6 +634,15 @@ class gpgpu_sim : public gpgpu_t {
   class memory_partition_unit **m_memory_partition_unit;
   class memory_sub_partition **m_memory_sub_partition;
 
+  // host threads ticking the clusters and the memory system
+  // (-gpgpu_sim_threads)
+  class sim_thread_pool *m_thread_pool;
+  class parallel_task *m_dram_cycle_task;
+  class parallel_task *m_l2_cycle_task;
+  class parallel_task *m_core_cycle_task;
+  bool m_parallel_clusters;  // set at each launch
+  std::vector<char> m_cluster_ticked;  // clusters in this core cycle
+
   std::vector<kernel_info_t *> m_running_kernels;
   unsigned m_last_issued_kernel;
 
@@ -599,6 +654,17 @@ class gpgpu_sim : public gpgpu_t {
   unsigned gpu_completed_cta;
 
   unsigned m_last_cluster_issue;
+
+  // sampled simulation: the open detailed window and the CPI of each closed
+  // one, plus the work that was only simulated functionally
+  bool m_sampling_window_open;
+  bool m_sampling_fast_forwarding;
+  unsigned long long m_sampling_window_cycle;
+  unsigned long long m_sampling_window_insn;
+  std::vector<double> m_sampling_cpi;
+  unsigned long long m_sampling_functional_cta;
+  unsigned long long m_sampling_functional_insn;
+
   float *average_pipeline_duty_cycle;
   float *active_sms;
   // time of next rising edge
@@ -30,6 +30,7 @@
 #include <assert.h>
 #include "../intersim2/globals.hpp"
 #include "../intersim2/interconnect_interface.hpp"
+#include "analytical_interconnect.h"
 #include "local_interconnect.h"
 
 icnt_create_p icnt_create;
@@ -49,6 +50,7 @@ char* g_network_config_filename;
 
 struct inct_config g_inct_config;
 LocalInterconnect* g_localicnt_interface;
+AnalyticalInterconnect* g_analyticalicnt_interface;
 
 #include "../option_parser.h"
 
@@ -61,8 +63,9 @@ static void intersim2_create(unsigned int n_shader, unsigned int n_mem) {
 
 static void intersim2_init() { g_icnt_interface->Init(); }
 
-static bool intersim2_has_buffer(unsigned input, unsigned int size) {
-  return g_icnt_interface->HasBuffer(input, size);
+static bool intersim2_has_buffer(unsigned input, unsigned int size,
+                                 unsigned queued, unsigned queued_flits) {
+  return g_icnt_interface->HasBuffer(input, size, queued, queued_flits);
 }
 
 static void intersim2_push(unsigned input, unsigned output, void* data,
@@ -101,8 +104,10 @@ static void LocalInterconnect_create(unsigned int n_shader,
 
 static void LocalInterconnect_init() { g_localicnt_interface->Init(); }
 
-static bool LocalInterconnect_has_buffer(unsigned input, unsigned int size) {
-  return g_localicnt_interface->HasBuffer(input, size);
+static bool LocalInterconnect_has_buffer(unsigned input, unsigned int size,
+                                         unsigned queued,
+                                         unsigned queued_flits) {
+  return g_localicnt_interface->HasBuffer(input, size, queued, queued_flits);
 }
 
 static void LocalInterconnect_push(unsigned input, unsigned output, void* data,
@@ -134,6 +139,58 @@ static unsigned LocalInterconnect_get_flit_size() {
   return g_localicnt_interface->GetFlitSize();
 }
 
+//////////////////////////////////////////////////////
+
+static void AnalyticalInterconnect_create(unsigned int n_shader,
+                                          unsigned int n_mem) {
+  g_analyticalicnt_interface->CreateInterconnect(n_shader, n_mem);
+}
+
+static void AnalyticalInterconnect_init() {
+  g_analyticalicnt_interface->Init();
+}
+
+static bool AnalyticalInterconnect_has_buffer(unsigned input,
+                                              unsigned int size,
+                                              unsigned queued,
+                                              unsigned queued_flits) {
+  return g_analyticalicnt_interface->HasBuffer(input, size, queued,
+                                               queued_flits);
+}
+
+static void AnalyticalInterconnect_push(unsigned input, unsigned output,
+                                        void* data, unsigned int size) {
+  g_analyticalicnt_interface->Push(input, output, data, size);
+}
+
+static void* AnalyticalInterconnect_pop(unsigned output) {
+  return g_analyticalicnt_interface->Pop(output);
+}
+
+static void AnalyticalInterconnect_transfer() {
+  g_analyticalicnt_interface->Advance();
+}
+
+static bool AnalyticalInterconnect_busy() {
+  return g_analyticalicnt_interface->Busy();
+}
+
+static void AnalyticalInterconnect_display_stats() {
+  g_analyticalicnt_interface->DisplayStats();
+}
+
+static void AnalyticalInterconnect_display_overall_stats() {
+  g_analyticalicnt_interface->DisplayOverallStats();
+}
+
+static void AnalyticalInterconnect_display_state(FILE* fp) {
+  g_analyticalicnt_interface->DisplayState(fp);
+}
+
+static unsigned AnalyticalInterconnect_get_flit_size() {
+  return g_analyticalicnt_interface->GetFlitSize();
+}
+
 ///////////////////////////
 
 void icnt_reg_options(class OptionParser* opp) {
@@ -158,6 +215,16 @@ void icnt_reg_options(class OptionParser* opp) {
                          &g_inct_config.verbose, "inct_verbose", "0");
   option_parser_register(opp, "-icnt_grant_cycles", OPT_UINT32,
                          &g_inct_config.grant_cycles, "grant_cycles", "1");
+
+  // parameters for analytical xbar
+  option_parser_register(opp, "-icnt_base_latency", OPT_UINT32,
+                         &g_inct_config.base_latency,
+                         "analytical xbar: cycles from input to output port "
+                         "without contention",
+                         "8");
+  option_parser_register(opp, "-icnt_port_bandwidth", OPT_UINT32,
+                         &g_inct_config.port_bandwidth,
+                         "analytical xbar: bytes per cycle per port", "40");
 }
 
 void icnt_wrapper_init() {
@@ -191,6 +258,20 @@ void icnt_wrapper_init() {
       icnt_display_state = LocalInterconnect_display_state;
       icnt_get_flit_size = LocalInterconnect_get_flit_size;
       break;
+    case ANALYTICAL_XBAR:
+      g_analyticalicnt_interface = AnalyticalInterconnect::New(g_inct_config);
+      icnt_create = AnalyticalInterconnect_create;
+      icnt_init = AnalyticalInterconnect_init;
+      icnt_has_buffer = AnalyticalInterconnect_has_buffer;
+      icnt_push = AnalyticalInterconnect_push;
+      icnt_pop = AnalyticalInterconnect_pop;
+      icnt_transfer = AnalyticalInterconnect_transfer;
+      icnt_busy = AnalyticalInterconnect_busy;
+      icnt_display_stats = AnalyticalInterconnect_display_stats;
+      icnt_display_overall_stats = AnalyticalInterconnect_display_overall_stats;
+      icnt_display_state = AnalyticalInterconnect_display_state;
+      icnt_get_flit_size = AnalyticalInterconnect_get_flit_size;
+      break;
     default:
       assert(0);
       break;
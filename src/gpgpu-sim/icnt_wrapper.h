@@ -35,7 +35,10 @@
 
 typedef void (*icnt_create_p)(unsigned n_shader, unsigned n_mem);
 typedef void (*icnt_init_p)();
-typedef bool (*icnt_has_buffer_p)(unsigned input, unsigned int size);
+// queued/queued_flits: packets (and their flits) the input has already
+// accepted this cycle but not pushed yet; they count against its buffer
+typedef bool (*icnt_has_buffer_p)(unsigned input, unsigned int size,
+                                  unsigned queued, unsigned queued_flits);
 typedef void (*icnt_push_p)(unsigned input, unsigned output, void* data,
                             unsigned int size);
 typedef void* (*icnt_pop_p)(unsigned output);
@@ -61,7 +64,12 @@ extern icnt_display_state_p icnt_display_state;
 extern icnt_get_flit_size_p icnt_get_flit_size;
 extern unsigned g_network_mode;
 
-enum network_mode { INTERSIM = 1, LOCAL_XBAR = 2, N_NETWORK_MODE };
+enum network_mode {
+  INTERSIM = 1,
+  LOCAL_XBAR = 2,
+  ANALYTICAL_XBAR = 3,
+  N_NETWORK_MODE
+};
 
 void icnt_wrapper_init();
 void icnt_reg_options(class OptionParser* opp);
@@ -52,8 +52,8 @@ mem_fetch *partition_mf_allocator::alloc(new_addr_type addr,
                                          unsigned long long cycle) const {
   assert(wr);
   mem_access_t access(type, addr, size, wr, m_memory_config->gpgpu_ctx);
-  mem_fetch *mf = new mem_fetch(access, NULL, WRITE_PACKET_SIZE, -1, -1, -1,
-                                m_memory_config, cycle);
+  mem_fetch *mf = new (m_pool) mem_fetch(access, NULL, WRITE_PACKET_SIZE, -1,
+                                         -1, -1, m_memory_config, cycle);
   return mf;
 }
 
@@ -416,7 +416,13 @@ memory_sub_partition::memory_sub_partition(unsigned sub_partition_id,
   char L2c_name[32];
   snprintf(L2c_name, 32, "L2_bank_%03d", m_id);
   m_L2interface = new L2interface(this);
-  m_mf_allocator = new partition_mf_allocator(config);
+  char pool_name[32];
+  snprintf(pool_name, 32, "sub_partition_%03d", m_id);
+  unsigned n_clusters = gpu->getShaderCoreConfig()->n_simt_clusters;
+  m_mf_pool = new mem_fetch_pool(
+      pool_name, m_config->m_mf_pool_debug, 1 + n_clusters + m_id,
+      n_clusters + m_config->m_n_mem_sub_partition);
+  m_mf_allocator = new partition_mf_allocator(config, m_mf_pool);
 
   if (!m_config->m_L2_config.disabled())
     m_L2cache =
@@ -445,6 +451,10 @@ memory_sub_partition::~memory_sub_partition() {
   delete m_L2interface;
 }
 
+static bool mem_fetch_is_critical(const mem_fetch *mf) {
+  return mf->is_critical();
+}
+
 void memory_sub_partition::cache_cycle(unsigned cycle) {
   // L2 fill responses
   if (!m_config->m_L2_config.disabled()) {
@@ -467,7 +477,6 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
               m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
           m_L2_icnt_queue->push(original_wr_mf);
         }
-        m_request_tracker.erase(mf);
         delete mf;
       }
     }
@@ -498,7 +507,14 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
 
   // new L2 texture accesses and/or non-texture accesses
   if (!m_L2_dram_queue->full() && !m_icnt_L2_queue->empty()) {
+    if (m_config->gpgpu_mem_cpl_priority)
+      m_icnt_L2_queue->promote(mem_fetch_is_critical);
     mem_fetch *mf = m_icnt_L2_queue->top();
+    // mf may be gone once L2 has taken it
+    bool critical = mf->is_critical();
+    unsigned queue_latency = m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle -
+                             mf->get_status_change();
+    unsigned queued = m_icnt_L2_queue->get_n_element();
     if (!m_config->m_L2_config.disabled() &&
         ((m_config->m_L2_texure_only && mf->istexture()) ||
          (!m_config->m_L2_texure_only))) {
@@ -522,7 +538,6 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
             // L2 cache replies
             assert(!read_sent);
             if (mf->get_access_type() == L1_WRBK_ACC) {
-              m_request_tracker.erase(mf);
               delete mf;
             } else {
               mf->set_reply();
@@ -561,6 +576,8 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
       m_L2_dram_queue->push(mf);
       m_icnt_L2_queue->pop();
     }
+    if (m_icnt_L2_queue->get_n_element() < queued)
+      m_stats->memlatstat_crit_hop(critical, CRIT_HOP_L2_QUEUE, queue_latency);
   }
 
   // ROP delay queue
@@ -607,14 +624,7 @@ void memory_sub_partition::print_cache_stat(unsigned &accesses,
 void memory_sub_partition::print(FILE *fp) const {
   if (!m_request_tracker.empty()) {
     fprintf(fp, "Memory Sub Parition %u: pending memory requests:\n", m_id);
-    for (std::set<mem_fetch *>::const_iterator r = m_request_tracker.begin();
-         r != m_request_tracker.end(); ++r) {
-      mem_fetch *mf = *r;
-      if (mf)
-        mf->print(fp);
-      else
-        fprintf(fp, " <NULL mem_fetch?>\n");
-    }
+    m_request_tracker.print(fp);
   }
   if (!m_config->m_L2_config.disabled()) m_L2cache->display_state(fp);
 }
@@ -742,10 +752,10 @@ memory_sub_partition::breakdown_request_to_sector_requests(mem_fetch *mf) {
           mf->get_access_byte_mask() & byte_sector_mask,
           std::bitset<SECTOR_CHUNCK_SIZE>().set(j), m_gpu->gpgpu_ctx);
 
-      mem_fetch *n_mf =
-          new mem_fetch(*ma, NULL, mf->get_ctrl_size(), mf->get_wid(),
-                        mf->get_sid(), mf->get_tpc(), mf->get_mem_config(),
-                        m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle, mf);
+      mem_fetch *n_mf = new (m_mf_pool)
+          mem_fetch(*ma, NULL, mf->get_ctrl_size(), mf->get_wid(),
+                    mf->get_sid(), mf->get_tpc(), mf->get_mem_config(),
+                    m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle, mf);
 
       result.push_back(n_mf);
       byte_sector_mask <<= SECTOR_SIZE;
@@ -807,7 +817,6 @@ mem_fetch *memory_sub_partition::top() {
   if (mf && (mf->get_access_type() == L2_WRBK_ACC ||
              mf->get_access_type() == L1_WRBK_ACC)) {
     m_L2_icnt_queue->pop();
-    m_request_tracker.erase(mf);
     delete mf;
     mf = NULL;
   }
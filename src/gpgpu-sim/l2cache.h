@@ -31,6 +31,7 @@
 
 #include "../abstract_hardware_model.h"
 #include "dram.h"
+#include "mem_fetch.h"
 
 #include <list>
 #include <queue>
@@ -39,8 +40,9 @@ class mem_fetch;
 
 class partition_mf_allocator : public mem_fetch_allocator {
  public:
-  partition_mf_allocator(const memory_config *config) {
+  partition_mf_allocator(const memory_config *config, mem_fetch_pool *pool) {
     m_memory_config = config;
+    m_pool = pool;
   }
   virtual mem_fetch *alloc(const class warp_inst_t &inst,
                            const mem_access_t &access,
@@ -51,9 +53,11 @@ class partition_mf_allocator : public mem_fetch_allocator {
   virtual mem_fetch *alloc(new_addr_type addr, mem_access_type type,
                            unsigned size, bool wr,
                            unsigned long long cycle) const;
+  virtual mem_fetch_pool *get_pool() const { return m_pool; }
 
  private:
   const memory_config *m_memory_config;
+  mem_fetch_pool *m_pool;
 };
 
 // Memory partition unit contains all the units assolcated with a single DRAM
@@ -155,6 +159,7 @@ class memory_sub_partition {
   ~memory_sub_partition();
 
   unsigned get_id() const { return m_id; }
+  mem_fetch_pool *get_mf_pool() const { return m_mf_pool; }
 
   bool busy() const;
 
@@ -204,6 +209,7 @@ class memory_sub_partition {
   class L2interface *m_L2interface;
   class gpgpu_sim *m_gpu;
   partition_mf_allocator *m_mf_allocator;
+  mem_fetch_pool *m_mf_pool;
 
   // model delay of ROP units with a fixed latency
   struct rop_delay_t {
@@ -223,7 +229,7 @@ class memory_sub_partition {
 
   class memory_stats_t *m_stats;
 
-  std::set<mem_fetch *> m_request_tracker;
+  mem_fetch_tracker m_request_tracker;
 
   friend class L2interface;
 
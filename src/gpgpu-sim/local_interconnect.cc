@@ -50,9 +50,18 @@ xbar_router::xbar_router(unsigned router_id, enum Interconnect_type m_type,
   grant_cycles_count = m_localinct_config.grant_cycles;
   in_buffers.resize(total_nodes);
   out_buffers.resize(total_nodes);
+  requests.resize(total_nodes);
+  for (unsigned i = 0; i < total_nodes; ++i) requests[i].resize(total_nodes);
+  request_count.resize(total_nodes, 0);
+  requested_outputs.resize(total_nodes);
+  busy_inputs.resize(total_nodes);
+  issued.resize(total_nodes);
+  in_buffered = 0;
+  out_buffered = 0;
   next_node.resize(total_nodes, 0);
   in_buffer_limit = m_localinct_config.in_buffer_limit;
   out_buffer_limit = m_localinct_config.out_buffer_limit;
+  full_out_buffers = out_buffer_limit ? 0 : total_nodes;
   arbit_type = m_localinct_config.arbiter_algo;
   next_node_id = 0;
   if (m_type == REQ_NET) {
@@ -80,7 +89,10 @@ xbar_router::~xbar_router() {}
 void xbar_router::Push(unsigned input_deviceID, unsigned output_deviceID,
                        void* data, unsigned int size) {
   assert(input_deviceID < total_nodes);
+  assert(output_deviceID < total_nodes);
   in_buffers[input_deviceID].push(Packet(data, output_deviceID));
+  in_buffered++;
+  if (in_buffers[input_deviceID].size() == 1) AddRequest(input_deviceID);
   packets_num++;
 }
 
@@ -89,20 +101,53 @@ void* xbar_router::Pop(unsigned ouput_deviceID) {
   void* data = NULL;
 
   if (!out_buffers[ouput_deviceID].empty()) {
+    if (out_buffers[ouput_deviceID].size() >= out_buffer_limit)
+      full_out_buffers--;
     data = out_buffers[ouput_deviceID].front().data;
     out_buffers[ouput_deviceID].pop();
+    out_buffered--;
   }
 
   return data;
 }
 
+// the head packet of an input becomes a request to its output
+void xbar_router::AddRequest(unsigned input_deviceID) {
+  unsigned output = in_buffers[input_deviceID].front().output_deviceID;
+  requests[output].set(input_deviceID);
+  if (request_count[output]++ == 0) requested_outputs.set(output);
+  busy_inputs.set(input_deviceID);
+}
+
+void xbar_router::RemoveRequest(unsigned input_deviceID) {
+  unsigned output = in_buffers[input_deviceID].front().output_deviceID;
+  requests[output].reset(input_deviceID);
+  if (--request_count[output] == 0) requested_outputs.reset(output);
+  busy_inputs.reset(input_deviceID);
+}
+
+// move the head packet of an input to its output buffer
+void xbar_router::Move(unsigned input_deviceID) {
+  RemoveRequest(input_deviceID);
+  Packet _packet = in_buffers[input_deviceID].front();
+  in_buffers[input_deviceID].pop();
+  in_buffered--;
+  if (!in_buffers[input_deviceID].empty()) AddRequest(input_deviceID);
+
+  out_buffers[_packet.output_deviceID].push(_packet);
+  out_buffered++;
+  if (out_buffers[_packet.output_deviceID].size() >= out_buffer_limit)
+    full_out_buffers++;
+}
+
 bool xbar_router::Has_Buffer_In(unsigned input_deviceID, unsigned size,
                                 bool update_counter) {
   assert(input_deviceID < total_nodes);
 
   bool has_buffer =
       (in_buffers[input_deviceID].size() + size <= in_buffer_limit);
-  if (update_counter && !has_buffer) in_buffer_full++;
+  // the cores of different clusters query their inputs concurrently
+  if (update_counter && !has_buffer) __sync_fetch_and_add(&in_buffer_full, 1);
 
   return has_buffer;
 }
@@ -121,35 +166,37 @@ void xbar_router::Advance() {
 }
 
 void xbar_router::RR_Advance() {
-  bool active = false;
-  vector<bool> issued(total_nodes, false);
+  bool active = in_buffered > 0;
   unsigned conflict_sub = 0;
   unsigned reqs = 0;
 
-  for (unsigned i = 0; i < total_nodes; ++i) {
-    unsigned node_id = (i + next_node_id) % total_nodes;
-
-    if (!in_buffers[node_id].empty()) {
-      active = true;
-      Packet _packet = in_buffers[node_id].front();
+  // each input with a packet offers its head packet once, in round-robin
+  // order from next_node_id
+  issued.clear();
+  for (unsigned pass = 0; pass < 2; ++pass) {
+    unsigned first = pass ? 0 : next_node_id;
+    unsigned last = pass ? next_node_id : total_nodes;
+    for (int node_id = busy_inputs.find_next(first);
+         node_id >= 0 && (unsigned)node_id < last;
+         node_id = busy_inputs.find_next(node_id + 1)) {
+      unsigned output = in_buffers[node_id].front().output_deviceID;
       // ensure that the outbuffer has space and not issued before in this cycle
-      if (Has_Buffer_Out(_packet.output_deviceID, 1)) {
-        if (!issued[_packet.output_deviceID]) {
-          out_buffers[_packet.output_deviceID].push(_packet);
-          in_buffers[node_id].pop();
-          issued[_packet.output_deviceID] = true;
+      if (Has_Buffer_Out(output, 1)) {
+        if (!issued.test(output)) {
+          Move(node_id);
+          issued.set(output);
           reqs++;
         } else
           conflict_sub++;
       } else {
         out_buffer_full++;
 
-        if (issued[_packet.output_deviceID]) conflict_sub++;
+        if (issued.test(output)) conflict_sub++;
       }
     }
   }
 
-  next_node_id = (++next_node_id % total_nodes);
+  next_node_id = (next_node_id + 1) % total_nodes;
 
   conflicts += conflict_sub;
   if (active) {
@@ -164,10 +211,8 @@ void xbar_router::RR_Advance() {
   }
 
   // collect some stats about buffer util
-  for (unsigned i = 0; i < total_nodes; ++i) {
-    in_buffer_util += in_buffers[i].size();
-    out_buffer_util += out_buffers[i].size();
-  }
+  in_buffer_util += in_buffered;
+  out_buffer_util += out_buffered;
 
   cycles++;
 }
@@ -177,70 +222,50 @@ void xbar_router::RR_Advance() {
 // IEEE/ACM transactions on networking 2 (1999): 188-201.
 // https://www.cs.rutgers.edu/~sn624/552-F18/papers/islip.pdf
 void xbar_router::iSLIP_Advance() {
-  vector<unsigned> node_tmp;
-  bool active = false;
+  bool active = in_buffered > 0;
 
-  unsigned conflict_sub = 0;
   unsigned reqs = 0;
 
-  // calcaulte how many conflicts are there for stats
-  for (unsigned i = 0; i < total_nodes; ++i) {
-    if (!in_buffers[i].empty()) {
-      Packet _packet_tmp = in_buffers[i].front();
-      if (!node_tmp.empty()) {
-        if (std::find(node_tmp.begin(), node_tmp.end(),
-                      _packet_tmp.output_deviceID) != node_tmp.end()) {
-          conflict_sub++;
-        } else
-          node_tmp.push_back(_packet_tmp.output_deviceID);
-      } else {
-        node_tmp.push_back(_packet_tmp.output_deviceID);
-      }
-      active = true;
-    }
-  }
+  // for stats: inputs whose head packet goes to an output another input
+  // also requests
+  unsigned conflict_sub = busy_inputs.count() - requested_outputs.count();
 
   conflicts += conflict_sub;
   if (active) {
     conflicts_util += conflict_sub;
     cycles_util++;
   }
-  // do iSLIP
-  for (unsigned i = 0; i < total_nodes; ++i) {
-    if (Has_Buffer_Out(i, 1)) {
-      for (unsigned j = 0; j < total_nodes; ++j) {
-        unsigned node_id = (j + next_node[i]) % total_nodes;
-
-        if (!in_buffers[node_id].empty()) {
-          Packet _packet = in_buffers[node_id].front();
-          if (_packet.output_deviceID == i) {
-            out_buffers[_packet.output_deviceID].push(_packet);
-            in_buffers[node_id].pop();
-            if (verbose)
-              printf("%d : cycle %d : send req from %d to %d\n", m_id, cycles,
-                     node_id, i - _n_shader);
-            if (grant_cycles_count == 1)
-              next_node[i] = (++node_id % total_nodes);
-            if (verbose) {
-              for (unsigned k = j + 1; k < total_nodes; ++k) {
-                unsigned node_id2 = (k + next_node[i]) % total_nodes;
-                if (!in_buffers[node_id2].empty()) {
-                  Packet _packet2 = in_buffers[node_id2].front();
-
-                  if (_packet2.output_deviceID == i)
-                    printf("%d : cycle %d : cannot send req from %d to %d\n",
-                           m_id, cycles, node_id2, i - _n_shader);
-                }
-              }
-            }
-
-            reqs++;
-            break;
-          }
+  out_buffer_full += full_out_buffers;
+
+  // do iSLIP: every requested output with room grants the first requesting
+  // input in round-robin order from next_node; outputs go in increasing
+  // order, so the next packet of a granted input may still win a later
+  // output in this cycle
+  for (int i = requested_outputs.find_next(0); i >= 0;
+       i = requested_outputs.find_next(i + 1)) {
+    if (!Has_Buffer_Out(i, 1)) continue;
+
+    unsigned node_id = requests[i].find_next_circular(next_node[i]);
+    unsigned j = (node_id + total_nodes - next_node[i]) % total_nodes;
+    Move(node_id);
+    if (verbose)
+      printf("%d : cycle %d : send req from %d to %d\n", m_id, cycles, node_id,
+             i - _n_shader);
+    if (grant_cycles_count == 1) next_node[i] = (node_id + 1) % total_nodes;
+    if (verbose) {
+      for (unsigned k = j + 1; k < total_nodes; ++k) {
+        unsigned node_id2 = (k + next_node[i]) % total_nodes;
+        if (!in_buffers[node_id2].empty()) {
+          Packet _packet2 = in_buffers[node_id2].front();
+
+          if (_packet2.output_deviceID == (unsigned)i)
+            printf("%d : cycle %d : cannot send req from %d to %d\n", m_id,
+                   cycles, node_id2, i - _n_shader);
         }
       }
-    } else
-      out_buffer_full++;
+    }
+
+    reqs++;
   }
 
   if (active) {
@@ -261,22 +286,13 @@ void xbar_router::iSLIP_Advance() {
   }
 
   // collect some stats about buffer util
-  for (unsigned i = 0; i < total_nodes; ++i) {
-    in_buffer_util += in_buffers[i].size();
-    out_buffer_util += out_buffers[i].size();
-  }
+  in_buffer_util += in_buffered;
+  out_buffer_util += out_buffered;
 
   cycles++;
 }
 
-bool xbar_router::Busy() const {
-  for (unsigned i = 0; i < total_nodes; ++i) {
-    if (!in_buffers[i].empty()) return true;
-
-    if (!out_buffers[i].empty()) return true;
-  }
-  return false;
-}
+bool xbar_router::Busy() const { return in_buffered || out_buffered; }
 
 ////////////////////////////////////////////////////
 /////////////LocalInterconnect/////////////////////
@@ -364,13 +380,15 @@ bool LocalInterconnect::Busy() const {
   return false;
 }
 
-bool LocalInterconnect::HasBuffer(unsigned deviceID, unsigned int size) const {
+bool LocalInterconnect::HasBuffer(unsigned deviceID, unsigned int size,
+                                  unsigned queued,
+                                  unsigned queued_flits) const {
   bool has_buffer = false;
 
   if ((n_subnets > 1) && deviceID >= n_shader)  // deviceID is memory node
-    has_buffer = net[REPLY_NET]->Has_Buffer_In(deviceID, 1, true);
+    has_buffer = net[REPLY_NET]->Has_Buffer_In(deviceID, 1 + queued, true);
   else
-    has_buffer = net[REQ_NET]->Has_Buffer_In(deviceID, 1, true);
+    has_buffer = net[REQ_NET]->Has_Buffer_In(deviceID, 1 + queued, true);
 
   return has_buffer;
 }
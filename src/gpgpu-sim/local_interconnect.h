@@ -39,6 +39,77 @@ enum Interconnect_type { REQ_NET = 0, REPLY_NET = 1 };
 
 enum Arbiteration_type { NAIVE_RR = 0, iSLIP = 1 };
 
+// One bit per node id; sets are scanned word by word with find-first-set so
+// the arbiters' cost grows with the number of busy nodes, not nodes squared.
+class node_mask {
+ public:
+  void resize(unsigned n_nodes) { words.assign((n_nodes + 63) / 64, 0); }
+  void set(unsigned i) { words[i >> 6] |= 1ULL << (i & 63); }
+  void reset(unsigned i) { words[i >> 6] &= ~(1ULL << (i & 63)); }
+  void clear() { words.assign(words.size(), 0); }
+  bool test(unsigned i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+  unsigned count() const {
+    unsigned n = 0;
+    for (unsigned w = 0; w < words.size(); ++w)
+      n += __builtin_popcountll(words[w]);
+    return n;
+  }
+  // lowest set bit at or above start, -1 if there is none
+  int find_next(unsigned start) const {
+    unsigned w = start >> 6;
+    if (w >= words.size()) return -1;
+    unsigned long long bits = words[w] & (~0ULL << (start & 63));
+    while (!bits) {
+      if (++w == words.size()) return -1;
+      bits = words[w];
+    }
+    return (w << 6) + __builtin_ctzll(bits);
+  }
+  // first set bit in round-robin order starting at start, -1 if empty
+  int find_next_circular(unsigned start) const {
+    int i = find_next(start);
+    if (i < 0 && start) i = find_next(0);
+    return i;
+  }
+
+ private:
+  vector<unsigned long long> words;
+};
+
+// FIFO over a power-of-two ring that only grows, so steady-state traffic does
+// not allocate.
+template <class T>
+class ring_fifo {
+ public:
+  ring_fifo() : slots(8), head(0), count(0) {}
+  bool empty() const { return count == 0; }
+  unsigned size() const { return count; }
+  const T& front() const { return slots[head]; }
+  const T& at(unsigned i) const {
+    return slots[(head + i) & (slots.size() - 1)];
+  }
+  void push(const T& item) {
+    if (count == slots.size()) {
+      vector<T> grown;
+      grown.reserve(2 * slots.size());
+      for (unsigned i = 0; i < count; ++i) grown.push_back(at(i));
+      grown.resize(2 * slots.size(), item);
+      slots.swap(grown);
+      head = 0;
+    }
+    slots[(head + count) & (slots.size() - 1)] = item;
+    count++;
+  }
+  void pop() {
+    head = (head + 1) & (slots.size() - 1);
+    count--;
+  }
+
+ private:
+  vector<T> slots;
+  unsigned head, count;
+};
+
 struct inct_config {
   // config for local interconnect
   unsigned in_buffer_limit;
@@ -47,6 +118,10 @@ struct inct_config {
   Arbiteration_type arbiter_algo;
   unsigned verbose;
   unsigned grant_cycles;
+  // config for the analytical xbar (network_mode 3), which also uses the
+  // buffer limits above
+  unsigned base_latency;
+  unsigned port_bandwidth;
 };
 
 class xbar_router {
@@ -82,6 +157,7 @@ class xbar_router {
   void RR_Advance();
 
   struct Packet {
+    Packet() : data(NULL), output_deviceID(0) {}
     Packet(void* m_data, unsigned m_output_deviceID) {
       data = m_data;
       output_deviceID = m_output_deviceID;
@@ -89,8 +165,21 @@ class xbar_router {
     void* data;
     unsigned output_deviceID;
   };
-  vector<queue<Packet> > in_buffers;
-  vector<queue<Packet> > out_buffers;
+  void Move(unsigned input_deviceID);
+  void AddRequest(unsigned input_deviceID);
+  void RemoveRequest(unsigned input_deviceID);
+
+  vector<ring_fifo<Packet> > in_buffers;
+  vector<ring_fifo<Packet> > out_buffers;
+  // requests[o] holds the inputs whose head packet goes to output o;
+  // requested_outputs and busy_inputs are kept in step with the buffers
+  vector<node_mask> requests;
+  vector<unsigned> request_count;
+  node_mask requested_outputs;
+  node_mask busy_inputs;
+  node_mask issued;  // outputs already granted in the current RR cycle
+  unsigned long long in_buffered, out_buffered;
+  unsigned full_out_buffers;
   unsigned _n_shader, _n_mem, total_nodes;
   unsigned in_buffer_limit, out_buffer_limit;
   vector<unsigned> next_node;  // used for iSLIP arbit
@@ -121,7 +210,8 @@ class LocalInterconnect {
   void* Pop(unsigned ouput_deviceID);
   void Advance();
   bool Busy() const;
-  bool HasBuffer(unsigned deviceID, unsigned int size) const;
+  bool HasBuffer(unsigned deviceID, unsigned int size, unsigned queued = 0,
+                 unsigned queued_flits = 0) const;
   void DisplayStats() const;
   void DisplayOverallStats() const;
   unsigned GetFlitSize() const;
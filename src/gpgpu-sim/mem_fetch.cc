@@ -32,8 +32,6 @@
 #include "shader.h"
 #include "visualizer.h"
 
-unsigned mem_fetch::sm_next_mf_request_uid = 1;
-
 mem_fetch::mem_fetch(const mem_access_t &access, const warp_inst_t *inst,
                      unsigned ctrl_size, unsigned wid, unsigned sid,
                      unsigned tpc, const memory_config *config,
@@ -42,7 +40,7 @@ mem_fetch::mem_fetch(const mem_access_t &access, const warp_inst_t *inst,
     : m_access(access)
 
 {
-  m_request_uid = sm_next_mf_request_uid++;
+  m_request_uid = mem_fetch_pool::next_uid(this);
   m_access = access;
   if (inst) {
     m_inst = *inst;
@@ -70,9 +68,36 @@ mem_fetch::mem_fetch(const mem_access_t &access, const warp_inst_t *inst,
     m_raw_addr.sub_partition = m_original_mf->get_tlx_addr().sub_partition;
   }
   m_is_critical = true;
+  if (m_original_mf)
+    m_is_critical = m_original_mf->is_critical();
+  else if (m_original_wr_mf)
+    m_is_critical = m_original_wr_mf->is_critical();
+  m_kernel_uid = 0;
+  if (m_original_mf)
+    m_kernel_uid = m_original_mf->get_kernel_uid();
+  else if (m_original_wr_mf)
+    m_kernel_uid = m_original_wr_mf->get_kernel_uid();
+  m_tracker = NULL;
+  m_tracker_prev = NULL;
+  m_tracker_next = NULL;
+}
+
+mem_fetch::~mem_fetch() {
+  if (m_tracker) m_tracker->erase(this);
+  m_status = MEM_FETCH_DELETED;
 }
 
-mem_fetch::~mem_fetch() { m_status = MEM_FETCH_DELETED; }
+void *mem_fetch::operator new(size_t size, mem_fetch_pool *pool) {
+  return pool->alloc(size);
+}
+
+void mem_fetch::operator delete(void *p) {
+  if (p) mem_fetch_pool::release(p);
+}
+
+void mem_fetch::operator delete(void *p, mem_fetch_pool *pool) {
+  mem_fetch_pool::release(p);
+}
 
 #define MF_TUP_BEGIN(X) static const char *Status_str[] = {
 #define MF_TUP(X) #X
@@ -140,3 +165,141 @@ unsigned mem_fetch::get_num_flits(bool simt_to_mem) {
 
   return (sz / icnt_flit_size) + ((sz % icnt_flit_size) ? 1 : 0);
 }
+
+#define MF_POOL_SLAB_SLOTS 256
+#define MF_POOL_ALIGN 16
+#define MF_POOL_ROUND(x) (((x) + MF_POOL_ALIGN - 1) & ~(size_t)(MF_POOL_ALIGN - 1))
+
+enum { MF_SLOT_FREE = 0, MF_SLOT_LIVE = 1 };
+
+mem_fetch_pool::mem_fetch_pool(const char *name, bool debug,
+                               unsigned first_uid, unsigned uid_stride) {
+  m_name = name;
+  m_debug = debug;
+  m_next_uid = first_uid;
+  m_uid_stride = uid_stride;
+  m_slot_size = MF_POOL_ROUND(sizeof(slot)) + MF_POOL_ROUND(sizeof(mem_fetch));
+  m_free = NULL;
+  m_returned = NULL;
+}
+
+mem_fetch_pool::~mem_fetch_pool() {
+  for (unsigned i = 0; i < m_slabs.size(); i++) free(m_slabs[i]);
+}
+
+mem_fetch_pool::slot *mem_fetch_pool::slot_of(void *p) {
+  return (slot *)((char *)p - MF_POOL_ROUND(sizeof(slot)));
+}
+
+void *mem_fetch_pool::object_of(slot *s) const {
+  return (char *)s + MF_POOL_ROUND(sizeof(slot));
+}
+
+void mem_fetch_pool::grow() {
+  char *slab = (char *)malloc(m_slot_size * MF_POOL_SLAB_SLOTS);
+  if (slab == NULL) {
+    fprintf(stderr, "GPGPU-Sim uArch: mem_fetch pool %s out of memory\n",
+            m_name.c_str());
+    abort();
+  }
+  m_slabs.push_back(slab);
+  // thread the new slots onto the free list in address order
+  for (int i = MF_POOL_SLAB_SLOTS - 1; i >= 0; i--) {
+    slot *s = (slot *)(slab + i * m_slot_size);
+    s->owner = this;
+    s->state = MF_SLOT_FREE;
+    s->next = m_free;
+    m_free = s;
+  }
+}
+
+void *mem_fetch_pool::alloc(size_t size) {
+  assert(size <= m_slot_size - MF_POOL_ROUND(sizeof(slot)));
+  if (m_free == NULL) {
+    // take everything other components have handed back so far
+    m_free = (slot *)__sync_lock_test_and_set(&m_returned, (slot *)NULL);
+    if (m_free == NULL) grow();
+  }
+  slot *s = m_free;
+  m_free = s->next;
+  s->next = NULL;
+  s->state = MF_SLOT_LIVE;
+  return object_of(s);
+}
+
+unsigned mem_fetch_pool::next_uid(void *p) {
+  mem_fetch_pool *pool = slot_of(p)->owner;
+  unsigned uid = pool->m_next_uid;
+  pool->m_next_uid += pool->m_uid_stride;
+  return uid;
+}
+
+void mem_fetch_pool::release(void *p) {
+  slot *s = slot_of(p);
+  mem_fetch_pool *pool = s->owner;
+  if (pool->m_debug) {
+    if (!__sync_bool_compare_and_swap(&s->state, MF_SLOT_LIVE, MF_SLOT_FREE)) {
+      fprintf(stderr,
+              "GPGPU-Sim uArch: double delete of mem_fetch %p (pool %s)\n", p,
+              pool->m_name.c_str());
+      abort();
+    }
+  } else {
+    s->state = MF_SLOT_FREE;
+  }
+  slot *head;
+  do {
+    head = pool->m_returned;
+    s->next = head;
+  } while (!__sync_bool_compare_and_swap(&pool->m_returned, head, s));
+}
+
+unsigned mem_fetch_pool::check_leaks(FILE *fp) const {
+  unsigned n_live = 0;
+  for (unsigned i = 0; i < m_slabs.size(); i++) {
+    for (unsigned j = 0; j < MF_POOL_SLAB_SLOTS; j++) {
+      slot *s = (slot *)(m_slabs[i] + j * m_slot_size);
+      if (s->state != MF_SLOT_LIVE) continue;
+      if (n_live == 0)
+        fprintf(fp, "GPGPU-Sim uArch: mem_fetch pool %s: live fetches:\n",
+                m_name.c_str());
+      ((mem_fetch *)object_of(s))->print(fp, false);
+      n_live++;
+    }
+  }
+  return n_live;
+}
+
+void mem_fetch_tracker::insert(mem_fetch *mf) {
+  if (mf->m_tracker == this) return;
+  assert(mf->m_tracker == NULL);
+  mf->m_tracker = this;
+  mf->m_tracker_prev = m_tail;
+  mf->m_tracker_next = NULL;
+  if (m_tail)
+    m_tail->m_tracker_next = mf;
+  else
+    m_head = mf;
+  m_tail = mf;
+  m_size++;
+}
+
+void mem_fetch_tracker::erase(mem_fetch *mf) {
+  if (mf == NULL || mf->m_tracker != this) return;
+  if (mf->m_tracker_prev)
+    mf->m_tracker_prev->m_tracker_next = mf->m_tracker_next;
+  else
+    m_head = mf->m_tracker_next;
+  if (mf->m_tracker_next)
+    mf->m_tracker_next->m_tracker_prev = mf->m_tracker_prev;
+  else
+    m_tail = mf->m_tracker_prev;
+  mf->m_tracker = NULL;
+  mf->m_tracker_prev = NULL;
+  mf->m_tracker_next = NULL;
+  m_size--;
+}
+
+void mem_fetch_tracker::print(FILE *fp) const {
+  for (const mem_fetch *mf = m_head; mf; mf = mf->m_tracker_next) mf->print(fp);
+}
@@ -30,6 +30,8 @@
 #define MEM_FETCH_H
 
 #include <bitset>
+#include <string>
+#include <vector>
 #include "../abstract_hardware_model.h"
 #include "addrdec.h"
 
@@ -51,8 +53,17 @@ enum mf_type {
 #undef MF_TUP_END
 
 class memory_config;
+class mem_fetch_pool;
+class mem_fetch_tracker;
+
 class mem_fetch {
  public:
+  // fetches are carved out of the slab pool of the component creating them:
+  // new (pool) mem_fetch(...).  delete returns the storage to that pool.
+  static void *operator new(size_t size, mem_fetch_pool *pool);
+  static void operator delete(void *p);
+  static void operator delete(void *p, mem_fetch_pool *pool);
+
   mem_fetch(const mem_access_t &access, const warp_inst_t *inst,
             unsigned ctrl_size, unsigned wid, unsigned sid, unsigned tpc,
             const memory_config *config, unsigned long long cycle,
@@ -120,6 +131,7 @@ class mem_fetch {
   address_type get_pc() const { return m_inst.empty() ? -1 : m_inst.pc; }
   const warp_inst_t &get_inst() { return m_inst; }
   enum mem_fetch_status get_status() const { return m_status; }
+  unsigned long long get_status_change() const { return m_status_change; }
 
   const memory_config *get_mem_config() { return m_mem_config; }
 
@@ -128,8 +140,16 @@ class mem_fetch {
   mem_fetch *get_original_mf() { return original_mf; }
   mem_fetch *get_original_wr_mf() { return original_wr_mf; }
 
-  bool is_critical() { return m_is_critical; }
-  bool set_critical(bool is_critical) { m_is_critical = is_critical; }
+  // CPL criticality of the issuing warp (see cacp.cc); fetches without a warp
+  // count as critical
+  bool is_critical() const { return m_is_critical; }
+  void set_critical(bool is_critical) { m_is_critical = is_critical; }
+
+  // uid of the kernel running on the issuing SM, set when the request enters
+  // the interconnect; 0 for requests without a kernel
+  unsigned get_kernel_uid() const { return m_kernel_uid; }
+  void set_kernel_uid(unsigned uid) { m_kernel_uid = uid; }
+
  private:
   // request source information
   unsigned m_request_uid;
@@ -165,8 +185,6 @@ class mem_fetch {
   // requesting instruction (put last so mem_fetch prints nicer in gdb)
   warp_inst_t m_inst;
 
-  static unsigned sm_next_mf_request_uid;
-
   const memory_config *m_mem_config;
   unsigned icnt_flit_size;
 
@@ -179,6 +197,84 @@ class mem_fetch {
 
   // If it is critical or not.
   bool m_is_critical;
+  unsigned m_kernel_uid;
+
+  // membership in a mem_fetch_tracker (intrusive, at most one at a time)
+  friend class mem_fetch_tracker;
+  mem_fetch_tracker *m_tracker;
+  mem_fetch *m_tracker_prev;
+  mem_fetch *m_tracker_next;
+};
+
+// Slab allocator for mem_fetch objects.  Each simt_core_cluster and each
+// memory_sub_partition owns one, so the common allocate/free pairs stay on a
+// private free list instead of going through malloc.  A fetch may be deleted
+// by a different component than the one that created it (and, with
+// -gpgpu_sim_threads, on a different thread); such frees go onto a lock-free
+// return stack that the owner drains when its private list runs dry.
+//
+// Request uids are handed out by the pool as well, first_uid, first_uid +
+// uid_stride, ...; giving every pool its own residue keeps them unique across
+// the GPU and independent of the order in which the owners run.
+//
+// With debug enabled every slot records whether it is allocated, so a double
+// delete aborts immediately and check_leaks() can list the fetches still
+// alive when the GPU goes idle.
+class mem_fetch_pool {
+ public:
+  mem_fetch_pool(const char *name, bool debug, unsigned first_uid = 1,
+                 unsigned uid_stride = 1);
+  ~mem_fetch_pool();
+
+  // owner only
+  void *alloc(size_t size);
+  static unsigned next_uid(void *p);
+  // any thread
+  static void release(void *p);
+
+  const char *name() const { return m_name.c_str(); }
+  unsigned check_leaks(FILE *fp) const;
+
+ private:
+  struct slot {
+    mem_fetch_pool *owner;
+    slot *next;
+    volatile unsigned state;
+  };
+  void grow();
+  static slot *slot_of(void *p);
+  void *object_of(slot *s) const;
+
+  std::string m_name;
+  bool m_debug;
+  size_t m_slot_size;
+  std::vector<char *> m_slabs;
+
+  unsigned m_next_uid;
+  unsigned m_uid_stride;
+
+  slot *m_free;                // private free list
+  slot *volatile m_returned;   // freed by other components / threads
+};
+
+// Set of the fetches currently inside a component (e.g. an L2 sub partition),
+// kept as an intrusive list so that insert and erase never allocate.  erase()
+// ignores fetches that are not members, and a fetch removes itself when it is
+// deleted.
+class mem_fetch_tracker {
+ public:
+  mem_fetch_tracker() : m_head(NULL), m_tail(NULL), m_size(0) {}
+
+  void insert(mem_fetch *mf);
+  void erase(mem_fetch *mf);
+  bool empty() const { return m_size == 0; }
+  unsigned size() const { return m_size; }
+  void print(FILE *fp) const;
+
+ private:
+  mem_fetch *m_head;
+  mem_fetch *m_tail;
+  unsigned m_size;
 };
 
 #endif
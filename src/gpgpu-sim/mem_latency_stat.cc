@@ -53,6 +53,9 @@ memory_stats_t::memory_stats_t(unsigned n_shader,
   assert(mem_config->m_valid);
   assert(shader_config->m_valid);
 
+  m_concurrent = false;
+  pthread_mutex_init(&m_shared_lock, NULL);
+
   unsigned i, j;
 
   concurrent_row_access =
@@ -100,6 +103,9 @@ memory_stats_t::memory_stats_t(unsigned n_shader,
   memset(icnt2mem_lat_table, 0, sizeof(unsigned) * 24);
   memset(icnt2sh_lat_table, 0, sizeof(unsigned) * 24);
   memset(mf_lat_pw_table, 0, sizeof(unsigned) * 32);
+  memset(crit_hop_tot_latency, 0, sizeof(crit_hop_tot_latency));
+  memset(crit_hop_num, 0, sizeof(crit_hop_num));
+  memset(crit_hop_max_latency, 0, sizeof(crit_hop_max_latency));
   mf_num_lat_pw = 0;
   max_warps =
       n_shader *
@@ -199,6 +205,7 @@ unsigned memory_stats_t::memlatstat_done(mem_fetch *mf) {
   mf_total_lat_table[mf->get_tlx_addr().chip][mf->get_tlx_addr().bk] +=
       mf_latency;
   if (mf_latency > max_mf_latency) max_mf_latency = mf_latency;
+  memlatstat_crit_hop(mf->is_critical(), CRIT_HOP_TOTAL, mf_latency);
   return mf_latency;
 }
 
@@ -216,12 +223,14 @@ void memory_stats_t::memlatstat_read_done(mem_fetch *mf) {
     icnt2sh_lat_table[LOGB2(icnt2sh_latency)]++;
     if (icnt2sh_latency > max_icnt2sh_latency)
       max_icnt2sh_latency = icnt2sh_latency;
+    memlatstat_crit_hop(mf->is_critical(), CRIT_HOP_ICNT2SH, icnt2sh_latency);
   }
 }
 
 void memory_stats_t::memlatstat_dram_access(mem_fetch *mf) {
   unsigned dram_id = mf->get_tlx_addr().chip;
   unsigned bank = mf->get_tlx_addr().bk;
+  lock_shared();
   if (m_memory_config->gpgpu_memlatency_stat) {
     if (mf->get_is_write()) {
       if (mf->get_sid() < m_n_shader) {  // do not count L2_writebacks here
@@ -243,6 +252,7 @@ void memory_stats_t::memlatstat_dram_access(mem_fetch *mf) {
   if (mf->get_pc() != (unsigned)-1)
     m_gpu->gpgpu_ctx->stats->ptx_file_line_stats_add_dram_traffic(
         mf->get_pc(), mf->get_data_size());
+  unlock_shared();
 }
 
 void memory_stats_t::memlatstat_icnt2mem_pop(mem_fetch *mf) {
@@ -254,9 +264,23 @@ void memory_stats_t::memlatstat_icnt2mem_pop(mem_fetch *mf) {
     icnt2mem_lat_table[LOGB2(icnt2mem_latency)]++;
     if (icnt2mem_latency > max_icnt2mem_latency)
       max_icnt2mem_latency = icnt2mem_latency;
+    memlatstat_crit_hop(mf->is_critical(), CRIT_HOP_ICNT2MEM,
+                        icnt2mem_latency);
   }
 }
 
+// called from the memory partitions as well, hence the lock
+void memory_stats_t::memlatstat_crit_hop(bool critical, enum mem_crit_hop hop,
+                                         unsigned latency) {
+  if (!m_memory_config->gpgpu_memlatency_stat) return;
+  lock_shared();
+  crit_hop_tot_latency[critical][hop] += latency;
+  crit_hop_num[critical][hop]++;
+  if (latency > crit_hop_max_latency[critical][hop])
+    crit_hop_max_latency[critical][hop] = latency;
+  unlock_shared();
+}
+
 void memory_stats_t::memlatstat_lat_pw() {
   if (mf_num_lat_pw && m_memory_config->gpgpu_memlatency_stat) {
     assert(mf_tot_lat_pw);
@@ -318,6 +342,19 @@ void memory_stats_t::memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk) {
     }
     printf("\n");
 
+    static const char *crit_hop_name[NUM_CRIT_HOPS] = {
+        "icnt2mem", "l2_queue", "mrq", "icnt2sh", "total"};
+    for (int c = 1; c >= 0; c--) {
+      printf("%s_latency (avg/max/num):", c ? "critical" : "noncritical");
+      for (j = 0; j < NUM_CRIT_HOPS; j++) {
+        unsigned long long n = crit_hop_num[c][j];
+        printf(" %s = %llu/%u/%llu", crit_hop_name[j],
+               n ? crit_hop_tot_latency[c][j] / n : 0,
+               crit_hop_max_latency[c][j], n);
+      }
+      printf("\n");
+    }
+
     /*MAXIMUM CONCURRENT ACCESSES TO SAME ROW*/
     printf("maximum concurrent accesses to same row:\n");
     for (i = 0; i < n_mem; i++) {
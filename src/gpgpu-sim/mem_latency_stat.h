@@ -29,11 +29,23 @@
 #ifndef MEM_LATENCY_STAT_H
 #define MEM_LATENCY_STAT_H
 
+#include <pthread.h>
 #include <stdio.h>
 #include <zlib.h>
 #include <map>
 
 class memory_config;
+
+// points along the memory path where latency is split by CPL criticality
+enum mem_crit_hop {
+  CRIT_HOP_ICNT2MEM = 0,  // issue to arrival at the memory partition
+  CRIT_HOP_L2_QUEUE,      // waiting in the icnt-to-L2 queue
+  CRIT_HOP_MRQ,           // waiting in the DRAM scheduler
+  CRIT_HOP_ICNT2SH,       // reply network
+  CRIT_HOP_TOTAL,         // issue to reply
+  NUM_CRIT_HOPS
+};
+
 class memory_stats_t {
  public:
   memory_stats_t(unsigned n_shader,
@@ -44,6 +56,8 @@ class memory_stats_t {
   void memlatstat_read_done(class mem_fetch *mf);
   void memlatstat_dram_access(class mem_fetch *mf);
   void memlatstat_icnt2mem_pop(class mem_fetch *mf);
+  void memlatstat_crit_hop(bool critical, enum mem_crit_hop hop,
+                           unsigned latency);
   void memlatstat_lat_pw();
   void memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk);
 
@@ -52,6 +66,18 @@ class memory_stats_t {
   // Reset local L2 stats that are aggregated each sampling window
   void clear_L2_stats_pw();
 
+  // DRAM channels are ticked concurrently when -gpgpu_sim_threads > 1; the
+  // chip-wide counters they update are then serialized through m_shared_lock.
+  // All such updates are sums or maxima, so the totals do not depend on the
+  // order in which the channels get the lock.
+  void set_concurrent(bool concurrent) { m_concurrent = concurrent; }
+  void lock_shared() {
+    if (m_concurrent) pthread_mutex_lock(&m_shared_lock);
+  }
+  void unlock_shared() {
+    if (m_concurrent) pthread_mutex_unlock(&m_shared_lock);
+  }
+
   unsigned m_n_shader;
 
   const shader_core_config *m_shader_config;
@@ -74,6 +100,10 @@ class memory_stats_t {
   unsigned icnt2sh_lat_table[24];
   unsigned mf_lat_pw_table[32];  // table storing values of mf latency Per
                                  // Window
+  // per hop latency of [non-critical, critical] requests
+  unsigned long long crit_hop_tot_latency[2][NUM_CRIT_HOPS];
+  unsigned long long crit_hop_num[2][NUM_CRIT_HOPS];
+  unsigned crit_hop_max_latency[2][NUM_CRIT_HOPS];
   unsigned mf_num_lat_pw;
   unsigned max_warps;
   unsigned mf_tot_lat_pw;  // total latency summed up per window. divide by
@@ -123,6 +153,10 @@ class memory_stats_t {
   unsigned total_n_access;
   unsigned total_n_reads;
   unsigned total_n_writes;
+
+ private:
+  bool m_concurrent;
+  pthread_mutex_t m_shared_lock;
 };
 
 #endif /*MEM_LATENCY_STAT_H*/
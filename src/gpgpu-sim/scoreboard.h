@@ -28,7 +28,6 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <set>
 #include <vector>
 #include "assert.h"
 
@@ -51,16 +50,54 @@ class Scoreboard {
   const bool islongop(unsigned warp_id, unsigned regnum);
 
  private:
+  // Pending registers of one warp as a bitset over register numbers.  The
+  // words grow on demand since PTX register numbers are assigned per program
+  // and are not bounded by the per-thread register count of the kernel.
+  class reg_bitset {
+   public:
+    reg_bitset() : m_count(0) {}
+    bool test(unsigned reg) const {
+      unsigned w = reg / 64;
+      return w < m_words.size() && ((m_words[w] >> (reg % 64)) & 1);
+    }
+    // returns false if the bit was already set
+    bool set(unsigned reg) {
+      unsigned w = reg / 64;
+      if (w >= m_words.size()) m_words.resize(w + 1, 0);
+      unsigned long long bit = 1ULL << (reg % 64);
+      if (m_words[w] & bit) return false;
+      m_words[w] |= bit;
+      m_count++;
+      return true;
+    }
+    // returns false if the bit was not set
+    bool reset(unsigned reg) {
+      if (!test(reg)) return false;
+      m_words[reg / 64] &= ~(1ULL << (reg % 64));
+      m_count--;
+      return true;
+    }
+    unsigned long long word(unsigned w) const {
+      return w < m_words.size() ? m_words[w] : 0;
+    }
+    unsigned num_words() const { return m_words.size(); }
+    bool empty() const { return m_count == 0; }
+
+   private:
+    std::vector<unsigned long long> m_words;
+    unsigned m_count;
+  };
+
   void reserveRegister(unsigned wid, unsigned regnum);
   int get_sid() const { return m_sid; }
 
   unsigned m_sid;
 
   // keeps track of pending writes to registers
-  // indexed by warp id, reg_id => pending write count
-  std::vector<std::set<unsigned> > reg_table;
+  // indexed by warp id, reg_id => pending write
+  std::vector<reg_bitset> reg_table;
   // Register that depend on a long operation (global, local or tex memory)
-  std::vector<std::set<unsigned> > longopregs;
+  std::vector<reg_bitset> longopregs;
 
   class gpgpu_t *m_gpu;
 };
@@ -56,9 +56,9 @@ mem_fetch *shader_core_mem_fetch_allocator::alloc(
     new_addr_type addr, mem_access_type type, unsigned size, bool wr,
     unsigned long long cycle) const {
   mem_access_t access(type, addr, size, wr, m_memory_config->gpgpu_ctx);
-  mem_fetch *mf =
-      new mem_fetch(access, NULL, wr ? WRITE_PACKET_SIZE : READ_PACKET_SIZE, -1,
-                    m_core_id, m_cluster_id, m_memory_config, cycle);
+  mem_fetch *mf = new (m_pool)
+      mem_fetch(access, NULL, wr ? WRITE_PACKET_SIZE : READ_PACKET_SIZE, -1,
+                m_core_id, m_cluster_id, m_memory_config, cycle);
   return mf;
 }
 /////////////////////////////////////////////////////////////////////////////
@@ -146,7 +146,8 @@ void shader_core_ctx::create_front_pipeline() {
     m_icnt = new shader_memory_interface(this, m_cluster);
   }
   m_mem_fetch_allocator =
-      new shader_core_mem_fetch_allocator(m_sid, m_tpc, m_memory_config);
+      new shader_core_mem_fetch_allocator(m_sid, m_tpc, m_memory_config,
+                                          m_cluster->get_mf_pool());
 
   // fetch
   m_last_warp_fetched = 0;
@@ -490,9 +491,15 @@ shader_core_ctx::shader_core_ctx(class gpgpu_sim *gpu,
   m_stats = stats;
   unsigned warp_size = config->warp_size;
   Issue_Prio = 0;
+  m_stalled_on_memory = false;
+  m_cpl_range_valid = false;
+  m_cpl_min = 0;
+  m_cpl_max = 0;
+  m_cpl_range_cycle = 0;
 
   m_sid = shader_id;
   m_tpc = tpc_id;
+  m_n_issued_warp_insts = 0;
 
   m_last_inst_gpu_sim_cycle = 0;
   m_last_inst_gpu_tot_sim_cycle = 0;
@@ -508,6 +515,7 @@ shader_core_ctx::shader_core_ctx(class gpgpu_sim *gpu,
 
 void shader_core_ctx::reinit(unsigned start_thread, unsigned end_thread,
                              bool reset_not_completed) {
+  m_stalled_on_memory = false;
   if (reset_not_completed) {
     m_not_completed = 0;
     m_active_threads.reset();
@@ -531,6 +539,7 @@ void shader_core_ctx::reinit(unsigned start_thread, unsigned end_thread,
     m_simt_stack[i]->reset();
     m_stats->cpl_warp_cta_cycle_dist[m_sid][i] = 0;
   }
+  m_cpl_range_valid = false;
 }
 
 void shader_core_ctx::init_warps(unsigned cta_id, unsigned start_thread,
@@ -730,25 +739,40 @@ void shader_core_stats::print(FILE *fout) const {
           gpu_reg_bank_conflict_stalls);
 
   fprintf(fout, "Warp Occupancy Distribution:\n");
-  fprintf(fout, "Stall:%d\t", shader_cycle_distro[2]);
-  fprintf(fout, "W0_Idle:%d\t", shader_cycle_distro[0]);
-  fprintf(fout, "W0_Scoreboard:%d", shader_cycle_distro[1]);
+  fprintf(fout, "Stall:%d\t", cycle_distro(2));
+  fprintf(fout, "W0_Idle:%d\t", cycle_distro(0));
+  fprintf(fout, "W0_Scoreboard:%d", cycle_distro(1));
   for (unsigned i = 3; i < m_config->warp_size + 3; i++)
-    fprintf(fout, "\tW%d:%d", i - 2, shader_cycle_distro[i]);
+    fprintf(fout, "\tW%d:%d", i - 2, cycle_distro(i));
   fprintf(fout, "\n");
   fprintf(fout, "single_issue_nums: ");
-  for (unsigned i = 0; i < m_config->gpgpu_num_sched_per_core; i++)
-    fprintf(fout, "WS%d:%d\t", i, single_issue_nums[i]);
+  for (unsigned i = 0; i < m_config->gpgpu_num_sched_per_core; i++) {
+    unsigned n = 0;
+    for (unsigned sid = 0; sid < m_config->num_shader(); sid++)
+      n += single_issue_nums[sid][i];
+    fprintf(fout, "WS%d:%d\t", i, n);
+  }
   fprintf(fout, "\n");
   fprintf(fout, "dual_issue_nums: ");
-  for (unsigned i = 0; i < m_config->gpgpu_num_sched_per_core; i++)
-    fprintf(fout, "WS%d:%d\t", i, dual_issue_nums[i]);
+  for (unsigned i = 0; i < m_config->gpgpu_num_sched_per_core; i++) {
+    unsigned n = 0;
+    for (unsigned sid = 0; sid < m_config->num_shader(); sid++)
+      n += dual_issue_nums[sid][i];
+    fprintf(fout, "WS%d:%d\t", i, n);
+  }
   fprintf(fout, "\n");
 
   m_outgoing_traffic_stats->print(fout);
   m_incoming_traffic_stats->print(fout);
 }
 
+unsigned shader_core_stats::cycle_distro(unsigned bucket) const {
+  unsigned n = 0;
+  for (unsigned sid = 0; sid < m_config->num_shader(); sid++)
+    n += shader_cycle_distro[sid][bucket];
+  return n;
+}
+
 void shader_core_stats::event_warp_issued(unsigned s_id, unsigned warp_id,
                                           unsigned num_issued,
                                           unsigned dynamic_warp_id) {
@@ -772,21 +796,21 @@ void shader_core_stats::visualizer_print(gzFile visualizer_file) {
   unsigned int cf =
       (m_config->gpgpu_warpdistro_shader == -1) ? m_config->num_shader() : 1;
   gzprintf(visualizer_file, " %d",
-           (shader_cycle_distro[0] - last_shader_cycle_distro[0]) / cf);
+           (cycle_distro(0) - last_shader_cycle_distro[0]) / cf);
   gzprintf(visualizer_file, " %d",
-           (shader_cycle_distro[1] - last_shader_cycle_distro[1]) / cf);
+           (cycle_distro(1) - last_shader_cycle_distro[1]) / cf);
   gzprintf(visualizer_file, " %d",
-           (shader_cycle_distro[2] - last_shader_cycle_distro[2]) / cf);
+           (cycle_distro(2) - last_shader_cycle_distro[2]) / cf);
   for (unsigned i = 0; i < m_config->warp_size + 3; i++) {
     if (i >= 3) {
-      total += (shader_cycle_distro[i] - last_shader_cycle_distro[i]);
+      total += (cycle_distro(i) - last_shader_cycle_distro[i]);
       if (((i - 3) % (m_config->warp_size / 8)) ==
           ((m_config->warp_size / 8) - 1)) {
         gzprintf(visualizer_file, " %d", total / cf);
         total = 0;
       }
     }
-    last_shader_cycle_distro[i] = shader_cycle_distro[i];
+    last_shader_cycle_distro[i] = cycle_distro(i);
   }
   gzprintf(visualizer_file, "\n");
 
@@ -991,7 +1015,7 @@ void shader_core_ctx::fetch() {
           // TODO: replace with use of allocator
           // mem_fetch *mf = m_mem_fetch_allocator->alloc()
           mem_access_t acc(INST_ACC_R, ppc, nbytes, false, m_gpu->gpgpu_ctx);
-          mem_fetch *mf = new mem_fetch(
+          mem_fetch *mf = new (m_mem_fetch_allocator->get_pool()) mem_fetch(
               acc, NULL /*we don't have an instruction yet*/, READ_PACKET_SIZE,
               warp_id, m_sid, m_tpc, m_memory_config,
               m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle);
@@ -1046,11 +1070,12 @@ void shader_core_ctx::issue_warp(register_set &pipe_reg_set,
   m_warp[warp_id]->ibuffer_free();
   assert(next_inst->valid());
   **pipe_reg = *next_inst;  // static instruction information
+  unsigned uid = ++m_n_issued_warp_insts * m_config->num_shader() + m_sid;
   (*pipe_reg)->issue(active_mask, warp_id,
                      m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle,
-                     m_warp[warp_id]->get_dynamic_warp_id(),
-                     sch_id);  // dynamic instruction information
-  m_stats->shader_cycle_distro[2 + (*pipe_reg)->active_count()]++;
+                     m_warp[warp_id]->get_dynamic_warp_id(), sch_id,
+                     uid);  // dynamic instruction information
+  m_stats->shader_cycle_distro[m_sid][2 + (*pipe_reg)->active_count()]++;
   func_exec_inst(**pipe_reg);
 
   assert(warp_id < m_config->max_warps_per_shader);
@@ -1462,9 +1487,9 @@ void scheduler_unit::cycle() {
       }
 
       if (issued == 1)
-        m_stats->single_issue_nums[m_id]++;
+        m_stats->single_issue_nums[get_sid()][m_id]++;
       else if (issued > 1)
-        m_stats->dual_issue_nums[m_id]++;
+        m_stats->dual_issue_nums[get_sid()][m_id]++;
       else
         abort();  // issued should be > 0
 
@@ -1474,12 +1499,52 @@ void scheduler_unit::cycle() {
 
   // issue stall statistics:
   if (!valid_inst)
-    m_stats->shader_cycle_distro[0]++;  // idle or control hazard
+    m_stats->shader_cycle_distro[get_sid()][0]++;  // idle or control hazard
   else if (!ready_inst)
-    m_stats->shader_cycle_distro[1]++;  // waiting for RAW hazards (possibly due
-                                        // to memory)
+    m_stats->shader_cycle_distro[get_sid()][1]++;  // waiting for RAW hazards
+                                                   // (possibly due to memory)
   else if (!issued_inst)
-    m_stats->shader_cycle_distro[2]++;  // pipeline stalled
+    m_stats->shader_cycle_distro[get_sid()][2]++;  // pipeline stalled
+}
+
+// Mirrors the checks of cycle() without acting on them: any warp that cycle()
+// would issue, flush, or otherwise update makes the scheduler non-stalled.
+bool scheduler_unit::stalled_on_memory(unsigned &distro_slot) {
+  bool valid_inst = false;
+
+  order_warps();
+  for (std::vector<shd_warp_t *>::const_iterator iter =
+           m_next_cycle_prioritized_warps.begin();
+       iter != m_next_cycle_prioritized_warps.end(); iter++) {
+    if ((*iter) == NULL || (*iter)->done_exit()) continue;
+    unsigned warp_id = (*iter)->get_warp_id();
+
+    // shd_warp_t::waiting(), minus the release of a completed membar
+    if (warp(warp_id).functional_done() ||
+        m_shader->warp_waiting_at_barrier(warp_id))
+      continue;
+    if (warp(warp_id).get_membar()) {
+      if (!m_scoreboard->pendingWrites(warp_id)) return false;
+      continue;
+    }
+    if (warp(warp_id).get_n_atomic() > 0) continue;
+
+    if (warp(warp_id).ibuffer_empty()) continue;
+    const warp_inst_t *pI = warp(warp_id).ibuffer_next_inst();
+    if (pI == NULL) {
+      if (warp(warp_id).ibuffer_next_valid()) return false;
+      continue;
+    }
+    if (pI->m_is_cdp && warp(warp_id).m_cdp_latency > 0) return false;
+    unsigned pc, rpc;
+    m_shader->get_pdom_stack_top_info(warp_id, pI, &pc, &rpc);
+    if (pc != pI->pc) return false;
+    valid_inst = true;
+    if (!m_scoreboard->checkCollision(warp_id, pI)) return false;
+  }
+
+  distro_slot = valid_inst ? 1 : 0;
+  return true;
 }
 
 void scheduler_unit::do_on_warp_issued(
@@ -1784,7 +1849,7 @@ void shader_core_ctx::warp_inst_complete(const warp_inst_t &inst) {
     m_stats->m_num_sim_insn[m_sid] += inst.active_count();
 
   m_stats->m_num_sim_winsn[m_sid]++;
-  m_gpu->gpu_sim_insn += inst.active_count();
+  m_cluster->add_sim_insn(inst.active_count());
   inst.completed(m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle);
 }
 
@@ -1828,8 +1893,7 @@ void shader_core_ctx::writeback() {
 	m_warp[warp_id]->cpl_warp_complete();
 
     warp_inst_complete(*pipe_reg);
-    m_gpu->gpu_sim_insn_last_update_sid = m_sid;
-    m_gpu->gpu_sim_insn_last_update = m_gpu->gpu_sim_cycle;
+    m_cluster->set_last_insn_sid(m_sid);
     m_last_inst_gpu_sim_cycle = m_gpu->gpu_sim_cycle;
     m_last_inst_gpu_tot_sim_cycle = m_gpu->gpu_tot_sim_cycle;
     pipe_reg->clear();
@@ -1932,6 +1996,7 @@ mem_stage_stall_type ldst_unit::process_memory_access_queue_l1cache(
           m_mf_allocator->alloc(inst, inst.accessq_back(),
                                 m_core->get_gpu()->gpu_sim_cycle +
                                     m_core->get_gpu()->gpu_tot_sim_cycle);
+      mf->set_critical(m_core->get_warp_criticality(mf->get_wid()));
       unsigned bank_id = m_config->m_L1D_config.set_bank(mf->get_addr());
       assert(bank_id < m_config->m_L1D_config.l1_banks);
 
@@ -1965,6 +2030,7 @@ mem_stage_stall_type ldst_unit::process_memory_access_queue_l1cache(
         m_mf_allocator->alloc(inst, inst.accessq_back(),
                               m_core->get_gpu()->gpu_sim_cycle +
                                   m_core->get_gpu()->gpu_tot_sim_cycle);
+    mf->set_critical(m_core->get_warp_criticality(mf->get_wid()));
     std::list<cache_event> events;
     enum cache_request_status status = cache->access(
         mf->get_addr(), mf,
@@ -2065,9 +2131,9 @@ bool ldst_unit::constant_cycle(warp_inst_t &inst, mem_stage_stall_type &rc_fail,
     rc_fail = fail;  // keep other fails if this didn't fail.
     fail_type = C_MEM;
     if (rc_fail == BK_CONF or rc_fail == COAL_STALL) {
-      m_stats->gpgpu_n_cmem_portconflict++;  // coal stalls aren't really a bank
-                                             // conflict, but this maintains
-                                             // previous behavior.
+      // coal stalls aren't really a bank conflict, but this maintains
+      // previous behavior.  Shared by the clusters, hence atomic.
+      __sync_fetch_and_add(&m_stats->gpgpu_n_cmem_portconflict, 1);
     }
   }
   return inst.accessq_empty();  // done if empty.
@@ -2119,6 +2185,7 @@ bool ldst_unit::memory_cycle(warp_inst_t &inst,
           m_mf_allocator->alloc(inst, access,
                                 m_core->get_gpu()->gpu_sim_cycle +
                                     m_core->get_gpu()->gpu_tot_sim_cycle);
+      mf->set_critical(m_core->get_warp_criticality(mf->get_wid()));
       m_icnt->push(mf);
       inst.accessq_pop_back();
       // inst.clear_active( access.get_warp_mask() );
@@ -2150,6 +2217,24 @@ bool ldst_unit::response_buffer_full() const {
   return m_response_fifo.size() >= m_config->ldst_unit_response_queue_size;
 }
 
+// Requests that have already left for the memory system (L1 MSHRs, miss
+// queues) do not count: they can only come back through fill().
+bool ldst_unit::idle() const {
+  if (!m_dispatch_reg->empty() || !m_next_wb.empty() || m_next_global ||
+      !m_response_fifo.empty())
+    return false;
+  for (unsigned stage = 0; stage < m_pipeline_depth; stage++)
+    if (!m_pipeline_reg[stage]->empty()) return false;
+  if (m_L1T->access_ready() || m_L1C->access_ready()) return false;
+  if (m_L1D) {
+    if (m_L1D->access_ready()) return false;
+    for (unsigned j = 0; j < l1_latency_queue.size(); j++)
+      for (unsigned k = 0; k < l1_latency_queue[j].size(); k++)
+        if (l1_latency_queue[j][k]) return false;
+  }
+  return true;
+}
+
 void ldst_unit::fill(mem_fetch *mf) {
   mf->set_status(
       IN_SHADER_LDST_RESPONSE_FIFO,
@@ -2703,8 +2788,10 @@ void ldst_unit::cycle() {
 
   if (!done) {  // log stall types and return
     assert(rc_fail != NO_RC_FAIL);
-    m_stats->gpgpu_n_stall_shd_mem++;
-    m_stats->gpu_stall_shd_mem_breakdown[type][rc_fail]++;
+    // shared by the clusters, hence atomic
+    __sync_fetch_and_add(&m_stats->gpgpu_n_stall_shd_mem, 1);
+    __sync_fetch_and_add(&m_stats->gpu_stall_shd_mem_breakdown[type][rc_fail],
+                         1);
     return;
   }
 
@@ -2760,12 +2847,8 @@ void shader_core_ctx::register_cta_thread_exit(unsigned cta_num,
   assert(m_cta_status[cta_num] > 0);
   m_cta_status[cta_num]--;
   if (!m_cta_status[cta_num]) {
-    // Increment the completed CTAs
-    m_stats->ctas_completed++;
-    m_gpu->inc_completed_cta();
     m_n_active_cta--;
     m_barriers.deallocate_barrier(cta_num);
-    shader_CTA_count_unlog(m_sid, 1);
 
     SHADER_DPRINTF(
         LIVENESS,
@@ -2789,17 +2872,29 @@ void shader_core_ctx::register_cta_thread_exit(unsigned cta_num,
 
     // Jin: for concurrent kernels on sm
     release_shader_resource_1block(cta_num, *kernel);
-    kernel->dec_running();
-    if (!m_gpu->kernel_more_cta_left(kernel)) {
-      if (!kernel->running()) {
-        SHADER_DPRINTF(LIVENESS,
-                       "GPGPU-Sim uArch: GPU detected kernel %u \'%s\' "
-                       "finished on shader %u.\n",
-                       kernel->get_uid(), kernel->name().c_str(), m_sid);
-
-        if (m_kernel == kernel) m_kernel = NULL;
-        m_gpu->set_kernel_done(kernel);
-      }
+    m_cluster->defer_cta_exit(this, kernel);
+  }
+}
+
+// The kernel and the GPU-wide counters are shared with the other clusters.
+// Nothing later in the cycle of this core looks at m_kernel, so clearing it
+// here rather than in register_cta_thread_exit() makes no difference.
+void shader_core_ctx::commit_cta_exit(kernel_info_t *kernel) {
+  // Increment the completed CTAs
+  m_stats->ctas_completed++;
+  m_gpu->inc_completed_cta();
+  shader_CTA_count_unlog(m_sid, 1);
+
+  kernel->dec_running();
+  if (!m_gpu->kernel_more_cta_left(kernel)) {
+    if (!kernel->running()) {
+      SHADER_DPRINTF(LIVENESS,
+                     "GPGPU-Sim uArch: GPU detected kernel %u \'%s\' "
+                     "finished on shader %u.\n",
+                     kernel->get_uid(), kernel->name().c_str(), m_sid);
+
+      if (m_kernel == kernel) m_kernel = NULL;
+      m_gpu->set_kernel_done(kernel);
     }
   }
 }
@@ -3431,6 +3526,10 @@ void shader_core_ctx::cycle() {
   if (!isactive() && get_not_completed() == 0) return;
 
   m_stats->shader_cycles[m_sid]++;
+  if (m_stalled_on_memory) {
+    stalled_cycle();
+    return;
+  }
   writeback();
   execute();
   read_operands();
@@ -3439,13 +3538,67 @@ void shader_core_ctx::cycle() {
     decode();
     fetch();
   }
+  if (m_config->gpgpu_stall_fast_forward)
+    m_stalled_on_memory = stalled_on_memory();
+}
+
+bool shader_core_ctx::stalled_on_memory() {
+  // nothing in flight between the schedulers and writeback
+  for (unsigned i = 0; i < m_pipeline_reg.size(); i++)
+    if (m_pipeline_reg[i].has_ready()) return false;
+  for (unsigned n = 0; n < m_num_function_units; n++)
+    if (!m_fu[n]->idle()) return false;
+  if (!m_operand_collector.idle()) return false;
+
+  // fetch() and decode() have nothing to do
+  if (m_inst_fetch_buffer.m_valid || m_L1I->access_ready()) return false;
+  for (unsigned w = 0; w < m_config->max_warps_per_shader; w++) {
+    if (m_warp[w]->hardware_done() && !m_scoreboard->pendingWrites(w) &&
+        !m_warp[w]->done_exit())
+      return false;
+    if (!m_warp[w]->functional_done() && !m_warp[w]->imiss_pending() &&
+        m_warp[w]->ibuffer_empty())
+      return false;
+  }
+
+  // the skipped scheduler cycles would not show up in the trace
+  if (SHADER_DTRACE(WARP_SCHEDULER)) return false;
+  m_stalled_distro_slot.resize(schedulers.size());
+  for (unsigned i = 0; i < schedulers.size(); i++)
+    if (!schedulers[i]->stalled_on_memory(m_stalled_distro_slot[i]))
+      return false;
+  return true;
+}
+
+// Equivalent to cycle() for a core that passed stalled_on_memory(): the
+// pipeline registers are empty, so writeback() and execute() only age the
+// duty cycle, result bus, cache port and miss queue state, while the
+// schedulers and fetch() would only charge their stall statistics.
+// execute() also steps the operand collector from ldst_unit::cycle(), so its
+// bank arbiter keeps rotating m_last_cu exactly as in cycle().
+void shader_core_ctx::stalled_cycle() {
+  writeback();
+  execute();
+  read_operands();
+  calc_shader_cpl(m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle);
+  for (unsigned i = 0; i < schedulers.size(); i++)
+    m_stats->shader_cycle_distro[m_sid][m_stalled_distro_slot[i]]++;
+  Issue_Prio = (Issue_Prio + 1) % schedulers.size();
+  for (unsigned i = 0; i < m_config->inst_fetch_throughput; ++i)
+    m_L1I->cycle();
 }
 
 // Flushes all content of the cache to memory
 
-void shader_core_ctx::cache_flush() { m_ldst_unit->flush(); }
+void shader_core_ctx::cache_flush() {
+  m_stalled_on_memory = false;
+  m_ldst_unit->flush();
+}
 
-void shader_core_ctx::cache_invalidate() { m_ldst_unit->invalidate(); }
+void shader_core_ctx::cache_invalidate() {
+  m_stalled_on_memory = false;
+  m_ldst_unit->invalidate();
+}
 
 // modifiers
 std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() {
@@ -3785,6 +3938,7 @@ void shader_core_ctx::broadcast_barrier_reduction(unsigned cta_id,
 bool shader_core_ctx::fetch_unit_response_buffer_full() const { return false; }
 
 void shader_core_ctx::accept_fetch_response(mem_fetch *mf) {
+  m_stalled_on_memory = false;
   mf->set_status(IN_SHADER_FETCHED,
                  m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
   m_L1I->fill(mf, m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
@@ -3795,6 +3949,7 @@ bool shader_core_ctx::ldst_unit_response_buffer_full() const {
 }
 
 void shader_core_ctx::accept_ldst_unit_response(mem_fetch *mf) {
+  m_stalled_on_memory = false;
   m_ldst_unit->fill(mf);
 }
 
@@ -4201,6 +4356,17 @@ simt_core_cluster::simt_core_cluster(class gpgpu_sim *gpu, unsigned cluster_id,
   m_stats = stats;
   m_memory_stats = mstats;
   m_mem_config = mem_config;
+
+  char pool_name[32];
+  snprintf(pool_name, 32, "cluster_%03d", m_cluster_id);
+  // clusters and sub partitions interleave their request uids
+  m_mf_pool = new mem_fetch_pool(
+      pool_name, m_mem_config->m_mf_pool_debug, 1 + m_cluster_id,
+      m_config->n_simt_clusters + m_mem_config->m_n_mem_sub_partition);
+
+  m_icnt_request_flits = 0;
+  m_sim_insn = 0;
+  m_last_insn_sid = -1;
 }
 
 void simt_core_cluster::core_cycle() {
@@ -4215,6 +4381,25 @@ void simt_core_cluster::core_cycle() {
   }
 }
 
+void simt_core_cluster::commit_cycle() {
+  for (unsigned i = 0; i < m_icnt_requests.size(); i++)
+    icnt_push_request_packet(m_icnt_requests[i]);
+  m_icnt_requests.clear();
+  m_icnt_request_flits = 0;
+
+  m_gpu->gpu_sim_insn += m_sim_insn;
+  m_sim_insn = 0;
+  if (m_last_insn_sid != (unsigned)-1) {
+    m_gpu->gpu_sim_insn_last_update_sid = m_last_insn_sid;
+    m_gpu->gpu_sim_insn_last_update = m_gpu->gpu_sim_cycle;
+    m_last_insn_sid = -1;
+  }
+
+  for (unsigned i = 0; i < m_cta_exits.size(); i++)
+    m_cta_exits[i].first->commit_cta_exit(m_cta_exits[i].second);
+  m_cta_exits.clear();
+}
+
 void simt_core_cluster::reinit() {
   for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++)
     m_core[i]->reinit(0, m_config->n_thread_per_shader, true);
@@ -4314,10 +4499,21 @@ void simt_core_cluster::cache_invalidate() {
 bool simt_core_cluster::icnt_injection_buffer_full(unsigned size, bool write) {
   unsigned request_size = size;
   if (!write) request_size = READ_PACKET_SIZE;
-  return !::icnt_has_buffer(m_cluster_id, request_size);
+  return !::icnt_has_buffer(m_cluster_id, request_size, m_icnt_requests.size(),
+                            m_icnt_request_flits);
 }
 
+// The request enters the interconnect in commit_cycle(); until then it holds
+// the buffer space it will take there.
 void simt_core_cluster::icnt_inject_request_packet(class mem_fetch *mf) {
+  unsigned packet_size = mf->size();
+  if (!mf->get_is_write() && !mf->isatomic()) packet_size = mf->get_ctrl_size();
+  unsigned flit_size = ::icnt_get_flit_size();
+  m_icnt_requests.push_back(mf);
+  m_icnt_request_flits += (packet_size + flit_size - 1) / flit_size;
+}
+
+void simt_core_cluster::icnt_push_request_packet(class mem_fetch *mf) {
   // stats
   if (mf->get_is_write())
     m_stats->made_write_mfs++;
@@ -407,6 +407,12 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
   // list.
   void cycle();
 
+  // Returns true if cycle() would neither issue nor modify any warp, i.e.
+  // every candidate warp is blocked on the scoreboard, a barrier or an
+  // outstanding memory operation.  distro_slot is set to the
+  // shader_cycle_distro bucket cycle() charges in that case.
+  virtual bool stalled_on_memory(unsigned &distro_slot);
+
   // These are some common ordering fucntions that the
   // higher order schedulers can take advantage of
   template <typename T>
@@ -561,6 +567,9 @@ class two_level_active_scheduler : public scheduler_unit {
   }
   virtual ~two_level_active_scheduler() {}
   virtual void order_warps();
+  // order_warps() migrates warps between the active and pending sets every
+  // cycle, so idle cycles cannot be collapsed
+  virtual bool stalled_on_memory(unsigned &distro_slot) { return false; }
   void add_supervised_warp_id(int i) {
     if (m_next_cycle_prioritized_warps.size() < m_max_active_warps) {
       m_next_cycle_prioritized_warps.push_back(&warp(i));
@@ -605,6 +614,32 @@ class swl_scheduler : public scheduler_unit {
   unsigned m_num_warps_to_limit;
 };
 
+// Orders the warps of a criticality-aware scheduler exactly like a selection
+// sort by decreasing CPL (ties broken by dynamic warp id, exited and waiting
+// warps last).  CPL is recomputed for every warp each cycle, so the keys are
+// captured once per call and the issuable warps are re-sorted starting from
+// the previous cycle's order, which is linear while the ranking is stable.
+class cpl_warp_order {
+ public:
+  cpl_warp_order() : m_stamp(0) {}
+  void sort(std::vector<shd_warp_t *> &warps);
+
+ private:
+  struct key {
+    bool idle;
+    float cpl;
+    unsigned dynamic_warp_id;
+  };
+  bool before(unsigned lhs, unsigned rhs) const;
+  void selection_sort(std::vector<shd_warp_t *> &warps) const;
+
+  std::vector<key> m_keys;          // indexed by warp id
+  std::vector<unsigned> m_pos;      // position in the output, by warp id
+  std::vector<unsigned> m_in_list;  // stamp of the last sort a warp was in
+  std::vector<unsigned> m_sorted;   // issuable warp ids, most critical first
+  unsigned m_stamp;
+};
+
 class caws_scheduler : public scheduler_unit {
 public:
   caws_scheduler(shader_core_stats *stats, shader_core_ctx *shader,
@@ -629,6 +664,7 @@ public:
 private:
   int m_count;
   int m_flag;
+  cpl_warp_order m_cpl_order;
 };
 
 class gcaws_scheduler : public scheduler_unit {
@@ -655,6 +691,7 @@ public:
 private:
   int m_count;
   int m_flag;
+  cpl_warp_order m_cpl_order;
 };
 
 class opndcoll_rfu_t {  // operand collector based register file unit
@@ -682,6 +719,13 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     process_banks();
   }
 
+  // true if no collector unit holds an instruction
+  bool idle() const {
+    for (unsigned n = 0; n < m_cu.size(); n++)
+      if (!m_cu[n]->is_free()) return false;
+    return true;
+  }
+
   void dump(FILE *fp) const {
     fprintf(fp, "\n");
     fprintf(fp, "Operand Collector State:\n");
@@ -1150,6 +1194,8 @@ class simd_function_unit {
     return m_dispatch_reg->empty() && !occupied.test(inst.latency);
   }
   virtual bool stallable() const = 0;
+  // true if the unit holds no instruction
+  virtual bool idle() const { return m_dispatch_reg->empty(); }
   virtual void print(FILE *fp) const {
     fprintf(fp, "%s dispatch= ", m_name.c_str());
     m_dispatch_reg->print(fp);
@@ -1189,6 +1235,9 @@ class pipelined_simd_unit : public simd_function_unit {
   virtual bool can_issue(const warp_inst_t &inst) const {
     return simd_function_unit::can_issue(inst);
   }
+  virtual bool idle() const {
+    return simd_function_unit::idle() && active_insts_in_pipeline == 0;
+  }
   virtual void print(FILE *fp) const {
     simd_function_unit::print(fp);
     for (int s = m_pipeline_depth - 1; s >= 0; s--) {
@@ -1387,6 +1436,7 @@ class ldst_unit : public pipelined_simd_unit {
 
   virtual void active_lanes_in_pipeline();
   virtual bool stallable() const { return true; }
+  virtual bool idle() const;
   bool response_buffer_full() const;
   void print(FILE *fout) const;
   void print_cache_stats(FILE *fp, unsigned &dl1_accesses,
@@ -1630,6 +1680,9 @@ class shader_core_config : public core_config {
 
   // on = use cacp; off = no cacp
   bool enable_cacp_l1_cache;
+  // cycles between reclassifications of warp criticality (0 = whenever the
+  // CPLs change)
+  unsigned cacp_criticality_epoch;
 
   // op collector
   bool enable_specialized_operand_collector;
@@ -1698,6 +1751,7 @@ class shader_core_config : public core_config {
   bool perfect_inst_const_cache;
   unsigned inst_fetch_throughput;
   unsigned reg_file_port_throughput;
+  bool gpgpu_stall_fast_forward;
 
   // specialized unit config strings
   char *specialized_unit_string[SPECIALIZED_UNIT_NUM];
@@ -1766,12 +1820,15 @@ struct shader_core_stats_pod {
   unsigned gpu_stall_shd_mem_breakdown[N_MEM_STAGE_ACCESS_TYPE]
                                       [N_MEM_STAGE_STALL_TYPE];
   unsigned gpu_reg_bank_conflict_stalls;
-  unsigned *shader_cycle_distro;
+  // [sid][bucket]: kept per shader, like the scheduler counters below, so
+  // that clusters ticked on different threads never share a counter; the
+  // printed figures are the sums over all shaders
+  unsigned **shader_cycle_distro;
   unsigned *last_shader_cycle_distro;
   unsigned *num_warps_issuable;
   unsigned gpgpu_n_stall_shd_mem;
-  unsigned *single_issue_nums;
-  unsigned *dual_issue_nums;
+  unsigned **single_issue_nums;  // [sid][scheduler]
+  unsigned **dual_issue_nums;    // [sid][scheduler]
 
   unsigned ctas_completed;
   // memory access classification
@@ -1879,13 +1936,21 @@ class shader_core_stats : public shader_core_stats_pod {
         (unsigned *)calloc(config->num_shader(), sizeof(unsigned));
     m_n_diverge = (unsigned *)calloc(config->num_shader(), sizeof(unsigned));
     shader_cycle_distro =
-        (unsigned *)calloc(config->warp_size + 3, sizeof(unsigned));
-    last_shader_cycle_distro =
-        (unsigned *)calloc(m_config->warp_size + 3, sizeof(unsigned));
+        (unsigned **)calloc(config->num_shader(), sizeof(unsigned *));
     single_issue_nums =
-        (unsigned *)calloc(config->gpgpu_num_sched_per_core, sizeof(unsigned));
+        (unsigned **)calloc(config->num_shader(), sizeof(unsigned *));
     dual_issue_nums =
-        (unsigned *)calloc(config->gpgpu_num_sched_per_core, sizeof(unsigned));
+        (unsigned **)calloc(config->num_shader(), sizeof(unsigned *));
+    for (unsigned i = 0; i < config->num_shader(); ++i) {
+      shader_cycle_distro[i] =
+          (unsigned *)calloc(config->warp_size + 3, sizeof(unsigned));
+      single_issue_nums[i] = (unsigned *)calloc(
+          config->gpgpu_num_sched_per_core, sizeof(unsigned));
+      dual_issue_nums[i] = (unsigned *)calloc(config->gpgpu_num_sched_per_core,
+                                              sizeof(unsigned));
+    }
+    last_shader_cycle_distro =
+        (unsigned *)calloc(m_config->warp_size + 3, sizeof(unsigned));
 
     ctas_completed = 0;
     n_simt_to_mem = (long *)calloc(config->num_shader(), sizeof(long));
@@ -1917,7 +1982,14 @@ class shader_core_stats : public shader_core_stats_pod {
     free(m_num_sim_insn);
     free(m_num_sim_winsn);
     free(m_n_diverge);
+    for (unsigned i = 0; i < m_config->num_shader(); ++i) {
+      free(shader_cycle_distro[i]);
+      free(single_issue_nums[i]);
+      free(dual_issue_nums[i]);
+    }
     free(shader_cycle_distro);
+    free(single_issue_nums);
+    free(dual_issue_nums);
     free(last_shader_cycle_distro);
   }
 
@@ -1929,6 +2001,8 @@ class shader_core_stats : public shader_core_stats_pod {
   void visualizer_print(gzFile visualizer_file);
 
   void print(FILE *fout) const;
+  // shader_cycle_distro[*][bucket] summed over the shaders
+  unsigned cycle_distro(unsigned bucket) const;
 
   const std::vector<std::vector<unsigned>> &get_dynamic_warp_issue() const {
     return m_shader_dynamic_warp_issue_distro;
@@ -1973,27 +2047,31 @@ class memory_config;
 class shader_core_mem_fetch_allocator : public mem_fetch_allocator {
  public:
   shader_core_mem_fetch_allocator(unsigned core_id, unsigned cluster_id,
-                                  const memory_config *config) {
+                                  const memory_config *config,
+                                  mem_fetch_pool *pool) {
     m_core_id = core_id;
     m_cluster_id = cluster_id;
     m_memory_config = config;
+    m_pool = pool;
   }
   mem_fetch *alloc(new_addr_type addr, mem_access_type type, unsigned size,
                    bool wr, unsigned long long cycle) const;
   mem_fetch *alloc(const warp_inst_t &inst, const mem_access_t &access,
                    unsigned long long cycle) const {
     warp_inst_t inst_copy = inst;
-    mem_fetch *mf = new mem_fetch(
+    mem_fetch *mf = new (m_pool) mem_fetch(
         access, &inst_copy,
         access.is_write() ? WRITE_PACKET_SIZE : READ_PACKET_SIZE,
         inst.warp_id(), m_core_id, m_cluster_id, m_memory_config, cycle);
     return mf;
   }
+  mem_fetch_pool *get_pool() const { return m_pool; }
 
  private:
   unsigned m_core_id;
   unsigned m_cluster_id;
   const memory_config *m_memory_config;
+  mem_fetch_pool *m_pool;
 };
 
 class shader_core_ctx : public core_t {
@@ -2080,6 +2158,7 @@ class shader_core_ctx : public core_t {
   void get_icnt_power_stats(long &n_simt_to_mem, long &n_mem_to_simt) const;
 
   void print_cacp_stats() const;
+  float get_warp_cpl(unsigned warp_id) const;
 
   // debug:
   void display_simt_state(FILE *fout, int mask) const;
@@ -2238,6 +2317,8 @@ class shader_core_ctx : public core_t {
     m_stats->n_simt_to_mem[m_sid] += n_flits;
   }
   bool check_if_non_released_reduction_barrier(warp_inst_t &inst);
+  // the GPU-wide part of a CTA exit, run from simt_core_cluster::commit_cycle()
+  void commit_cta_exit(kernel_info_t *kernel);
 
  protected:
   unsigned inactive_lanes_accesses_sfu(unsigned active_count, double latency) {
@@ -2259,6 +2340,23 @@ class shader_core_ctx : public core_t {
 
   void issue();
 
+  // -gpgpu_stall_fast_forward: once every warp is blocked on memory and
+  // nothing is left behind the schedulers, cycle() only ticks the state that
+  // still advances (caches, CPL counters, stall statistics) until a memory
+  // response or a new CTA wakes the core up.  Only the core pipeline is
+  // skipped: gpu_sim_cycle and the memory side still step every cycle.
+  bool stalled_on_memory();
+  void stalled_cycle();
+  bool m_stalled_on_memory;
+  std::vector<unsigned> m_stalled_distro_slot;  // per scheduler
+
+  // CPL range used to classify warp criticality for CACP.  It is rebuilt on
+  // the first query after the CPLs changed (or after the refresh epoch).
+  bool m_cpl_range_valid;
+  float m_cpl_min;
+  float m_cpl_max;
+  unsigned long long m_cpl_range_cycle;
+
   friend class scheduler_unit;  // this is needed to use private issue warp.
   friend class TwoLevelScheduler;
   friend class LooseRoundRobbinScheduler;
@@ -2386,6 +2484,9 @@ class shader_core_ctx : public core_t {
   // is that the dynamic_warp_id is a running number unique to every warp
   // run on this shader, where the warp_id is the static warp slot.
   unsigned m_dynamic_warp_id;
+  // Warp instructions issued by this shader; their uids are interleaved
+  // across shaders so they stay unique without a GPU-wide counter.
+  unsigned m_n_issued_warp_insts;
 
   // Jin: concurrent kernels on a sm
  public:
@@ -2443,14 +2544,29 @@ class simt_core_cluster {
                     memory_stats_t *mstats);
 
   void core_cycle();
+  // Applies what the cores of the cluster left for the rest of the GPU during
+  // core_cycle(): the interconnect requests, the committed instruction count
+  // and the finished CTAs.  Apart from the functional global memory,
+  // core_cycle() only touches the cluster's own state, so the clusters can be
+  // ticked concurrently (-gpgpu_sim_parallel_clusters); commit_cycle() is then
+  // called for each of them in cluster order.
+  void commit_cycle();
   void icnt_cycle();
 
+  // called by the cores during core_cycle()
+  void add_sim_insn(unsigned n) { m_sim_insn += n; }
+  void set_last_insn_sid(unsigned sid) { m_last_insn_sid = sid; }
+  void defer_cta_exit(shader_core_ctx *core, kernel_info_t *kernel) {
+    m_cta_exits.push_back(std::make_pair(core, kernel));
+  }
+
   void reinit();
   unsigned issue_block2core();
   void cache_flush();
   void cache_invalidate();
   bool icnt_injection_buffer_full(unsigned size, bool write);
   void icnt_inject_request_packet(class mem_fetch *mf);
+  void icnt_push_request_packet(class mem_fetch *mf);
 
   // for perfect memory interface
   bool response_queue_full() {
@@ -2468,6 +2584,7 @@ class simt_core_cluster {
   unsigned get_n_active_cta() const;
   unsigned get_n_active_sms() const;
   gpgpu_sim *get_gpu() { return m_gpu; }
+  mem_fetch_pool *get_mf_pool() const { return m_mf_pool; }
 
   void display_pipeline(unsigned sid, FILE *fout, int print_mem, int mask);
   void print_cache_stats(FILE *fp, unsigned &dl1_accesses,
@@ -2485,6 +2602,7 @@ class simt_core_cluster {
   virtual void create_shader_core_ctx() = 0;
 
   void print_cacp_stats() const;
+  float get_warp_cpl(unsigned cid, unsigned warp_id) const;
  protected:
   unsigned m_cluster_id;
   gpgpu_sim *m_gpu;
@@ -2493,10 +2611,18 @@ class simt_core_cluster {
   memory_stats_t *m_memory_stats;
   shader_core_ctx **m_core;
   const memory_config *m_mem_config;
+  mem_fetch_pool *m_mf_pool;  // shared by all cores in the cluster
 
   unsigned m_cta_issue_next_core;
   std::list<unsigned> m_core_sim_order;
   std::list<mem_fetch *> m_response_fifo;
+
+  // left by core_cycle() for commit_cycle()
+  std::vector<mem_fetch *> m_icnt_requests;
+  unsigned m_icnt_request_flits;
+  unsigned m_sim_insn;
+  unsigned m_last_insn_sid;  // -1 if no instruction was written back
+  std::vector<std::pair<shader_core_ctx *, kernel_info_t *> > m_cta_exits;
 };
 
 class exec_simt_core_cluster : public simt_core_cluster {
@@ -2524,6 +2650,8 @@ class shader_memory_interface : public mem_fetch_interface {
   }
   virtual void push(mem_fetch *mf) {
     m_core->inc_simt_to_mem(mf->get_num_flits(true));
+    if (m_core->get_kernel())
+      mf->set_kernel_uid(m_core->get_kernel()->get_uid());
     m_cluster->icnt_inject_request_packet(mf);
   }
 
@@ -0,0 +1,120 @@
+// Persistent worker pool used to tick independent simulator components
+// concurrently within a clock domain: the memory partitions and L2
+// sub-partitions, the SIMT core clusters with -gpgpu_sim_parallel_clusters,
+// and the routers and channels of the intersim2 networks.
+
+#include "thread_pool.h"
+
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Phases are only a few microseconds long, so workers and the caller poll for
+// a while before falling back to sleeping on a condition variable.  Polling
+// yields the CPU so an oversubscribed host still makes progress.
+#define POOL_SPIN_COUNT 64
+
+sim_thread_pool::sim_thread_pool(unsigned n_threads) {
+  m_task = NULL;
+  m_n = 0;
+  m_next = 0;
+  m_generation = 0;
+  m_busy = 0;
+  m_shutdown = false;
+  pthread_mutex_init(&m_lock, NULL);
+  pthread_cond_init(&m_start_cond, NULL);
+  pthread_cond_init(&m_done_cond, NULL);
+
+  if (n_threads <= 1) return;
+  m_workers.resize(n_threads - 1);
+  for (unsigned t = 0; t < m_workers.size(); t++) {
+    if (pthread_create(&m_workers[t], NULL, worker_main, this) != 0) {
+      fprintf(stderr, "GPGPU-Sim uArch: unable to create worker thread %u\n",
+              t);
+      abort();
+    }
+  }
+}
+
+sim_thread_pool::~sim_thread_pool() {
+  pthread_mutex_lock(&m_lock);
+  m_shutdown = true;
+  pthread_cond_broadcast(&m_start_cond);
+  pthread_mutex_unlock(&m_lock);
+  for (unsigned t = 0; t < m_workers.size(); t++)
+    pthread_join(m_workers[t], NULL);
+  pthread_cond_destroy(&m_done_cond);
+  pthread_cond_destroy(&m_start_cond);
+  pthread_mutex_destroy(&m_lock);
+}
+
+void sim_thread_pool::run(parallel_task &task, unsigned n) {
+  if (m_workers.empty()) {
+    for (unsigned i = 0; i < n; i++) task.run(i);
+    return;
+  }
+  if (n == 0) return;
+
+  pthread_mutex_lock(&m_lock);
+  assert(m_busy == 0);
+  m_task = &task;
+  m_n = n;
+  m_next = 0;
+  m_busy = m_workers.size();
+  __sync_add_and_fetch(&m_generation, 1);
+  pthread_cond_broadcast(&m_start_cond);
+  pthread_mutex_unlock(&m_lock);
+
+  drain();
+
+  // barrier: no worker may still be inside the task once we return
+  for (unsigned spin = 0; m_busy && spin < POOL_SPIN_COUNT; spin++)
+    sched_yield();
+  if (m_busy) {
+    pthread_mutex_lock(&m_lock);
+    while (m_busy) pthread_cond_wait(&m_done_cond, &m_lock);
+    pthread_mutex_unlock(&m_lock);
+  }
+  __sync_synchronize();
+  m_task = NULL;
+}
+
+void *sim_thread_pool::worker_main(void *arg) {
+  ((sim_thread_pool *)arg)->worker_loop();
+  return NULL;
+}
+
+void sim_thread_pool::worker_loop() {
+  unsigned seen = 0;
+  while (true) {
+    for (unsigned spin = 0;
+         m_generation == seen && !m_shutdown && spin < POOL_SPIN_COUNT; spin++)
+      sched_yield();
+    if (m_generation == seen) {
+      pthread_mutex_lock(&m_lock);
+      while (m_generation == seen && !m_shutdown)
+        pthread_cond_wait(&m_start_cond, &m_lock);
+      pthread_mutex_unlock(&m_lock);
+    }
+    if (m_generation == seen) break;  // shutdown with no pending phase
+    __sync_synchronize();
+    seen = m_generation;
+
+    drain();
+
+    if (__sync_sub_and_fetch(&m_busy, 1) == 0) {
+      pthread_mutex_lock(&m_lock);
+      pthread_cond_signal(&m_done_cond);
+      pthread_mutex_unlock(&m_lock);
+    }
+  }
+}
+
+void sim_thread_pool::drain() {
+  while (true) {
+    unsigned i = __sync_fetch_and_add(&m_next, 1);
+    if (i >= m_n) break;
+    m_task->run(i);
+  }
+}
@@ -0,0 +1,63 @@
+// Persistent worker pool used to tick independent simulator components
+// concurrently within a clock domain: the memory partitions and L2
+// sub-partitions, the SIMT core clusters with -gpgpu_sim_parallel_clusters,
+// and the routers and channels of the intersim2 networks.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <vector>
+
+// A unit of work applied to every index of a parallel phase.
+class parallel_task {
+ public:
+  virtual ~parallel_task() {}
+  virtual void run(unsigned i) = 0;
+};
+
+// Adapts a member function taking the component index into a parallel_task.
+template <class T, void (T::*F)(unsigned)>
+class member_task : public parallel_task {
+ public:
+  member_task(T *obj) : m_obj(obj) {}
+  virtual void run(unsigned i) { (m_obj->*F)(i); }
+
+ private:
+  T *m_obj;
+};
+
+// run() is a barrier: it returns only after the task has been applied to all
+// indices, so each call behaves as one clock-domain phase.  Indices are handed
+// out dynamically; callers must only submit tasks whose per-index work is
+// independent so that the result does not depend on the assignment.
+// A pool of one thread has no workers and runs every phase on the caller.
+class sim_thread_pool {
+ public:
+  sim_thread_pool(unsigned n_threads);
+  ~sim_thread_pool();
+
+  unsigned num_threads() const { return m_workers.size() + 1; }
+  void run(parallel_task &task, unsigned n);
+
+ private:
+  static void *worker_main(void *arg);
+  void worker_loop();
+  void drain();
+
+  std::vector<pthread_t> m_workers;
+
+  pthread_mutex_t m_lock;
+  pthread_cond_t m_start_cond;
+  pthread_cond_t m_done_cond;
+
+  // current phase; written by run() before m_generation is bumped
+  parallel_task *m_task;
+  unsigned m_n;
+  volatile unsigned m_next;
+  volatile unsigned m_generation;
+  volatile unsigned m_busy;
+  volatile bool m_shutdown;
+};
+
+#endif
@@ -83,9 +83,8 @@ void *gpgpu_sim_thread_concurrent(void *ctx_ptr) {
           "work ***\n");
       fflush(stdout);
     }
-    while (ctx->the_gpgpusim->g_stream_manager->empty_protected() &&
-           !ctx->the_gpgpusim->g_sim_done)
-      ;
+    ctx->the_gpgpusim->g_stream_manager->work_signal()
+        .wait<GPGPUsim_ctx, &GPGPUsim_ctx::sim_has_work>(ctx->the_gpgpusim);
     if (g_debug_execution >= 3) {
       printf("GPGPU-Sim: ** START simulation thread (detected work) **\n");
       ctx->the_gpgpusim->g_stream_manager->print(stdout);
@@ -151,6 +150,7 @@ void *gpgpu_sim_thread_concurrent(void *ctx_ptr) {
     pthread_mutex_lock(&(ctx->the_gpgpusim->g_sim_lock));
     ctx->the_gpgpusim->g_sim_active = false;
     pthread_mutex_unlock(&(ctx->the_gpgpusim->g_sim_lock));
+    ctx->the_gpgpusim->g_stream_manager->progress_signal().notify();
   } while (!ctx->the_gpgpusim->g_sim_done);
 
   printf("GPGPU-Sim: *** simulation thread exiting ***\n");
@@ -167,19 +167,24 @@ void *gpgpu_sim_thread_concurrent(void *ctx_ptr) {
   return NULL;
 }
 
+bool GPGPUsim_ctx::sim_has_work() {
+  return !g_stream_manager->empty_protected() || g_sim_done;
+}
+
+bool GPGPUsim_ctx::sim_idle() {
+  pthread_mutex_lock(&g_sim_lock);
+  bool idle = (g_stream_manager->empty() && !g_sim_active) || g_sim_done;
+  pthread_mutex_unlock(&g_sim_lock);
+  return idle;
+}
+
 void gpgpu_context::synchronize() {
   printf("GPGPU-Sim: synchronize waiting for inactive GPU simulation\n");
   the_gpgpusim->g_stream_manager->print(stdout);
   fflush(stdout);
   //    sem_wait(&g_sim_signal_finish);
-  bool done = false;
-  do {
-    pthread_mutex_lock(&(the_gpgpusim->g_sim_lock));
-    done = (the_gpgpusim->g_stream_manager->empty() &&
-            !the_gpgpusim->g_sim_active) ||
-           the_gpgpusim->g_sim_done;
-    pthread_mutex_unlock(&(the_gpgpusim->g_sim_lock));
-  } while (!done);
+  the_gpgpusim->g_stream_manager->progress_signal()
+      .wait<GPGPUsim_ctx, &GPGPUsim_ctx::sim_idle>(the_gpgpusim);
   printf("GPGPU-Sim: detected inactive GPU simulation thread\n");
   fflush(stdout);
   //    sem_post(&g_sim_signal_start);
@@ -187,6 +192,8 @@ void gpgpu_context::synchronize() {
 
 void gpgpu_context::exit_simulation() {
   the_gpgpusim->g_sim_done = true;
+  if (the_gpgpusim->g_stream_manager)
+    the_gpgpusim->g_stream_manager->work_signal().notify();
   printf("GPGPU-Sim: exit_simulation called\n");
   fflush(stdout);
   sem_wait(&(the_gpgpusim->g_sim_signal_exit));
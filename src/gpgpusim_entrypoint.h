@@ -53,6 +53,10 @@ class GPGPUsim_ctx {
     gpgpu_ctx = ctx;
   }
 
+  // conditions the simulation and host threads block on
+  bool sim_has_work();
+  bool sim_idle();
+
   // struct gpgpu_ptx_sim_arg *grid_params;
 
   sem_t g_sim_signal_start;
@@ -30,11 +30,13 @@
  *A class for credits
  */
 
+#include <cassert>
+
 #include "booksim.hpp"
 #include "credit.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+vector<Credit::_Pool> Credit::_pools;
+bool Credit::_concurrent = false;
 
 Credit::Credit()
 {
@@ -49,31 +51,68 @@ void Credit::Reset()
   id   = -1;
 }
 
-Credit * Credit::New() {
+void Credit::_Lock( _Pool & pool ) {
+  if(_concurrent) {
+    while(__sync_lock_test_and_set(&pool.lock, 1)) {
+      while(pool.lock) {}
+    }
+  }
+}
+
+void Credit::_Unlock( _Pool & pool ) {
+  if(_concurrent) {
+    __sync_lock_release(&pool.lock);
+  }
+}
+
+void Credit::SetSubnets( int subnets ) {
+  if((int)_pools.size() < subnets) {
+    _pools.resize(subnets);
+  }
+}
+
+Credit * Credit::New( int subnet ) {
+  assert((subnet >= 0) && (subnet < (int)_pools.size()));
+  _Pool & pool = _pools[subnet];
   Credit * c;
-  if(_free.empty()) {
+  _Lock(pool);
+  if(pool.free.empty()) {
     c = new Credit();
-    _all.push(c);
+    pool.all.push(c);
+    _Unlock(pool);
   } else {
-    c = _free.top();
+    c = pool.free.top();
+    pool.free.pop();
+    _Unlock(pool);
     c->Reset();
-    _free.pop();
   }
+  c->_subnet = subnet;
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  _Pool & pool = _pools[_subnet];
+  _Lock(pool);
+  pool.free.push(this);
+  _Unlock(pool);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  for(size_t subnet = 0; subnet < _pools.size(); ++subnet) {
+    _Pool & pool = _pools[subnet];
+    while(!pool.all.empty()) {
+      delete pool.all.top();
+      pool.all.pop();
+    }
+    pool.free = stack<Credit *>();
   }
 }
 
 
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  int outstanding = 0;
+  for(size_t subnet = 0; subnet < _pools.size(); ++subnet) {
+    outstanding += _pools[subnet].all.size() - _pools[subnet].free.size();
+  }
+  return outstanding;
 }
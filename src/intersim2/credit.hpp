@@ -30,6 +30,7 @@
 
 #include <set>
 #include <stack>
+#include <vector>
 
 class Credit {
 
@@ -43,14 +44,32 @@ public:
 
   void Reset();
   
-  static Credit * New();
+  // Each subnet allocates from its own pool; a credit goes back to the pool
+  // it came from.
+  static void SetSubnets( int subnets );
+  static Credit * New( int subnet );
   void Free();
   static void FreeAll();
   static int OutStanding();
+
+  // routers allocate and free credits while being evaluated; set when the
+  // network is stepped on more than one thread
+  static void SetConcurrent(bool concurrent) { _concurrent = concurrent; }
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  int _subnet;
+
+  struct _Pool {
+    _Pool() : lock(0) {}
+    stack<Credit *> all;
+    stack<Credit *> free;
+    volatile int lock;
+  };
+  static vector<_Pool> _pools;
+  static bool _concurrent;
+
+  static void _Lock( _Pool & pool );
+  static void _Unlock( _Pool & pool );
 
   Credit();
   ~Credit() {}
@@ -34,11 +34,12 @@
  *When adding objects make sure to set a default value in this constructor
  */
 
+#include <cassert>
+
 #include "booksim.hpp"
 #include "flit.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+vector<Flit::_Pool> Flit::_pools;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -82,26 +83,39 @@ void Flit::Reset()
   data = 0;
 }  
 
-Flit * Flit::New() {
+void Flit::SetSubnets( int subnets ) {
+  if((int)_pools.size() < subnets) {
+    _pools.resize(subnets);
+  }
+}
+
+Flit * Flit::New( int subnet ) {
+  assert((subnet >= 0) && (subnet < (int)_pools.size()));
+  _Pool & pool = _pools[subnet];
   Flit * f;
-  if(_free.empty()) {
+  if(pool.free.empty()) {
     f = new Flit;
-    _all.push(f);
+    pool.all.push(f);
   } else {
-    f = _free.top();
+    f = pool.free.top();
     f->Reset();
-    _free.pop();
+    pool.free.pop();
   }
+  f->subnetwork = subnet;
   return f;
 }
 
 void Flit::Free() {
-  _free.push(this);
+  _pools[subnetwork].free.push(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  for(size_t subnet = 0; subnet < _pools.size(); ++subnet) {
+    _Pool & pool = _pools[subnet];
+    while(!pool.all.empty()) {
+      delete pool.all.top();
+      pool.all.pop();
+    }
+    pool.free = stack<Flit *>();
   }
 }
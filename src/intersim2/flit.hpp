@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <stack>
+#include <vector>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
@@ -77,7 +78,7 @@ public:
   // phase in multi-phase algorithms
   mutable int ph;
 
-  // Fields for arbitrary data
+  // Fields for arbitrary data; only the head flit of a packet carries it
   void* data ;
 
   // Lookahead route info
@@ -85,7 +86,10 @@ public:
 
   void Reset();
 
-  static Flit * New();
+  // Each subnet allocates from its own pool; a flit goes back to the pool
+  // of its subnetwork.
+  static void SetSubnets( int subnets );
+  static Flit * New( int subnet );
   void Free();
   static void FreeAll();
 
@@ -94,8 +98,11 @@ private:
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  struct _Pool {
+    stack<Flit *> all;
+    stack<Flit *> free;
+  };
+  static vector<_Pool> _pools;
 
 };
 
@@ -32,6 +32,9 @@
 #include "gputrafficmanager.hpp"
 #include "interconnect_interface.hpp"
 #include "globals.hpp"
+#ifdef CREATE_LIBRARY
+#include "thread_pool.h"
+#endif
 
 
 GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<Network *> &net)
@@ -47,10 +50,99 @@ GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<
       _input_queue[subnet][node].resize(_classes);
     }
   }
+
+  _pool = NULL;
+  _read_inputs_task = NULL;
+  _evaluate_task = NULL;
+  _write_outputs_task = NULL;
 }
 
 GPUTrafficManager::~GPUTrafficManager()
 {
+#ifdef CREATE_LIBRARY
+  delete _read_inputs_task;
+  delete _evaluate_task;
+  delete _write_outputs_task;
+#endif
+}
+
+void GPUTrafficManager::SetThreadPool( sim_thread_pool * pool )
+{
+#ifdef CREATE_LIBRARY
+  _pool = pool;
+  if(_pool && !_read_inputs_task) {
+    _read_inputs_task = new member_task<GPUTrafficManager, &GPUTrafficManager::_ReadInputsChunk>(this);
+    _evaluate_task = new member_task<GPUTrafficManager, &GPUTrafficManager::_EvaluateChunk>(this);
+    _write_outputs_task = new member_task<GPUTrafficManager, &GPUTrafficManager::_WriteOutputsChunk>(this);
+  }
+#else
+  assert(!pool);
+#endif
+}
+
+void GPUTrafficManager::_StepNetworks( NetworkPhase phase )
+{
+#ifdef CREATE_LIBRARY
+  if(_pool) {
+    parallel_task * task = NULL;
+    switch(phase) {
+    case ReadInputsPhase:
+      // The modules picked for this cycle change with the traffic, so cut
+      // them anew. Routers cost far more than channels and come last in
+      // each list; cutting finer than the thread count lets the pool
+      // balance the chunks dynamically.
+      _net_chunks.clear();
+      for(int subnet = 0; subnet < _subnets; ++subnet) {
+        _net[subnet]->BeginStep( );
+        int const modules = _net[subnet]->NumStepModules();
+        int const chunks = min<int>(modules, 4 * _pool->num_threads());
+        for(int c = 0; c < chunks; ++c) {
+          NetworkChunk chunk;
+          chunk.subnet = subnet;
+          chunk.first = (long long)modules * c / chunks;
+          chunk.last = (long long)modules * (c + 1) / chunks;
+          _net_chunks.push_back(chunk);
+        }
+      }
+      task = _read_inputs_task;
+      break;
+    case EvaluatePhase: task = _evaluate_task; break;
+    case WriteOutputsPhase: task = _write_outputs_task; break;
+    }
+    _pool->run(*task, _net_chunks.size());
+    if(phase == WriteOutputsPhase) {
+      for(int subnet = 0; subnet < _subnets; ++subnet) {
+        _net[subnet]->EndStep( );
+      }
+    }
+    return;
+  }
+#endif
+  for(int subnet = 0; subnet < _subnets; ++subnet) {
+    switch(phase) {
+    case ReadInputsPhase: _net[subnet]->ReadInputs( ); break;
+    case EvaluatePhase: _net[subnet]->Evaluate( ); break;
+    case WriteOutputsPhase: _net[subnet]->WriteOutputs( ); break;
+    }
+  }
+}
+
+void GPUTrafficManager::_ReadInputsChunk( unsigned chunk )
+{
+  NetworkChunk const & c = _net_chunks[chunk];
+  _net[c.subnet]->ReadInputs(c.first, c.last);
+}
+
+void GPUTrafficManager::_EvaluateChunk( unsigned chunk )
+{
+  NetworkChunk const & c = _net_chunks[chunk];
+  _net[c.subnet]->Evaluate(c.first, c.last);
+}
+
+void GPUTrafficManager::_WriteOutputsChunk( unsigned chunk )
+{
+  NetworkChunk const & c = _net_chunks[chunk];
+  _net[c.subnet]->WriteOutputs(c.first, c.last);
 }
 
 void GPUTrafficManager::Init()
@@ -265,7 +357,7 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
   }
   
   for ( int i = 0; i < size; ++i ) {
-    Flit * f  = Flit::New();
+    Flit * f  = Flit::New(subnetwork);
     f->id     = _cur_id++;
     assert(_cur_id);
     f->pid    = pid;
@@ -275,7 +367,6 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
     f->ctime  = time;
     f->record = record;
     f->cl     = cl;
-    f->data = data;
     
     _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
     if(record) {
@@ -291,6 +382,8 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
       f->head = true;
       //packets are only generated to nodes smaller or equal to limit
       f->dest = packet_destination;
+      // the boundary buffer takes the payload from the head flit only
+      f->data = data;
     } else {
       f->head = false;
       f->dest = -1;
@@ -399,8 +492,10 @@ void GPUTrafficManager::_Step()
         c->Free();
       }
     }
-    _net[subnet]->ReadInputs( );
   }
+  // Ejection above only touches the subnet's own boundary channels, so the
+  // networks can read their inputs together once every subnet is drained.
+  _StepNetworks(ReadInputsPhase);
 
 // GPGPUSim will generate/inject packets from interconnection interface
 #if 0
@@ -649,7 +744,7 @@ void GPUTrafficManager::_Step()
           << " into subnet " << subnet
           << "." << endl;
         }
-        Credit * const c = Credit::New();
+        Credit * const c = Credit::New(subnet);
         c->vc.insert(f->vc);
         _net[subnet]->WriteCredit(c, n);
         
@@ -661,10 +756,10 @@ void GPUTrafficManager::_Step()
       }
     }
     flits[subnet].clear();
-    // _InteralStep here
-    _net[subnet]->Evaluate( );
-    _net[subnet]->WriteOutputs( );
   }
+  // _InteralStep here
+  _StepNetworks(EvaluatePhase);
+  _StepNetworks(WriteOutputsPhase);
   
   ++_time;
   assert(_time);
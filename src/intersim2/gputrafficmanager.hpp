@@ -39,6 +39,9 @@
 #include "booksim_config.hpp"
 #include "flit.hpp"
 
+class sim_thread_pool;
+class parallel_task;
+
 class GPUTrafficManager : public TrafficManager {
   
 protected:
@@ -49,6 +52,26 @@ protected:
   
   // record size of _partial_packets for each subnet
   vector<vector<vector<list<Flit *> > > > _input_queue;
+
+  // Network phases of all subnets. With a worker pool attached the modules
+  // each subnet steps this cycle are cut into chunks that run concurrently;
+  // the phases themselves stay in order, so results match the serial step.
+  enum NetworkPhase { ReadInputsPhase, EvaluatePhase, WriteOutputsPhase };
+  void _StepNetworks( NetworkPhase phase );
+  void _ReadInputsChunk( unsigned chunk );
+  void _EvaluateChunk( unsigned chunk );
+  void _WriteOutputsChunk( unsigned chunk );
+
+  struct NetworkChunk {
+    int subnet;
+    int first;
+    int last;
+  };
+  sim_thread_pool * _pool;
+  vector<NetworkChunk> _net_chunks;
+  parallel_task * _read_inputs_task;
+  parallel_task * _evaluate_task;
+  parallel_task * _write_outputs_task;
   
 public:
   
@@ -57,6 +80,9 @@ public:
   
   // correspond to TrafficManger::Run/SingleSim
   void Init();
+
+  // step the networks on the given pool (NULL steps them on the caller)
+  void SetThreadPool( sim_thread_pool * pool );
   
   // TODO: if it is not good...
   friend class InterconnectInterface;
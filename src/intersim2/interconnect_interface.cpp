@@ -45,6 +45,7 @@
 #include "intersim_config.hpp"
 #include "network.hpp"
 #include "trace.h"
+#include "thread_pool.h"
 
 InterconnectInterface* InterconnectInterface::New(const char* const config_file)
 {
@@ -61,7 +62,8 @@ InterconnectInterface* InterconnectInterface::New(const char* const config_file)
 
 InterconnectInterface::InterconnectInterface()
 {
-
+  _traffic_manager = NULL;
+  _pool = NULL;
 }
 
 InterconnectInterface::~InterconnectInterface()
@@ -77,6 +79,8 @@ InterconnectInterface::~InterconnectInterface()
 
   delete _traffic_manager;
   _traffic_manager = NULL;
+  delete _pool;
+  Credit::SetConcurrent(false);
   delete _icnt_config;
 }
 
@@ -135,6 +139,48 @@ void InterconnectInterface::CreateInterconnect(unsigned n_shader, unsigned n_mem
 
   _CreateBuffer();
   _CreateNodeMap(_n_shader, _n_mem, _traffic_manager->_nodes, _icnt_config->GetInt("use_map"));
+
+  int n_threads = _icnt_config->GetInt("network_threads");
+  if (n_threads > 1 && !_DeterministicRouters()) {
+    cout << "Interconnect: routing, allocation or watch/activity output "
+         << "depends on evaluation order, ignoring network_threads = "
+         << n_threads << endl;
+    n_threads = 1;
+  }
+  if (n_threads > 1) {
+    _pool = new sim_thread_pool(n_threads);
+    Credit::SetConcurrent(true);
+    _traffic_manager->SetThreadPool(_pool);
+  }
+}
+
+// Routers may only be stepped concurrently when nothing they do during a
+// phase draws from the global RNG or writes to a shared stream; otherwise the
+// results would depend on the thread interleaving.
+bool InterconnectInterface::_DeterministicRouters() const
+{
+  static const char * const deterministic_rf[] = {
+    "dest_tag_fly", "dim_order_mesh", "dor_mesh", "dim_order_ni_mesh",
+    "dor_cmesh", "dor_no_express_cmesh", "min_anynet", "ran_min_flatfly"
+  };
+  string const rf = _icnt_config->GetStr("routing_function") + "_" + _icnt_config->GetStr("topology");
+  bool known_rf = false;
+  for (unsigned i = 0; i < sizeof(deterministic_rf) / sizeof(deterministic_rf[0]); ++i) {
+    known_rf |= (rf == deterministic_rf[i]);
+  }
+  if (!known_rf || _icnt_config->GetStr("router") != "iq") {
+    return false;
+  }
+  if (_icnt_config->GetStr("vc_allocator") == "pim" ||
+      _icnt_config->GetStr("sw_allocator") == "pim" ||
+      _icnt_config->GetStr("spec_sw_allocator") == "pim") {
+    return false;
+  }
+  return !gPrintActivity && !gWatchOut &&
+    _icnt_config->GetStr("watch_file") == "" &&
+    _icnt_config->GetStr("watch_flits") == "" &&
+    _icnt_config->GetStr("watch_packets") == "" &&
+    _icnt_config->GetStr("watch_transactions") == "";
 }
 
 void InterconnectInterface::Init()
@@ -257,16 +303,16 @@ bool InterconnectInterface::Busy() const
   return false;
 }
 
-bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size) const
+bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size, unsigned queued, unsigned queued_flits) const
 {
   bool has_buffer = false;
   unsigned int n_flits = size / _flit_size + ((size % _flit_size)? 1:0);
   int icntID = _node_map.find(deviceID)->second;
 
-  has_buffer = _traffic_manager->_input_queue[0][icntID][0].size() +n_flits <= _input_buffer_capacity;
+  has_buffer = _traffic_manager->_input_queue[0][icntID][0].size() +queued_flits +n_flits <= _input_buffer_capacity;
 
   if ((_subnets>1) && deviceID >= _n_shader) // deviceID is memory node
-    has_buffer = _traffic_manager->_input_queue[1][icntID][0].size() +n_flits <= _input_buffer_capacity;
+    has_buffer = _traffic_manager->_input_queue[1][icntID][0].size() +queued_flits +n_flits <= _input_buffer_capacity;
 
   return has_buffer;
 }
@@ -331,7 +377,7 @@ void InterconnectInterface::Transfer2BoundaryBuffer(int subnet, int output)
       assert(flit);
 
       _ejection_buffer[subnet][output][vc].pop();
-      _boundary_buffer[subnet][output][vc].PushFlitData( flit->data, flit->tail);
+      _boundary_buffer[subnet][output][vc].PushFlit(flit);
 
       _ejected_flit_queue[subnet][output].push(flit); //indicate this flit is already popped from ejection buffer and ready for credit return
 
@@ -506,41 +552,32 @@ void InterconnectInterface::_DisplayMap(int dim,int count)
 
 void* InterconnectInterface::_BoundaryBufferItem::PopPacket()
 {
-  assert (_packet_n);
-  void * data = NULL;
-  void * flit_data = _buffer.front();
-  while (data == NULL) {
-    assert(flit_data == _buffer.front()); //all flits must belong to the same packet
-    if (_tail_flag.front()) {
-      data = _buffer.front();
-      _packet_n--;
-    }
-    _buffer.pop();
-    _tail_flag.pop();
-  }
+  assert (!_packets.empty());
+  void* data = _packets.front().first;
+  _flits -= _packets.front().second;
+  _packets.pop();
   return data;
 }
 
 void* InterconnectInterface::_BoundaryBufferItem::TopPacket() const
 {
-  assert (_packet_n);
-  void* data = NULL;
-  void* temp_d = _buffer.front();
-  while (data==NULL) {
-    if (_tail_flag.front()) {
-      data = _buffer.front();
-    }
-    assert(temp_d == _buffer.front()); //all flits must belong to the same packet
-  }
-  return data;
-
+  assert (!_packets.empty());
+  return _packets.front().first;
 }
 
-void InterconnectInterface::_BoundaryBufferItem::PushFlitData(void* data,bool is_tail)
+void InterconnectInterface::_BoundaryBufferItem::PushFlit(const Flit* flit)
 {
-  _buffer.push(data);
-  _tail_flag.push(is_tail);
-  if (is_tail) {
-    _packet_n++;
+  // flits of one packet arrive in order on a vc and are not interleaved
+  if (flit->head) {
+    assert(_partial_flits == 0);
+    _partial_data = flit->data;
+  }
+  assert(_partial_data);
+  _partial_flits++;
+  _flits++;
+  if (flit->tail) {
+    _packets.push(make_pair(_partial_data, _partial_flits));
+    _partial_data = NULL;
+    _partial_flits = 0;
   }
 }
@@ -41,6 +41,7 @@ class GPUTrafficManager;
 class IntersimConfig;
 class Network;
 class Stats;
+class sim_thread_pool;
 
 //TODO: fixed_lat_icnt, add class support? support for signle network
 
@@ -57,7 +58,8 @@ public:
   virtual void* Pop(unsigned ouput_deviceID);
   virtual void Advance();
   virtual bool Busy() const;
-  virtual bool HasBuffer(unsigned deviceID, unsigned int size) const;
+  virtual bool HasBuffer(unsigned deviceID, unsigned int size,
+                         unsigned queued = 0, unsigned queued_flits = 0) const;
   virtual void DisplayStats() const;
   virtual void DisplayOverallStats() const;
   unsigned GetFlitSize() const;
@@ -76,24 +78,30 @@ public:
   
 protected:
   
+  // Holds ejected packets rather than flits: the payload is taken from the
+  // head flit and a packet becomes visible once its tail arrives. Size() still
+  // counts flits so the buffer capacity keeps its meaning.
   class _BoundaryBufferItem {
   public:
-    _BoundaryBufferItem():_packet_n(0) {}
-    inline unsigned Size(void) const { return _buffer.size(); }
-    inline bool HasPacket() const { return _packet_n; }
+    _BoundaryBufferItem():_flits(0),_partial_data(NULL),_partial_flits(0) {}
+    inline unsigned Size(void) const { return _flits; }
+    inline bool HasPacket() const { return !_packets.empty(); }
     void* PopPacket();
     void* TopPacket() const;
-    void PushFlitData(void* data,bool is_tail);
+    void PushFlit(const Flit* flit);
     
   private:
-    queue<void *> _buffer;
-    queue<bool> _tail_flag;
-    int _packet_n;
+    // payload and flit count of each complete packet
+    queue<pair<void *, unsigned> > _packets;
+    unsigned _flits;
+    void* _partial_data;
+    unsigned _partial_flits;
   };
   typedef queue<Flit*> _EjectionBufferItem;
   
   void _CreateBuffer( );
   void _CreateNodeMap(unsigned n_shader, unsigned n_mem, unsigned n_node, int use_map);
+  bool _DeterministicRouters( ) const;
   void _DisplayMap(int dim,int count);
   
   // size: [subnets][nodes][vcs]
@@ -116,6 +124,9 @@ protected:
   vector<Network *> _net;
   int _vcs;
   int _subnets;
+
+  // steps the networks when network_threads > 1
+  sim_thread_pool* _pool;
   
   //deviceID to icntID map
   //deviceID : Starts from 0 for shaders and then continues until mem nodes
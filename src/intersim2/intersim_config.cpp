@@ -43,6 +43,10 @@ IntersimConfig::IntersimConfig()
   _int_map["input_buffer_size"] = 0;
   _int_map["ejection_buffer_size"] = 0; // if left zero the simulator will use the vc_buf_size instead
   _int_map["boundary_buffer_size"] = 16;
+
+  // host threads stepping the routers and channels of all subnets; only
+  // honoured for deterministic routers, see InterconnectInterface
+  _int_map["network_threads"] = 1;
   
 
   // FIXME: obsolete, unsupport configs
@@ -33,6 +33,8 @@
  */
 
 #include <cassert>
+#include <map>
+#include <set>
 #include <sstream>
 
 #include "booksim.hpp"
@@ -56,6 +58,8 @@ Network::Network( const Configuration &config, const string & name ) :
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+  _activity_ready = false;
+  _cycle = 0;
 }
 
 Network::~Network( )
@@ -179,30 +183,207 @@ void Network::_Alloc( )
   }
 }
 
-void Network::ReadInputs( )
+void Network::_InitActivity( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->ReadInputs( );
+  // flit channel n pairs with credit channel n, which runs the other way
+  vector<CreditChannel *> paired_credit;
+  _inject_id.resize(_nodes);
+  _eject_cred_id.resize(_nodes);
+  for ( int s = 0; s < _nodes; ++s ) {
+    _inject_id[s] = _act_flit_chan.size();
+    _act_flit_chan.push_back(_inject[s]);
+    paired_credit.push_back(_inject_cred[s]);
+  }
+  for ( int d = 0; d < _nodes; ++d ) {
+    _eject_cred_id[d] = 2 * _nodes + _channels + _act_flit_chan.size();
+    _act_flit_chan.push_back(_eject[d]);
+    paired_credit.push_back(_eject_cred[d]);
+  }
+  for ( int c = 0; c < _channels; ++c ) {
+    _act_flit_chan.push_back(_chan[c]);
+    paired_credit.push_back(_chan_cred[c]);
+  }
+  int const flit_chans = _act_flit_chan.size();
+  _act_credit_chan = paired_credit;
+
+  map<Router const *, int> router_index;
+  for ( int r = 0; r < _size; ++r ) {
+    router_index[_routers[r]] = r;
+  }
+  _chan_receiver.assign(2 * flit_chans, -1);
+  _router_sends.assign(_size, vector<int>());
+  for ( int f = 0; f < flit_chans; ++f ) {
+    int const credit = flit_chans + f;
+    Router const * const source = _act_flit_chan[f]->GetSource();
+    Router const * const sink = _act_flit_chan[f]->GetSink();
+    if ( source ) {
+      int const r = router_index[source];
+      _router_sends[r].push_back(f);
+      _chan_receiver[credit] = r;
+    }
+    if ( sink ) {
+      int const r = router_index[sink];
+      _router_sends[r].push_back(credit);
+      _chan_receiver[f] = r;
+    }
+  }
+
+  // anything else a topology registered is stepped every cycle
+  set<TimedModule const *> known(_routers.begin(), _routers.end());
+  known.insert(_act_flit_chan.begin(), _act_flit_chan.end());
+  known.insert(_act_credit_chan.begin(), _act_credit_chan.end());
+  for ( deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+        iter != _timed_modules.end(); ++iter ) {
+    if ( known.count(*iter) == 0 ) {
+      _always_step.push_back(*iter);
+    }
+  }
+
+  _chan_listed.assign(2 * flit_chans, 0);
+  for ( int c = 0; c < 2 * flit_chans; ++c ) {
+    if ( !_ChannelIdle(c) ) {
+      _ListChannel(c);
+    }
+  }
+  // every router gets stepped once before it can be found idle
+  _router_listed.assign(_size, 0);
+  _router_last_step.assign(_size, _cycle - 1);
+  for ( int r = 0; r < _size; ++r ) {
+    _ListRouter(r);
   }
+  _activity_ready = true;
 }
 
-void Network::Evaluate( )
+bool Network::_ChannelIdle( int chan ) const
+{
+  int const flit_chans = _act_flit_chan.size();
+  return ( chan < flit_chans ) ? _act_flit_chan[chan]->Idle( ) :
+    _act_credit_chan[chan - flit_chans]->Idle( );
+}
+
+void Network::_ListChannel( int chan )
+{
+  if ( !_chan_listed[chan] ) {
+    _chan_listed[chan] = 1;
+    _busy_chans.push_back(chan);
+  }
+}
+
+void Network::_ListRouter( int r )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->Evaluate( );
+  if ( !_router_listed[r] ) {
+    _router_listed[r] = 1;
+    _active_routers.push_back(r);
   }
 }
 
+void Network::BeginStep( )
+{
+  if ( !_activity_ready ) {
+    _InitActivity( );
+  }
+  int const flit_chans = _act_flit_chan.size();
+  _step_modules.assign(_always_step.begin(), _always_step.end());
+  for ( size_t i = 0; i < _busy_chans.size(); ++i ) {
+    int const c = _busy_chans[i];
+    if ( c < flit_chans ) {
+      _step_modules.push_back(_act_flit_chan[c]);
+    } else {
+      _step_modules.push_back(_act_credit_chan[c - flit_chans]);
+    }
+  }
+  for ( size_t i = 0; i < _active_routers.size(); ++i ) {
+    int const r = _active_routers[i];
+    int const skipped = _cycle - _router_last_step[r] - 1;
+    if ( skipped > 0 ) {
+      _routers[r]->SkipIdleCycles(skipped);
+    }
+    _router_last_step[r] = _cycle;
+    _step_modules.push_back(_routers[r]);
+  }
+}
+
+void Network::EndStep( )
+{
+  // routers that wrote to an idle channel make it busy; idle routers drop out
+  vector<int> stepped;
+  stepped.swap(_active_routers);
+  for ( size_t i = 0; i < stepped.size(); ++i ) {
+    int const r = stepped[i];
+    _router_listed[r] = 0;
+    vector<int> const & sends = _router_sends[r];
+    for ( size_t s = 0; s < sends.size(); ++s ) {
+      if ( !_chan_listed[sends[s]] && !_ChannelIdle(sends[s]) ) {
+        _ListChannel(sends[s]);
+      }
+    }
+    if ( !_routers[r]->IsIdle( ) ) {
+      _ListRouter(r);
+    }
+  }
+  // a channel that delivered this cycle wakes its receiver for the next one
+  int const flit_chans = _act_flit_chan.size();
+  size_t kept = 0;
+  for ( size_t i = 0; i < _busy_chans.size(); ++i ) {
+    int const c = _busy_chans[i];
+    bool const delivered = ( c < flit_chans ) ?
+      ( _act_flit_chan[c]->Receive( ) != NULL ) :
+      ( _act_credit_chan[c - flit_chans]->Receive( ) != NULL );
+    if ( delivered && _chan_receiver[c] >= 0 ) {
+      _ListRouter(_chan_receiver[c]);
+    }
+    if ( _ChannelIdle(c) ) {
+      _chan_listed[c] = 0;
+    } else {
+      _busy_chans[kept++] = c;
+    }
+  }
+  _busy_chans.resize(kept);
+  ++_cycle;
+}
+
+void Network::ReadInputs( )
+{
+  BeginStep( );
+  ReadInputs( 0, _step_modules.size() );
+}
+
+void Network::Evaluate( )
+{
+  Evaluate( 0, _step_modules.size() );
+}
+
 void Network::WriteOutputs( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->WriteOutputs( );
+  WriteOutputs( 0, _step_modules.size() );
+  EndStep( );
+}
+
+void Network::ReadInputs( int first, int last )
+{
+  for ( int m = first; m < last; ++m ) {
+    _step_modules[m]->ReadInputs( );
+  }
+}
+
+void Network::Evaluate( int first, int last )
+{
+  for ( int m = first; m < last; ++m ) {
+    _step_modules[m]->Evaluate( );
+  }
+}
+
+void Network::WriteOutputs( int first, int last )
+{
+  for ( int m = first; m < last; ++m ) {
+    _step_modules[m]->WriteOutputs( );
+  }
+}
+
+void Network::SetSubnet( int subnet )
+{
+  for ( int r = 0; r < _size; ++r ) {
+    _routers[r]->SetSubnet( subnet );
   }
 }
 
@@ -210,6 +391,10 @@ void Network::WriteFlit( Flit *f, int source )
 {
   assert( ( source >= 0 ) && ( source < _nodes ) );
   _inject[source]->Send(f);
+  if ( !_activity_ready ) {
+    _InitActivity( );
+  }
+  _ListChannel(_inject_id[source]);
 }
 
 Flit *Network::ReadFlit( int dest )
@@ -222,6 +407,10 @@ void Network::WriteCredit( Credit *c, int dest )
 {
   assert( ( dest >= 0 ) && ( dest < _nodes ) );
   _eject_cred[dest]->Send(c);
+  if ( !_activity_ready ) {
+    _InitActivity( );
+  }
+  _ListChannel(_eject_cred_id[dest]);
 }
 
 Credit *Network::ReadCredit( int source )
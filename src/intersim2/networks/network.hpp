@@ -66,6 +66,30 @@ protected:
 
   deque<TimedModule *> _timed_modules;
 
+  // Activity tracking. A step only visits the busy channels, the routers
+  // that are not idle and the routers a channel delivered to in the previous
+  // cycle. Channels are numbered flit channels first, then credit channels.
+  bool _activity_ready;
+  int _cycle;
+  vector<FlitChannel *> _act_flit_chan;
+  vector<CreditChannel *> _act_credit_chan;
+  vector<int> _chan_receiver;            // channel -> router, -1 if none
+  vector<vector<int> > _router_sends;    // router -> channels it writes
+  vector<int> _inject_id;
+  vector<int> _eject_cred_id;
+  vector<TimedModule *> _always_step;    // modules of unknown kind
+  vector<int> _busy_chans;
+  vector<char> _chan_listed;
+  vector<int> _active_routers;
+  vector<char> _router_listed;
+  vector<int> _router_last_step;
+  vector<TimedModule *> _step_modules;
+
+  void _InitActivity( );
+  bool _ChannelIdle( int chan ) const;
+  void _ListChannel( int chan );
+  void _ListRouter( int r );
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
@@ -85,6 +109,9 @@ public:
 
   inline int NumNodes( ) const {return _nodes;}
 
+  // tells the routers which subnet's credit pool to use
+  void SetSubnet( int subnet );
+
   virtual void InsertRandomFaults( const Configuration &config );
   void OutChannelFault( int r, int c, bool fault = true );
 
@@ -94,6 +121,18 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( );
 
+  // A step is BeginStep(), the three phases over the modules picked for this
+  // cycle, then EndStep(). Within a phase every module touches just its own
+  // state and its own end of each channel, so disjoint ranges [first, last)
+  // of the picked modules may be stepped concurrently. The argument-less
+  // phase methods above do the whole step on the caller.
+  void BeginStep( );
+  void EndStep( );
+  int NumStepModules( ) const {return _step_modules.size();}
+  void ReadInputs( int first, int last );
+  void Evaluate( int first, int last );
+  void WriteOutputs( int first, int last );
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
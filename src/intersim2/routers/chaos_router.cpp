@@ -580,7 +580,7 @@ void ChaosRouter::_OutputAdvance( )
 	  _input_mq_match[i]     = -1;
 	}
 	
-	c = Credit::New( );
+	c = Credit::New( _subnet );
 	c->vc.insert(0);
 	_credit_queue[i].push( c );
       }
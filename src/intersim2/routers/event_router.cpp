@@ -670,7 +670,7 @@ void EventRouter::_TransportArb( int input )
       }
     }
 
-    c = Credit::New( );
+    c = Credit::New( _subnet );
     c->vc.insert(f->vc);
     c->head          = f->head;
     c->tail          = f->tail;
@@ -288,6 +288,24 @@ void IQRouter::WriteOutputs( )
   _SendCredits( );
 }
 
+bool IQRouter::IsIdle( ) const
+{
+  if(_active || !_in_queue_flits.empty() || !_proc_credits.empty()) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 //------------------------------------------------------------------------------
 // read inputs
@@ -1124,7 +1142,7 @@ void IQRouter::_SWHoldUpdate( )
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
       
       if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+	_out_queue_credits.insert(make_pair(input, Credit::New(_subnet)));
       }
       _out_queue_credits.find(input)->second->vc.insert(vc);
       
@@ -2034,7 +2052,7 @@ void IQRouter::_SWAllocUpdate( )
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
 
       if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+	_out_queue_credits.insert(make_pair(input, Credit::New(_subnet)));
       }
       _out_queue_credits.find(input)->second->vc.insert(vc);
 
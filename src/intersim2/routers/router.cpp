@@ -58,7 +58,7 @@ int const Router::STALL_CROSSBAR_CONFLICT = -6;
 Router::Router( const Configuration& config,
 		Module *parent, const string & name, int id,
 		int inputs, int outputs ) :
-TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
+TimedModule( parent, name ), _id( id ), _subnet( 0 ), _inputs( inputs ), _outputs( outputs ),
    _partial_internal_cycles(0.0)
 {
   _crossbar_delay   = ( config.GetInt( "st_prepare_delay" ) + 
@@ -111,6 +111,17 @@ void Router::Evaluate( )
   }
 }
 
+void Router::SkipIdleCycles( int cycles )
+{
+  // same arithmetic as Evaluate(), whose internal steps are no-ops while idle
+  for( int i = 0; i < cycles; ++i ) {
+    _partial_internal_cycles += _internal_speedup;
+    while( _partial_internal_cycles >= 1.0 ) {
+      _partial_internal_cycles -= 1.0;
+    }
+  }
+}
+
 void Router::OutChannelFault( int c, bool fault )
 {
   assert( ( c >= 0 ) && ( (size_t)c < _channel_faults.size( ) ) );
@@ -51,6 +51,9 @@ protected:
   static int const STALL_CROSSBAR_CONFLICT;
 
   int _id;
+
+  // subnet whose credit pool the router allocates from
+  int _subnet;
   
   int _inputs;
   int _outputs;
@@ -110,11 +113,28 @@ public:
     assert((output >= 0) && (output < _outputs));
     return _output_channels[output];
   }
+  inline CreditChannel * GetInputCredit( int input ) const {
+    assert((input >= 0) && (input < _inputs));
+    return _input_credits[input];
+  }
+  inline CreditChannel * GetOutputCredit( int output ) const {
+    assert((output >= 0) && (output < _outputs));
+    return _output_credits[output];
+  }
 
   virtual void ReadInputs( ) = 0;
   virtual void Evaluate( );
   virtual void WriteOutputs( ) = 0;
 
+  // True when the router holds no flits or credits and stepping it with
+  // empty input channels would change nothing but the internal-speedup
+  // phase; routers that cannot tell stay busy. The network then skips it
+  // and calls SkipIdleCycles() when it is next stepped.
+  virtual bool IsIdle( ) const { return false; }
+  void SkipIdleCycles( int cycles );
+
+  void SetSubnet( int subnet ) { _subnet = subnet; }
+
   void OutChannelFault( int c, bool fault = true );
   bool IsFaultyOutput( int c ) const;
 
@@ -67,6 +67,12 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     _vcs = config.GetInt("num_vcs");
     _subnets = config.GetInt("subnets");
+
+    Flit::SetSubnets(_subnets);
+    Credit::SetSubnets(_subnets);
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+        _net[subnet]->SetSubnet(subnet);
+    }
  
     _subnet.resize(Flit::NUM_FLIT_TYPES);
     _subnet[Flit::READ_REQUEST] = config.GetInt("read_request_subnet");
@@ -849,7 +855,7 @@ void TrafficManager::_GeneratePacket( int source, int stype,
     }
   
     for ( int i = 0; i < size; ++i ) {
-        Flit * f  = Flit::New();
+        Flit * f  = Flit::New(subnetwork);
         f->id     = _cur_id++;
         assert(_cur_id);
         f->pid    = pid;
@@ -1246,7 +1252,7 @@ void TrafficManager::_Step( )
                                << " into subnet " << subnet 
                                << "." << endl;
                 }
-                Credit * const c = Credit::New();
+                Credit * const c = Credit::New(subnet);
                 c->vc.insert(f->vc);
                 _net[subnet]->WriteCredit(c, n);
 	
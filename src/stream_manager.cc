@@ -27,8 +27,10 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "stream_manager.h"
+#include <sched.h>
 #include "../libcuda/gpgpu_context.h"
 #include "cuda-sim/cuda-sim.h"
+#include "cuda-sim/memory.h"
 #include "gpgpu-sim/gpu-sim.h"
 #include "gpgpusim_entrypoint.h"
 
@@ -36,79 +38,64 @@ unsigned CUstream_st::sm_next_stream_uid = 0;
 
 CUstream_st::CUstream_st() {
   m_pending = false;
+  m_progress = NULL;
   m_uid = sm_next_stream_uid++;
-  pthread_mutex_init(&m_lock, NULL);
+  pthread_mutex_init(&m_print_lock, NULL);
 }
 
-bool CUstream_st::empty() {
-  pthread_mutex_lock(&m_lock);
-  bool empty = m_operations.empty();
-  pthread_mutex_unlock(&m_lock);
-  return empty;
-}
+bool CUstream_st::empty() { return m_operations.empty(); }
 
 bool CUstream_st::busy() {
-  pthread_mutex_lock(&m_lock);
-  bool pending = m_pending;
-  pthread_mutex_unlock(&m_lock);
-  return pending;
+  // called by gpu thread
+  return m_pending;
 }
 
 void CUstream_st::synchronize() {
   // called by host thread
-  bool done = false;
-  do {
-    pthread_mutex_lock(&m_lock);
-    done = m_operations.empty();
-    pthread_mutex_unlock(&m_lock);
-  } while (!done);
+  if (m_progress) {
+    m_progress->wait<CUstream_st, &CUstream_st::empty>(this);
+  } else {
+    while (!empty()) sched_yield();
+  }
 }
 
 void CUstream_st::push(const stream_operation &op) {
   // called by host thread
-  pthread_mutex_lock(&m_lock);
-  m_operations.push_back(op);
-  pthread_mutex_unlock(&m_lock);
+  m_operations.push(op);
 }
 
 void CUstream_st::record_next_done() {
   // called by gpu thread
-  pthread_mutex_lock(&m_lock);
   assert(m_pending);
-  m_operations.pop_front();
+  pthread_mutex_lock(&m_print_lock);
+  m_operations.pop();
+  pthread_mutex_unlock(&m_print_lock);
   m_pending = false;
-  pthread_mutex_unlock(&m_lock);
+  if (m_progress) m_progress->notify();
 }
 
 stream_operation CUstream_st::next() {
   // called by gpu thread
-  pthread_mutex_lock(&m_lock);
   m_pending = true;
-  stream_operation result = m_operations.front();
-  pthread_mutex_unlock(&m_lock);
-  return result;
+  return m_operations.front();
 }
 
 void CUstream_st::cancel_front() {
-  pthread_mutex_lock(&m_lock);
   assert(m_pending);
   m_pending = false;
-  pthread_mutex_unlock(&m_lock);
 }
 
 void CUstream_st::print(FILE *fp) {
-  pthread_mutex_lock(&m_lock);
+  pthread_mutex_lock(&m_print_lock);
   fprintf(fp, "GPGPU-Sim API:    stream %u has %zu operations\n", m_uid,
           m_operations.size());
-  std::list<stream_operation>::iterator i;
-  unsigned n = 0;
-  for (i = m_operations.begin(); i != m_operations.end(); i++) {
-    stream_operation &op = *i;
-    fprintf(fp, "GPGPU-Sim API:       %u : ", n++);
-    op.print(fp);
+  size_t size = m_operations.size();
+  for (size_t n = 0; n < size; n++) {
+    fprintf(fp, "GPGPU-Sim API:       %zu : ", n);
+    m_operations.peek(n).print(fp);
     fprintf(fp, "\n");
   }
-  pthread_mutex_unlock(&m_lock);
+  pthread_mutex_unlock(&m_print_lock);
 }
 
 bool stream_operation::do_operation(gpgpu_sim *gpu) {
@@ -200,6 +187,107 @@ bool stream_operation::do_operation(gpgpu_sim *gpu) {
   return true;
 }
 
+struct stream_copy_job {
+  stream_copy_job(const stream_operation &o) : op(o) {}
+  stream_operation op;
+  std::vector<mem_span> dst;
+  std::vector<mem_span> src;
+};
+
+void stream_operation::map_copy(gpgpu_sim *gpu, stream_copy_job *job) {
+  assert(is_mem() && !m_done && m_stream);
+  if (g_debug_execution >= 3) {
+    printf("GPGPU-Sim API: stream %u starting asynchronous ",
+           m_stream->get_uid());
+    print(stdout);
+    printf("\n");
+  }
+  memory_space *mem = gpu->get_global_memory();
+  switch (m_type) {
+    case stream_memcpy_host_to_device:
+      mem->map(m_device_address_dst, m_cnt, true, job->dst);
+      gpu->perf_memcpy_to_gpu(m_device_address_dst, m_cnt);
+      break;
+    case stream_memcpy_device_to_host:
+      mem->map(m_device_address_src, m_cnt, false, job->src);
+      gpu->perf_memcpy_to_gpu(m_device_address_src, m_cnt);
+      break;
+    case stream_memcpy_device_to_device:
+      mem->map(m_device_address_dst, m_cnt, true, job->dst);
+      mem->map(m_device_address_src, m_cnt, false, job->src);
+      break;
+    default:
+      abort();
+  }
+}
+
+void stream_operation::run_copy(stream_copy_job *job) {
+  switch (m_type) {
+    case stream_memcpy_host_to_device:
+      mem_spans_write(job->dst, m_host_address_src);
+      break;
+    case stream_memcpy_device_to_host:
+      mem_spans_read(job->src, m_host_address_dst);
+      break;
+    case stream_memcpy_device_to_device:
+      mem_spans_copy(job->dst, job->src);
+      break;
+    default:
+      abort();
+  }
+  m_done = true;
+}
+
+stream_copy_engine::stream_copy_engine() {
+  m_shutdown = false;
+  m_outstanding = 0;
+  if (pthread_create(&m_worker, NULL, worker_main, this) != 0) {
+    fprintf(stderr, "GPGPU-Sim API: unable to create copy engine thread\n");
+    abort();
+  }
+}
+
+stream_copy_engine::~stream_copy_engine() {
+  m_shutdown = true;
+  m_work.notify();
+  pthread_join(m_worker, NULL);
+}
+
+void stream_copy_engine::submit(stream_copy_job *job) {
+  m_outstanding++;
+  m_submitted.push(job);
+  m_work.notify();
+}
+
+stream_copy_job *stream_copy_engine::finished() {
+  if (m_finished.empty()) return NULL;
+  stream_copy_job *job = m_finished.front();
+  m_finished.pop();
+  m_outstanding--;
+  return job;
+}
+
+void stream_copy_engine::wait_finished() {
+  m_done.wait<stream_copy_engine, &stream_copy_engine::has_finished>(this);
+}
+
+void *stream_copy_engine::worker_main(void *arg) {
+  ((stream_copy_engine *)arg)->worker_loop();
+  return NULL;
+}
+
+void stream_copy_engine::worker_loop() {
+  while (true) {
+    m_work.wait<stream_copy_engine, &stream_copy_engine::has_work>(this);
+    if (m_submitted.empty()) break;  // shutdown with nothing left to copy
+    stream_copy_job *job = m_submitted.front();
+    m_submitted.pop();
+    job->op.run_copy(job);
+    m_finished.push(job);
+    m_done.notify();
+  }
+}
+
 void stream_operation::print(FILE *fp) const {
   fprintf(fp, " stream operation ");
   switch (m_type) {
@@ -234,16 +322,41 @@ stream_manager::stream_manager(gpgpu_sim *gpu, bool cuda_launch_blocking) {
   m_gpu = gpu;
   m_service_stream_zero = false;
   m_cuda_launch_blocking = cuda_launch_blocking;
+  m_stream_zero.set_progress(&m_progress);
   pthread_mutex_init(&m_lock, NULL);
   m_last_stream = m_streams.begin();
+  m_copy_engine =
+      gpu->get_config().async_memcpy() ? new stream_copy_engine() : NULL;
+}
+
+void stream_manager::retire_copies() {
+  // called by gpu simulation thread
+  if (!m_copy_engine) return;
+  while (stream_copy_job *job = m_copy_engine->finished()) {
+    job->op.get_stream()->record_next_done();
+    delete job;
+  }
 }
 
 bool stream_manager::operation(bool *sim) {
   bool check = check_finished_kernel();
+  retire_copies();
   pthread_mutex_lock(&m_lock);
   //    if(check)m_gpu->print_stats();
   stream_operation op = front();
-  if (!op.do_operation(m_gpu))  // not ready to execute
+  if (m_copy_engine && op.is_mem() && m_gpu->active()) {
+    // overlap the copy with the kernels being simulated
+    stream_copy_job *job = new stream_copy_job(op);
+    op.map_copy(m_gpu, job);
+    m_copy_engine->submit(job);
+  } else if (op.is_noop() && m_copy_engine && m_copy_engine->busy() &&
+             !m_gpu->active()) {
+    // nothing to simulate until an outstanding copy completes
+    pthread_mutex_unlock(&m_lock);
+    m_copy_engine->wait_finished();
+    retire_copies();
+    return check;
+  } else if (!op.do_operation(m_gpu))  // not ready to execute
   {
     // cancel operation
     if (op.is_kernel()) {
@@ -359,6 +472,7 @@ stream_operation stream_manager::front() {
 
 void stream_manager::add_stream(struct CUstream_st *stream) {
   // called by host thread
+  stream->set_progress(&m_progress);
   pthread_mutex_lock(&m_lock);
   m_streams.push_back(stream);
   pthread_mutex_unlock(&m_lock);
@@ -366,9 +480,8 @@ void stream_manager::add_stream(struct CUstream_st *stream) {
 
 void stream_manager::destroy_stream(CUstream_st *stream) {
   // called by host thread
+  stream->synchronize();
   pthread_mutex_lock(&m_lock);
-  while (!stream->empty())
-    ;
   std::list<CUstream_st *>::iterator s;
   for (s = m_streams.begin(); s != m_streams.end(); s++) {
     if (*s == stream) {
@@ -384,7 +497,8 @@ void stream_manager::destroy_stream(CUstream_st *stream) {
 bool stream_manager::concurrent_streams_empty() {
   bool result = true;
   if (m_streams.empty()) return true;
-  // called by gpu simulation thread
+  // called by gpu simulation thread under m_lock, or by the host thread,
+  // which is the only one modifying m_streams
   std::list<struct CUstream_st *>::iterator s;
   for (s = m_streams.begin(); s != m_streams.end(); ++s) {
     struct CUstream_st *stream = *s;
@@ -433,14 +547,10 @@ void stream_manager::push(stream_operation op) {
 
   // block if stream 0 (or concurrency disabled) and pending concurrent
   // operations exist
-  bool block = !stream || m_cuda_launch_blocking;
-  while (block) {
-    pthread_mutex_lock(&m_lock);
-    block = !concurrent_streams_empty();
-    pthread_mutex_unlock(&m_lock);
-  };
+  if (!stream || m_cuda_launch_blocking)
+    m_progress.wait<stream_manager, &stream_manager::concurrent_streams_empty>(
+        this);
 
-  pthread_mutex_lock(&m_lock);
   if (!m_gpu->cycle_insn_cta_max_hit()) {
     // Accept the stream operation if the maximum cycle/instruction/cta counts
     // are not triggered
@@ -450,6 +560,7 @@ void stream_manager::push(stream_operation op) {
       op.set_stream(&m_stream_zero);
       m_stream_zero.push(op);
     }
+    m_work.notify();
   } else {
     // Otherwise, ignore operation and continue
     printf(
@@ -459,18 +570,8 @@ void stream_manager::push(stream_operation op) {
     printf("\n");
   }
   if (g_debug_execution >= 3) print_impl(stdout);
-  pthread_mutex_unlock(&m_lock);
-  if (m_cuda_launch_blocking || stream == NULL) {
-    unsigned int wait_amount = 100;
-    unsigned int wait_cap = 100000;  // 100ms
-    while (!empty()) {
-      // sleep to prevent CPU hog by empty spin
-      // sleep time increased exponentially ensure fast response when needed
-      usleep(wait_amount);
-      wait_amount *= 2;
-      if (wait_amount > wait_cap) wait_amount = wait_cap;
-    }
-  }
+  if (m_cuda_launch_blocking || stream == NULL)
+    m_progress.wait<stream_manager, &stream_manager::empty>(this);
 }
 
 void stream_manager::pushCudaStreamWaitEventToAllStreams(CUevent_st *e,
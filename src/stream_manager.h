@@ -29,11 +29,136 @@
 #ifndef STREAM_MANAGER_H_INCLUDED
 #define STREAM_MANAGER_H_INCLUDED
 
+#include <assert.h>
 #include <pthread.h>
 #include <time.h>
 #include <list>
 #include "abstract_hardware_model.h"
 
+// Wakes threads waiting for a condition that another thread makes true
+// without holding any lock.  notify() only touches the mutex when a waiter is
+// registered, so the thread publishing work or progress never blocks on it.
+class stream_notifier {
+ public:
+  stream_notifier() {
+    m_waiters = 0;
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_cond, NULL);
+  }
+  ~stream_notifier() {
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_lock);
+  }
+
+  // Blocks until (obj->*P)() holds.  The waiter is registered before the
+  // condition is re-checked, pairing with the barrier in notify().
+  template <class T, bool (T::*P)()>
+  void wait(T *obj) {
+    if ((obj->*P)()) return;
+    pthread_mutex_lock(&m_lock);
+    __sync_add_and_fetch(&m_waiters, 1);
+    while (!(obj->*P)()) pthread_cond_wait(&m_cond, &m_lock);
+    __sync_sub_and_fetch(&m_waiters, 1);
+    pthread_mutex_unlock(&m_lock);
+  }
+
+  // Call after making a waited-for condition true.
+  void notify() {
+    __sync_synchronize();
+    if (m_waiters == 0) return;
+    pthread_mutex_lock(&m_lock);
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+  }
+
+ private:
+  pthread_mutex_t m_lock;
+  pthread_cond_t m_cond;
+  volatile unsigned m_waiters;
+};
+
+// Unbounded single-producer/single-consumer queue made of fixed-size
+// segments.  The producer links a new segment before publishing the element
+// that lives in it, and each side only writes its own counter, so push() and
+// pop() never wait on each other.  empty() and size() may be called from
+// either side; front() and pop() only from the consumer.  Only pop() frees
+// segments, so peek() may be called from any thread that excludes concurrent
+// pop() by other means.
+template <class T, unsigned N = 64>
+class spsc_queue {
+ public:
+  spsc_queue() {
+    m_head = m_tail = new segment();
+    m_head_idx = m_tail_idx = 0;
+    m_pushed = m_popped = 0;
+  }
+  ~spsc_queue() {
+    while (m_head) {
+      segment *next = m_head->next;
+      delete m_head;
+      m_head = next;
+    }
+  }
+
+  bool empty() const { return m_popped == m_pushed; }
+  size_t size() const { return m_pushed - m_popped; }
+
+  void push(const T &value) {
+    if (m_tail_idx == N) {
+      segment *s = new segment();
+      m_tail->next = s;
+      m_tail = s;
+      m_tail_idx = 0;
+    }
+    m_tail->items[m_tail_idx++] = value;
+    __sync_synchronize();  // element and link visible before the count
+    m_pushed++;
+  }
+
+  T &front() {
+    assert(!empty());
+    __sync_synchronize();
+    if (m_head_idx == N) return m_head->next->items[0];
+    return m_head->items[m_head_idx];
+  }
+
+  void pop() {
+    assert(!empty());
+    __sync_synchronize();
+    if (m_head_idx == N) {
+      segment *old = m_head;
+      m_head = old->next;
+      m_head_idx = 0;
+      delete old;
+    }
+    m_head->items[m_head_idx++] = T();
+    __sync_synchronize();  // slot released before the producer may see it
+    m_popped++;
+  }
+
+  const T &peek(size_t i) const {
+    assert(i < size());
+    __sync_synchronize();
+    const segment *s = m_head;
+    for (i += m_head_idx; i >= N; i -= N) s = s->next;
+    return s->items[i];
+  }
+
+ private:
+  struct segment {
+    segment() : next(NULL) {}
+    T items[N];
+    segment *volatile next;
+  };
+
+  segment *m_head;  // consumer
+  unsigned m_head_idx;
+  segment *m_tail;  // producer
+  unsigned m_tail_idx;
+  volatile size_t m_pushed;
+  volatile size_t m_popped;
+};
+
 // class stream_barrier {
 // public:
 //    stream_barrier() { m_pending_streams=0; }
@@ -191,12 +316,16 @@ class stream_operation {
   bool is_mem() const {
     return m_type == stream_memcpy_host_to_device ||
            m_type == stream_memcpy_device_to_host ||
-           m_type == stream_memcpy_host_to_device;
+           m_type == stream_memcpy_device_to_device;
   }
   bool is_noop() const { return m_type == stream_no_op; }
   bool is_done() const { return m_done; }
   kernel_info_t *get_kernel() { return m_kernel; }
   bool do_operation(gpgpu_sim *gpu);
+  // asynchronous memcpy: map_copy() runs on the simulation thread, run_copy()
+  // on the copy engine
+  void map_copy(gpgpu_sim *gpu, struct stream_copy_job *job);
+  void run_copy(struct stream_copy_job *job);
   void print(FILE *fp) const;
   struct CUstream_st *get_stream() {
     return m_stream;
@@ -235,16 +364,51 @@ struct CUstream_st {
   stream_operation &front() { return m_operations.front(); }
   void print(FILE *fp);
   unsigned get_uid() const { return m_uid; }
+  void set_progress(stream_notifier *progress) { m_progress = progress; }
 
  private:
   unsigned m_uid;
   static unsigned sm_next_stream_uid;
 
-  std::list<stream_operation> m_operations;
+  // the host thread is the only producer, the simulation thread the only
+  // consumer; operations stay queued until they complete
+  spsc_queue<stream_operation> m_operations;
   bool m_pending;  // front operation has started but not yet completed
+                   // (simulation thread only)
+  stream_notifier *m_progress;  // signalled when an operation completes
 
-  pthread_mutex_t m_lock;  // ensure only one host or gpu manipulates stream
-                           // operation at one time
+  pthread_mutex_t m_print_lock;  // keeps print() off operations being retired
+};
+
+// Carries out functional memcpys on a worker thread while the simulation
+// thread keeps ticking the timing model.  Jobs are mapped onto device storage
+// before submission, so the worker only moves bytes and never modifies the
+// memory space.  A stream stays busy until stream_manager retires its copy,
+// which keeps operations within a stream (and events) in order.
+class stream_copy_engine {
+ public:
+  stream_copy_engine();
+  ~stream_copy_engine();
+
+  // called by the simulation thread
+  void submit(struct stream_copy_job *job);
+  struct stream_copy_job *finished();  // NULL if no copy has completed
+  void wait_finished();
+  bool busy() const { return m_outstanding > 0; }
+
+ private:
+  static void *worker_main(void *arg);
+  void worker_loop();
+  bool has_work() { return !m_submitted.empty() || m_shutdown; }
+  bool has_finished() { return !m_finished.empty(); }
+
+  spsc_queue<struct stream_copy_job *> m_submitted;
+  spsc_queue<struct stream_copy_job *> m_finished;
+  stream_notifier m_work;
+  stream_notifier m_done;
+  volatile bool m_shutdown;
+  unsigned m_outstanding;
+  pthread_t m_worker;
 };
 
 class stream_manager {
@@ -266,17 +430,27 @@ class stream_manager {
   unsigned size() { return m_streams.size(); };
   bool is_blocking() { return m_cuda_launch_blocking; };
 
+  // host -> simulation thread: new operations or exit requested
+  stream_notifier &work_signal() { return m_work; }
+  // simulation thread -> host: an operation completed or the GPU went idle
+  stream_notifier &progress_signal() { return m_progress; }
+
  private:
   void print_impl(FILE *fp);
+  void retire_copies();
 
   bool m_cuda_launch_blocking;
   gpgpu_sim *m_gpu;
+  // only modified by the host thread, under m_lock
   std::list<CUstream_st *> m_streams;
   std::map<unsigned, CUstream_st *> m_grid_id_to_stream;
+  stream_notifier m_work;
+  stream_notifier m_progress;
   CUstream_st m_stream_zero;
   bool m_service_stream_zero;
   pthread_mutex_t m_lock;
   std::list<struct CUstream_st *>::iterator m_last_stream;
+  stream_copy_engine *m_copy_engine;  // NULL unless -gpgpu_async_memcpy
 };
 
 #endif
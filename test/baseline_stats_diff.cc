@@ -0,0 +1,76 @@
+// Runs the kernels of test_kernels.h through the timing model with the
+// default (serial) settings and requires every statistic in baseline_stats/
+// to be printed again, in the same order and with the same value.  New
+// statistics may appear between them.  The files were printed with -print by
+// this program built against the simulator before the host worker threads
+// and the other simulation speedups were added, so this catches a change of
+// the simulated timing made by any of them.
+//
+// usage: baseline_stats_diff <gpgpusim.config> <baseline_stats dir>
+//        baseline_stats_diff -print <gpgpusim.config> <kernel>
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "test_kernels.h"
+
+static bool check_kernel(const test_kernel &kernel, const char *config_file,
+                         const std::string &dir) {
+  std::string file = dir + "/" + kernel.name + ".txt";
+  std::ifstream in(file.c_str());
+  if (!in) {
+    printf("baseline_stats_diff: cannot read %s\n", file.c_str());
+    return false;
+  }
+  std::vector<std::string> baseline;
+  std::string line;
+  while (std::getline(in, line)) baseline.push_back(line);
+
+  std::vector<std::string> lines;
+  if (!test_run_child(kernel, config_file, std::vector<const char *>(),
+                      lines))
+    return false;
+  unsigned b = 0;
+  for (unsigned l = 0; l < lines.size() && b < baseline.size(); l++)
+    if (lines[l] == baseline[b]) b++;
+  if (b < baseline.size()) {
+    printf("baseline_stats_diff: %s does not print line %u of %s:\n  %s\n",
+           kernel.name, b + 1, file.c_str(), baseline[b].c_str());
+    return false;
+  }
+  printf("baseline_stats_diff: %s matches %u baseline lines\n", kernel.name,
+         (unsigned)baseline.size());
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc == 4 && !strcmp(argv[1], "-print")) {
+    for (unsigned k = 0; k < g_n_test_kernels; k++) {
+      if (strcmp(g_test_kernels[k].name, argv[3])) continue;
+      std::vector<std::string> lines;
+      if (!test_run_child(g_test_kernels[k], argv[2],
+                          std::vector<const char *>(), lines))
+        return 1;
+      for (unsigned l = 0; l < lines.size(); l++)
+        printf("%s\n", lines[l].c_str());
+      return 0;
+    }
+    fprintf(stderr, "baseline_stats_diff: no kernel %s\n", argv[3]);
+    return 1;
+  }
+  if (argc != 3) {
+    fprintf(stderr,
+            "usage: %s <gpgpusim.config> <baseline_stats dir>\n"
+            "       %s -print <gpgpusim.config> <kernel>\n",
+            argv[0], argv[0]);
+    return 2;
+  }
+  bool ok = true;
+  for (unsigned k = 0; k < g_n_test_kernels; k++)
+    ok = check_kernel(g_test_kernels[k], argv[1], argv[2]) && ok;
+  printf("baseline_stats_diff: %s\n", ok ? "PASSED" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// Randomized differential test of the memory coalescers: every subwarp that
+// memory_coalescing_arch_sorted() accepts must produce exactly the accesses
+// of the map-based memory_coalescing_arch_general(), and the texture and
+// constant paths of generate_mem_accesses() must match the one-access-per-
+// cache-block reference below.
+//
+// usage: coalescing_diff <gpgpusim.config> [warps] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+
+#include "../src/abstract_hardware_model.h"
+#include "../src/gpgpu-sim/gpu-sim.h"
+#include "../src/gpgpu-sim/shader.h"
+#include "sim_setup.h"
+
+static unsigned long long lcg(unsigned long long &state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 17;
+}
+
+// removes the accesses generated since the queue held n entries, oldest first
+static std::vector<mem_access_t> take_accesses(warp_inst_t &inst, unsigned n) {
+  std::vector<mem_access_t> taken;
+  while (inst.accessq_count() > n) {
+    taken.insert(taken.begin(), inst.accessq_back());
+    inst.accessq_pop_back();
+  }
+  return taken;
+}
+
+static bool same_accesses(const std::vector<mem_access_t> &x,
+                          const std::vector<mem_access_t> &y) {
+  if (x.size() != y.size()) return false;
+  for (unsigned i = 0; i < x.size(); i++) {
+    if (x[i].get_addr() != y[i].get_addr() ||
+        x[i].get_size() != y[i].get_size() ||
+        x[i].get_type() != y[i].get_type() ||
+        x[i].is_write() != y[i].is_write() ||
+        x[i].get_warp_mask() != y[i].get_warp_mask() ||
+        x[i].get_byte_mask() != y[i].get_byte_mask() ||
+        x[i].get_sector_mask() != y[i].get_sector_mask())
+      return false;
+  }
+  return true;
+}
+
+static void print_accesses(const char *name,
+                           const std::vector<mem_access_t> &accesses) {
+  fprintf(stderr, "  %s:\n", name);
+  for (unsigned i = 0; i < accesses.size(); i++)
+    fprintf(stderr, "    addr=0x%llx size=%u warp_mask=%s sectors=%s\n",
+            accesses[i].get_addr(), accesses[i].get_size(),
+            accesses[i].get_warp_mask().to_string().c_str(),
+            accesses[i].get_sector_mask().to_string().c_str());
+}
+
+enum access_pattern {
+  PATTERN_BROADCAST,
+  PATTERN_UNIT_STRIDE,
+  PATTERN_STRIDED,
+  PATTERN_REVERSED,
+  PATTERN_RANDOM,
+  PATTERN_GROUPED,
+  PATTERN_MISALIGNED,
+  PATTERN_MULTI_ACCESS,
+  N_PATTERNS
+};
+
+struct warp_addresses {
+  new_addr_type addr[MAX_WARP_SIZE][MAX_ACCESSES_PER_INSN_PER_THREAD];
+  unsigned n_accesses[MAX_WARP_SIZE];
+};
+
+static void generate_addresses(unsigned long long &seed, unsigned warp_size,
+                               int pattern, unsigned data_size,
+                               warp_addresses &w) {
+  // above 4GB now and then, so that block addresses need all 64 bits
+  new_addr_type base = 0x1000 + (lcg(seed) % 0xfffff) * 256;
+  if (lcg(seed) % 4 == 0) base += (1 + lcg(seed) % 15) * (1ULL << 32);
+  unsigned stride = data_size * (2 + lcg(seed) % 40);
+  unsigned window = 128 << (lcg(seed) % 14);
+  unsigned group = 1 << (lcg(seed) % 6);
+  bool groups_ascending = lcg(seed) % 2;
+  unsigned misalign = 1 + lcg(seed) % 15;
+  for (unsigned t = 0; t < warp_size; t++) {
+    new_addr_type a = base;
+    switch (pattern) {
+      case PATTERN_BROADCAST:
+        break;
+      case PATTERN_UNIT_STRIDE:
+        a += t * data_size;
+        break;
+      case PATTERN_STRIDED:
+        a += t * stride;
+        break;
+      case PATTERN_REVERSED:
+        a += (warp_size - 1 - t) * data_size;
+        break;
+      case PATTERN_RANDOM:
+        a += (lcg(seed) % window) / data_size * data_size;
+        break;
+      case PATTERN_GROUPED: {
+        unsigned g = t / group;
+        unsigned segment = groups_ascending ? g * (1 + g % 3) : lcg(seed) % 8;
+        a += segment * 128 + (t % group) * data_size % 128;
+        break;
+      }
+      case PATTERN_MISALIGNED:
+        a += t * data_size + misalign;
+        break;
+    }
+    w.addr[t][0] = a;
+    w.n_accesses[t] = 1;
+    if (pattern == PATTERN_MULTI_ACCESS) {
+      // local accesses over 4B are split into 4B chunks
+      w.n_accesses[t] = 1 + lcg(seed) % MAX_ACCESSES_PER_INSN_PER_THREAD;
+      w.addr[t][0] = base + t * 4 * w.n_accesses[t];
+      for (unsigned i = 1; i < w.n_accesses[t]; i++)
+        w.addr[t][i] = w.addr[t][0] + 4 * i;
+    }
+  }
+}
+
+static active_mask_t generate_mask(unsigned long long &seed,
+                                   unsigned warp_size) {
+  active_mask_t mask;
+  unsigned kind = lcg(seed) % 10;
+  for (unsigned t = 0; t < warp_size; t++) {
+    if (kind < 6)
+      mask.set(t);
+    else if (kind < 9)
+      mask.set(t, lcg(seed) % 2);
+    else
+      mask.set(t, lcg(seed) % 8 == 0);
+  }
+  return mask;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <gpgpusim.config> [warps] [seed]\n", argv[0]);
+    return 2;
+  }
+  unsigned n_warps = argc > 2 ? strtoul(argv[2], NULL, 0) : 200000;
+  unsigned long long seed = argc > 3 ? strtoull(argv[3], NULL, 0) : 1;
+
+  gpgpu_context *ctx = new gpgpu_context();
+  gpgpu_sim *gpu = test_create_gpu(ctx, argv[1], std::vector<const char *>());
+  const shader_core_config *config = gpu->getShaderCoreConfig();
+  unsigned warp_size = config->warp_size;
+  const unsigned data_sizes[] = {1, 2, 4, 8, 16};
+
+  unsigned long long n_sorted = 0, n_general = 0, n_cached = 0;
+  for (unsigned w = 0; w < n_warps; w++) {
+    int pattern = lcg(seed) % N_PATTERNS;
+    unsigned data_size = data_sizes[lcg(seed) % 5];
+    if (pattern == PATTERN_MULTI_ACCESS) data_size = 4;
+    // the segment sizes memory_coalescing_arch() picks for data_size
+    unsigned segment_size = 32;
+    if (data_size > 1 && lcg(seed) % 2) segment_size = data_size == 2 ? 64 : 128;
+    unsigned warp_parts = 1 << (lcg(seed) % 3);
+    bool is_write = lcg(seed) % 2;
+    mem_access_type access_type = is_write ? GLOBAL_ACC_W : GLOBAL_ACC_R;
+
+    warp_addresses addrs;
+    generate_addresses(seed, warp_size, pattern, data_size, addrs);
+    warp_inst_t inst(config);
+    inst.set_active(generate_mask(seed, warp_size));
+    for (unsigned t = 0; t < warp_size; t++)
+      inst.set_addr(t, addrs.addr[t], addrs.n_accesses[t]);
+
+    unsigned subwarp_size = warp_size / warp_parts;
+    for (unsigned first = 0; first < warp_size; first += subwarp_size) {
+      unsigned last = first + subwarp_size;
+      if (!inst.memory_coalescing_arch_sorted(is_write, access_type, first,
+                                              last, segment_size, data_size)) {
+        if (inst.accessq_count() != 0) {
+          fprintf(stderr, "FAIL warp %u: rejected subwarp left accesses\n", w);
+          return 1;
+        }
+        n_general++;
+        continue;
+      }
+      std::vector<mem_access_t> sorted = take_accesses(inst, 0);
+      inst.memory_coalescing_arch_general(is_write, access_type, first, last,
+                                          segment_size, data_size);
+      std::vector<mem_access_t> general = take_accesses(inst, 0);
+      if (!same_accesses(sorted, general)) {
+        fprintf(stderr,
+                "FAIL warp %u: pattern %d, data size %u, segment size %u, "
+                "lanes [%u, %u)\n",
+                w, pattern, data_size, segment_size, first, last);
+        print_accesses("sorted", sorted);
+        print_accesses("general", general);
+        return 1;
+      }
+      n_sorted++;
+    }
+
+    // texture and constant loads: one access per cache block touched
+    if (pattern == PATTERN_MULTI_ACCESS || pattern == PATTERN_MISALIGNED)
+      continue;
+    bool tex = lcg(seed) % 2;
+    warp_inst_t load(config);
+    load.op = LOAD_OP;
+    load.space = memory_space_t(tex ? tex_space : const_space);
+    load.data_size = data_size;
+    active_mask_t mask = generate_mask(seed, warp_size);
+    load.issue(mask, 0, 0, 0, 0, 1);
+    for (unsigned t = 0; t < warp_size; t++)
+      load.set_addr(t, addrs.addr[t][0]);
+    load.generate_mem_accesses();
+    std::vector<mem_access_t> generated = take_accesses(load, 0);
+
+    new_addr_type block_size = tex ? config->gpgpu_cache_texl1_linesize
+                                   : config->gpgpu_cache_constl1_linesize;
+    std::map<new_addr_type, active_mask_t> blocks;
+    mem_access_byte_mask_t byte_mask;
+    for (unsigned t = 0; t < warp_size; t++) {
+      if (!mask.test(t)) continue;
+      new_addr_type addr = addrs.addr[t][0];
+      new_addr_type block = addr & ~(block_size - 1);
+      blocks[block].set(t);
+      for (unsigned i = 0; i < data_size; i++)
+        byte_mask.set(addr - block + i);
+    }
+    std::vector<mem_access_t> reference;
+    std::map<new_addr_type, active_mask_t>::iterator b;
+    for (b = blocks.begin(); b != blocks.end(); ++b)
+      reference.push_back(mem_access_t(
+          tex ? TEXTURE_ACC_R : CONST_ACC_R, b->first, block_size, false,
+          b->second, byte_mask, mem_access_sector_mask_t(), ctx));
+    if (mask.none()) reference.clear();  // predicated off
+    if (!same_accesses(generated, reference)) {
+      fprintf(stderr, "FAIL warp %u: %s load, pattern %d, data size %u\n", w,
+              tex ? "texture" : "constant", pattern, data_size);
+      print_accesses("generated", generated);
+      print_accesses("reference", reference);
+      return 1;
+    }
+    n_cached++;
+  }
+
+  if (n_sorted == 0 || n_general == 0) {
+    fprintf(stderr, "FAIL: %llu sorted and %llu general subwarps\n", n_sorted,
+            n_general);
+    return 1;
+  }
+  printf(
+      "PASS: %llu subwarps matched the general coalescer, %llu took it, "
+      "%llu texture/constant loads\n",
+      n_sorted, n_general, n_cached);
+  return 0;
+}
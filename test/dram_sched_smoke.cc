@@ -0,0 +1,145 @@
+// Smoke run of one DRAM channel under a -gpgpu_dram_sched_policy: a mix of
+// row-local and scattered reads and writes is pushed into dram_t and every
+// request must come back through the return queue, with each scheduled
+// access counted once in the row-buffer statistics.
+//
+// The requests come from two kernels: a heavy one that issues most of them in
+// runs of row hits, and a light one that issues the rest one at a time.  The
+// application-aware policies (parbs, atlas, bliss) must serve the light
+// kernel with a lower mean latency than the heavy one, as each of them ranks
+// the source with less load, attained service or streak first.  atlas runs
+// with a quantum and threshold short enough to rerank and to age requests
+// within the run.
+//
+// usage: dram_sched_smoke <gpgpusim.config> [policy]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+#include "../src/gpgpu-sim/dram.h"
+#include "../src/gpgpu-sim/gpu-sim.h"
+#include "../src/gpgpu-sim/l2cache.h"
+#include "../src/gpgpu-sim/mem_fetch.h"
+#include "../src/gpgpu-sim/mem_latency_stat.h"
+#include "sim_setup.h"
+
+#define SMOKE_N_REQUESTS 4000
+#define SMOKE_MAX_CYCLES 1000000
+#define SMOKE_HEAVY_KERNEL 1
+#define SMOKE_LIGHT_KERNEL 2
+
+static unsigned long long lcg(unsigned long long &state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 17;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <gpgpusim.config> [policy]\n", argv[0]);
+    return 2;
+  }
+  const char *policy = argc > 2 ? argv[2] : "frfcfs";
+  std::vector<const char *> options;
+  options.push_back("-gpgpu_dram_scheduler");
+  options.push_back("1");
+  options.push_back("-gpgpu_dram_sched_policy");
+  options.push_back(policy);
+  options.push_back("-dram_atlas_quantum");
+  options.push_back("500");
+  options.push_back("-dram_atlas_threshold");
+  options.push_back("1000");
+
+  gpgpu_context *ctx = new gpgpu_context();
+  gpgpu_sim *gpu = test_create_gpu(ctx, argv[1], options);
+  const memory_config *mem_config = gpu->getMemoryConfig();
+  const shader_core_config *shader_config = gpu->getShaderCoreConfig();
+  gpu->gpu_sim_cycle = 0;
+  gpu->gpu_tot_sim_cycle = 0;
+
+  memory_stats_t stats(shader_config->num_shader(), shader_config, mem_config,
+                       gpu);
+  memory_partition_unit partition(0, mem_config, &stats, gpu);
+  dram_t dram(0, mem_config, &stats, &partition, gpu);
+  mem_fetch_pool pool("dram_sched_smoke", false);
+
+  // requests for channel 0: the heavy kernel issues 7 in 8 of them, in runs
+  // of consecutive sectors (row hits) from random rows, the light kernel
+  // single sectors
+  unsigned long long seed = 1;
+  std::vector<mem_fetch *> requests;
+  while (requests.size() < SMOKE_N_REQUESTS) {
+    new_addr_type base = (lcg(seed) % (1ULL << 30)) & ~(new_addr_type)0xff;
+    addrdec_t tlx;
+    mem_config->m_address_mapping.addrdec_tlx(base, &tlx);
+    if (tlx.chip != 0) continue;
+    bool light = lcg(seed) % 8 == 0;
+    unsigned run = light ? 1 : 1 + lcg(seed) % 8;
+    bool write = lcg(seed) % 4 == 0;
+    unsigned sid = lcg(seed) % shader_config->num_shader();
+    for (unsigned k = 0; k < run && requests.size() < SMOKE_N_REQUESTS; k++) {
+      new_addr_type addr = base + 32 * k;
+      mem_config->m_address_mapping.addrdec_tlx(addr, &tlx);
+      if (tlx.chip != 0) break;
+      mem_access_t access(write ? GLOBAL_ACC_W : GLOBAL_ACC_R, addr, 32,
+                          write, ctx);
+      mem_fetch *mf = new (&pool) mem_fetch(
+          access, NULL, write ? WRITE_PACKET_SIZE : READ_PACKET_SIZE,
+          sid % 64, sid, sid, mem_config, 0);
+      mf->set_kernel_uid(light ? SMOKE_LIGHT_KERNEL : SMOKE_HEAVY_KERNEL);
+      requests.push_back(mf);
+    }
+  }
+
+  // latency from push to return, summed per kernel
+  std::map<mem_fetch *, unsigned long long> push_cycle;
+  std::map<unsigned, unsigned long long> latency, count;
+  unsigned pushed = 0, returned = 0;
+  while (returned < requests.size()) {
+    if (gpu->gpu_sim_cycle == SMOKE_MAX_CYCLES) {
+      fprintf(stderr,
+              "FAIL %s: %u of %zu requests returned after %u cycles\n",
+              policy, returned, requests.size(), SMOKE_MAX_CYCLES);
+      return 1;
+    }
+    if (pushed < requests.size() &&
+        !dram.full(requests[pushed]->get_is_write())) {
+      push_cycle[requests[pushed]] = gpu->gpu_sim_cycle;
+      dram.push(requests[pushed++]);
+    }
+    dram.cycle();
+    while (mem_fetch *mf = dram.return_queue_pop()) {
+      latency[mf->get_kernel_uid()] += gpu->gpu_sim_cycle - push_cycle[mf];
+      count[mf->get_kernel_uid()]++;
+      returned++;
+      delete mf;
+    }
+    gpu->gpu_sim_cycle++;
+  }
+
+  unsigned long long accesses = 0;
+  for (unsigned b = 0; b < mem_config->nbk; b++)
+    accesses += stats.row_access[0][b];
+  if (accesses != requests.size()) {
+    fprintf(stderr, "FAIL %s: %llu row accesses recorded for %zu requests\n",
+            policy, accesses, requests.size());
+    return 1;
+  }
+
+  double heavy = (double)latency[SMOKE_HEAVY_KERNEL] / count[SMOKE_HEAVY_KERNEL];
+  double light = (double)latency[SMOKE_LIGHT_KERNEL] / count[SMOKE_LIGHT_KERNEL];
+  if (strcmp(policy, "frfcfs") && light >= heavy) {
+    fprintf(stderr,
+            "FAIL %s: light kernel latency %.1f is not below the heavy "
+            "kernel's %.1f\n",
+            policy, light, heavy);
+    return 1;
+  }
+  printf("PASS %s: %zu requests in %llu cycles, mean latency heavy %.1f "
+         "light %.1f\n",
+         policy, requests.size(), gpu->gpu_sim_cycle, heavy, light);
+  delete gpu;
+  return 0;
+}
@@ -0,0 +1,263 @@
+// Microbenchmark of fifo_pipeline against the linked-list implementation it
+// replaced.  Each workload is run on both queues with the same operation
+// stream; the popped entries are checksummed so that a behavioural
+// difference shows up as a failure rather than as a faster number.
+//
+// usage: fifo_pipeline_bench [operations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+
+#include "../src/gpgpu-sim/delayqueue.h"
+
+static unsigned long long g_n_alloc = 0;
+
+void *operator new(size_t size) {
+  g_n_alloc++;
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// fifo_pipeline as it was before it moved to a ring buffer
+template <class T>
+struct list_fifo_data {
+  T *m_data;
+  list_fifo_data *m_next;
+};
+
+template <class T>
+class list_fifo_pipeline {
+ public:
+  list_fifo_pipeline(const char *nm, unsigned int minlen,
+                     unsigned int maxlen) {
+    assert(maxlen);
+    m_name = nm;
+    m_min_len = minlen;
+    m_max_len = maxlen;
+    m_length = 0;
+    m_n_element = 0;
+    m_head = NULL;
+    m_tail = NULL;
+    for (unsigned i = 0; i < m_min_len; i++) push(NULL);
+  }
+
+  ~list_fifo_pipeline() {
+    while (m_head) {
+      m_tail = m_head;
+      m_head = m_head->m_next;
+      delete m_tail;
+    }
+  }
+
+  void push(T *data) {
+    assert(m_length < m_max_len);
+    if (m_head) {
+      if (m_tail->m_data || m_length < m_min_len) {
+        m_tail->m_next = new list_fifo_data<T>();
+        m_tail = m_tail->m_next;
+        m_length++;
+        m_n_element++;
+      }
+    } else {
+      m_head = m_tail = new list_fifo_data<T>();
+      m_length++;
+      m_n_element++;
+    }
+    m_tail->m_next = NULL;
+    m_tail->m_data = data;
+  }
+
+  T *pop() {
+    list_fifo_data<T> *next;
+    T *data;
+    if (m_head) {
+      next = m_head->m_next;
+      data = m_head->m_data;
+      if (m_head == m_tail) {
+        assert(next == NULL);
+        m_tail = NULL;
+      }
+      delete m_head;
+      m_head = next;
+      m_length--;
+      if (m_length == 0) {
+        assert(m_head == NULL);
+        m_tail = m_head;
+      }
+      m_n_element--;
+      if (m_min_len && m_length < m_min_len) {
+        push(NULL);
+        m_n_element--;
+      }
+    } else {
+      data = NULL;
+    }
+    return data;
+  }
+
+  T *top() const { return m_head ? m_head->m_data : NULL; }
+
+  void set_min_length(unsigned int new_min_len) {
+    if (new_min_len == m_min_len) return;
+
+    if (new_min_len > m_min_len) {
+      m_min_len = new_min_len;
+      while (m_length < m_min_len) {
+        push(NULL);
+        m_n_element--;
+      }
+    } else {
+      assert(m_head);
+      m_min_len = new_min_len;
+      while ((m_length > m_min_len) && (m_tail->m_data == 0)) {
+        list_fifo_data<T> *iter;
+        iter = m_head;
+        while (iter && (iter->m_next != m_tail)) iter = iter->m_next;
+        if (!iter) {
+          assert(m_head->m_data == 0);
+          pop();
+        } else {
+          assert(iter->m_next == m_tail);
+          delete m_tail;
+          m_tail = iter;
+          m_tail->m_next = 0;
+          m_length--;
+        }
+      }
+    }
+  }
+
+  bool full() const { return (m_max_len && m_length >= m_max_len); }
+  bool empty() const { return m_head == NULL; }
+  unsigned get_n_element() const { return m_n_element; }
+  unsigned get_length() const { return m_length; }
+
+ private:
+  const char *m_name;
+
+  unsigned int m_min_len;
+  unsigned int m_max_len;
+  unsigned int m_length;
+  unsigned int m_n_element;
+
+  list_fifo_data<T> *m_head;
+  list_fifo_data<T> *m_tail;
+};
+
+struct bench_result {
+  double ns_per_op;
+  double alloc_per_op;
+  unsigned long long checksum;
+};
+
+static unsigned lcg(unsigned long long &state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> 33;
+}
+
+static int g_items[4096];
+
+static void consume(int *p, unsigned long long &sum) {
+  sum = sum * 31 + (p ? (unsigned long long)(p - g_items) + 1 : 0);
+}
+
+// a latency queue as used for the ROP, DRAM and L2 delays: one push and one
+// pop per cycle into a queue padded with bubbles to min_len
+template <class Q>
+static void run_delay(unsigned long long n_ops, unsigned long long &sum) {
+  Q q("delay", 100, 200);
+  unsigned long long seed = 1;
+  for (unsigned long long i = 0; i < n_ops; i += 2) {
+    if (lcg(seed) % 4 != 0) q.push(&g_items[i % 4096]);
+    consume(q.pop(), sum);
+  }
+}
+
+// a bounded queue between units: bursts of pushes while not full, drained
+// at a different rate
+template <class Q>
+static void run_queue(unsigned long long n_ops, unsigned long long &sum) {
+  Q q("queue", 0, 64);
+  unsigned long long seed = 2;
+  for (unsigned long long i = 0; i < n_ops;) {
+    unsigned r = lcg(seed);
+    if (r % 2 == 0 && !q.full()) {
+      q.push(&g_items[i % 4096]);
+      i++;
+    } else if (!q.empty()) {
+      consume(q.pop(), sum);
+      i++;
+    }
+  }
+}
+
+// a delay queue whose latency is changed at run time: each change pads or
+// trims trailing bubbles
+template <class Q>
+static void run_resize(unsigned long long n_ops, unsigned long long &sum) {
+  Q q("resize", 8, 256);
+  unsigned long long seed = 3;
+  for (unsigned long long i = 0; i < n_ops; i += 3) {
+    q.set_min_length(8 + lcg(seed) % 120);
+    if (lcg(seed) % 8 == 0) q.push(&g_items[i % 4096]);
+    consume(q.pop(), sum);
+  }
+}
+
+static bench_result run(void (*workload)(unsigned long long,
+                                         unsigned long long &),
+                        unsigned long long n_ops) {
+  bench_result r;
+  r.checksum = 0;
+  unsigned long long alloc_before = g_n_alloc;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  workload(n_ops, r.checksum);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  r.ns_per_op =
+      std::chrono::duration<double, std::nano>(end - start).count() / n_ops;
+  r.alloc_per_op = (double)(g_n_alloc - alloc_before) / n_ops;
+  return r;
+}
+
+struct workload_desc {
+  const char *name;
+  void (*ring)(unsigned long long, unsigned long long &);
+  void (*list)(unsigned long long, unsigned long long &);
+};
+
+int main(int argc, const char *argv[]) {
+  unsigned long long n_ops = argc > 1 ? strtoull(argv[1], NULL, 0) : 20000000;
+  workload_desc workloads[] = {
+      {"delay", run_delay<fifo_pipeline<int> >,
+       run_delay<list_fifo_pipeline<int> >},
+      {"queue", run_queue<fifo_pipeline<int> >,
+       run_queue<list_fifo_pipeline<int> >},
+      {"resize", run_resize<fifo_pipeline<int> >,
+       run_resize<list_fifo_pipeline<int> >},
+  };
+
+  int failed = 0;
+  printf("%-8s %12s %12s %12s %12s %8s\n", "workload", "ring ns/op",
+         "list ns/op", "ring new/op", "list new/op", "speedup");
+  for (unsigned w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+    bench_result ring = run(workloads[w].ring, n_ops);
+    bench_result list = run(workloads[w].list, n_ops);
+    printf("%-8s %12.2f %12.2f %12.3f %12.3f %7.2fx\n", workloads[w].name,
+           ring.ns_per_op, list.ns_per_op, ring.alloc_per_op,
+           list.alloc_per_op, list.ns_per_op / ring.ns_per_op);
+    if (ring.checksum != list.checksum) {
+      fprintf(stderr, "FAIL %s: popped entries differ\n", workloads[w].name);
+      failed = 1;
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,178 @@
+// Instructions per second of the functional PTX interpreter with pre-decoded
+// dispatch (-gpgpu_ptx_predecode 1) and with the per-execution switch on the
+// opcode (-gpgpu_ptx_predecode 0).  Both runs execute the same PTX kernel
+// through gpgpu_cuda_ptx_sim_main_func(), each in its own process so that
+// they start from the same state, and must produce the same output and
+// instruction count.
+//
+// usage: ptx_dispatch_bench <gpgpusim.config> [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+#include "../src/cuda-sim/ptx_ir.h"
+#include "sim_setup.h"
+
+#define BENCH_N_CTAS 16
+#define BENCH_CTA_SIZE 256
+
+// integer and floating point arithmetic with a divergent branch in a loop
+static const char *g_bench_ptx =
+    ".version 6.4\n"
+    ".target sm_70\n"
+    ".address_size 64\n"
+    "\n"
+    ".visible .entry dispatch_bench(\n"
+    "  .param .u64 dispatch_bench_param_0,\n"
+    "  .param .u32 dispatch_bench_param_1\n"
+    ")\n"
+    "{\n"
+    "  .reg .pred %p<3>;\n"
+    "  .reg .b32 %r<12>;\n"
+    "  .reg .f32 %f<4>;\n"
+    "  .reg .b64 %rd<5>;\n"
+    "\n"
+    "  ld.param.u64 %rd1, [dispatch_bench_param_0];\n"
+    "  ld.param.u32 %r1, [dispatch_bench_param_1];\n"
+    "  cvta.to.global.u64 %rd2, %rd1;\n"
+    "  mov.u32 %r2, %tid.x;\n"
+    "  mov.u32 %r3, %ctaid.x;\n"
+    "  mov.u32 %r4, %ntid.x;\n"
+    "  mad.lo.s32 %r5, %r3, %r4, %r2;\n"
+    "  cvt.rn.f32.s32 %f1, %r5;\n"
+    "  mov.f32 %f2, 0f3F800000;\n"
+    "  mov.u32 %r6, 0;\n"
+    "  mov.u32 %r7, %r5;\n"
+    "  mov.u32 %r8, 0;\n"
+    "LOOP:\n"
+    "  fma.rn.f32 %f2, %f2, 0f3F7FF000, %f1;\n"
+    "  mul.lo.s32 %r7, %r7, 1103515245;\n"
+    "  add.s32 %r7, %r7, 12345;\n"
+    "  shr.u32 %r9, %r7, 16;\n"
+    "  and.b32 %r10, %r9, 1;\n"
+    "  setp.eq.u32 %p1, %r10, 0;\n"
+    "  @%p1 bra SKIP;\n"
+    "  xor.b32 %r8, %r8, %r9;\n"
+    "  min.u32 %r8, %r8, 1000000;\n"
+    "SKIP:\n"
+    "  add.s32 %r6, %r6, 1;\n"
+    "  setp.lt.u32 %p2, %r6, %r1;\n"
+    "  @%p2 bra LOOP;\n"
+    "  cvt.rzi.u32.f32 %r11, %f2;\n"
+    "  add.s32 %r8, %r8, %r11;\n"
+    "  mul.wide.s32 %rd3, %r5, 4;\n"
+    "  add.s64 %rd4, %rd2, %rd3;\n"
+    "  st.global.u32 [%rd4], %r8;\n"
+    "  ret;\n"
+    "}\n";
+
+struct bench_result {
+  unsigned long long insn;
+  double seconds;
+  unsigned long long checksum;
+};
+
+static bench_result run_kernel(const char *config_file, const char *predecode,
+                               unsigned iterations) {
+  std::vector<const char *> options;
+  options.push_back("-gpgpu_ptx_predecode");
+  options.push_back(predecode);
+  gpgpu_context *ctx = new gpgpu_context();
+  gpgpu_sim *gpu = test_create_gpu(ctx, config_file, options);
+
+  // loaded from a file: the string loader parses _<n>.ptx of the working
+  // directory first, which only exists for -save_embedded_ptx
+  char ptx_file[] = "/tmp/ptx_dispatch_bench_XXXXXX";
+  int fd = mkstemp(ptx_file);
+  if (fd < 0 || write(fd, g_bench_ptx, strlen(g_bench_ptx)) < 0) abort();
+  close(fd);
+  symbol_table *symtab = ctx->gpgpu_ptx_sim_load_ptx_from_filename(ptx_file);
+  unlink(ptx_file);
+  function_info *entry = symtab->lookup_function("dispatch_bench");
+  // what ptxas would report for the kernel
+  gpgpu_ptx_sim_info info;
+  memset(&info, 0, sizeof(info));
+  info.regs = 16;
+  entry->set_kernel_info(info);
+
+  unsigned n_threads = BENCH_N_CTAS * BENCH_CTA_SIZE;
+  void *out = gpu->gpu_malloc(n_threads * sizeof(unsigned));
+  gpgpu_ptx_sim_arg out_arg(&out, sizeof(out), 0);
+  gpgpu_ptx_sim_arg iter_arg(&iterations, sizeof(iterations), sizeof(out));
+  entry->add_param_data(0, &out_arg);
+  entry->add_param_data(1, &iter_arg);
+  kernel_info_t kernel(dim3(BENCH_N_CTAS, 1, 1), dim3(BENCH_CTA_SIZE, 1, 1),
+                       entry);
+  entry->finalize(kernel.get_param_memory());
+  ctx->func_sim->g_ptx_kernel_count++;
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  ctx->func_sim->gpgpu_cuda_ptx_sim_main_func(kernel, true);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  std::vector<unsigned> result(n_threads);
+  gpu->memcpy_from_gpu(&result[0], (size_t)out, n_threads * sizeof(unsigned));
+  bench_result r;
+  r.insn = ctx->func_sim->g_ptx_sim_num_insn;
+  r.seconds = std::chrono::duration<double>(end - start).count();
+  r.checksum = 0;
+  for (unsigned i = 0; i < n_threads; i++)
+    r.checksum = r.checksum * 31 + result[i];
+  return r;
+}
+
+// runs one mode in a child process with the simulator's output discarded
+static bool run_mode(const char *config_file, const char *predecode,
+                     unsigned iterations, bench_result &r) {
+  int fd[2];
+  if (pipe(fd)) return false;
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    close(fd[0]);
+    if (!freopen("/dev/null", "w", stdout)) _exit(1);
+    bench_result child = run_kernel(config_file, predecode, iterations);
+    _exit(write(fd[1], &child, sizeof(child)) == sizeof(child) ? 0 : 1);
+  }
+  close(fd[1]);
+  bool ok = read(fd[0], &r, sizeof(r)) == sizeof(r);
+  close(fd[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <gpgpusim.config> [iterations]\n", argv[0]);
+    return 2;
+  }
+  unsigned iterations = argc > 2 ? strtoul(argv[2], NULL, 0) : 400;
+
+  bench_result predecoded, switched;
+  if (!run_mode(argv[1], "1", iterations, predecoded) ||
+      !run_mode(argv[1], "0", iterations, switched)) {
+    fprintf(stderr, "FAIL: functional simulation did not complete\n");
+    return 1;
+  }
+  printf("%-12s %14s %10s %14s\n", "dispatch", "instructions", "seconds",
+         "inst/sec");
+  printf("%-12s %14llu %10.3f %14.0f\n", "pre-decoded", predecoded.insn,
+         predecoded.seconds, predecoded.insn / predecoded.seconds);
+  printf("%-12s %14llu %10.3f %14.0f\n", "switch", switched.insn,
+         switched.seconds, switched.insn / switched.seconds);
+  printf("speedup %.2fx\n", switched.seconds / predecoded.seconds);
+  if (predecoded.insn != switched.insn ||
+      predecoded.checksum != switched.checksum) {
+    fprintf(stderr, "FAIL: the dispatch modes produced different results\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,183 @@
+// Instructions per second of the functional PTX interpreter with warp-wide
+// execution (-gpgpu_ptx_warp_exec 1) and with every lane executed by
+// ptx_exec_inst() (-gpgpu_ptx_warp_exec 0).  Both runs execute the same PTX
+// kernel through gpgpu_cuda_ptx_sim_main_func(), each in its own process so
+// that they start from the same state, and must produce the same output and
+// instruction count.  The loop body is made of the instructions the warp-wide
+// path covers: integer and floating point mad/mul/fma/add, setp and global
+// and shared ld/st, plus the branch that closes the loop.
+//
+// usage: ptx_warp_exec_bench <gpgpusim.config> [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+#include "../src/cuda-sim/ptx_ir.h"
+#include "sim_setup.h"
+
+#define BENCH_N_CTAS 16
+#define BENCH_CTA_SIZE 256
+
+static const char *g_bench_ptx =
+    ".version 6.4\n"
+    ".target sm_70\n"
+    ".address_size 64\n"
+    "\n"
+    ".visible .entry warp_exec_bench(\n"
+    "  .param .u64 warp_exec_bench_param_0,\n"
+    "  .param .u32 warp_exec_bench_param_1\n"
+    ")\n"
+    "{\n"
+    "  .reg .pred %p<3>;\n"
+    "  .reg .b32 %r<14>;\n"
+    "  .reg .f32 %f<3>;\n"
+    "  .reg .b64 %rd<8>;\n"
+    "  .shared .align 4 .b8 warp_exec_bench_smem[1024];\n"
+    "\n"
+    "  ld.param.u64 %rd1, [warp_exec_bench_param_0];\n"
+    "  ld.param.u32 %r1, [warp_exec_bench_param_1];\n"
+    "  cvta.to.global.u64 %rd2, %rd1;\n"
+    "  mov.u32 %r2, %tid.x;\n"
+    "  mov.u32 %r3, %ctaid.x;\n"
+    "  mov.u32 %r4, %ntid.x;\n"
+    "  mad.lo.s32 %r5, %r3, %r4, %r2;\n"
+    "  mul.wide.u32 %rd3, %r5, 4;\n"
+    "  add.s64 %rd4, %rd2, %rd3;\n"
+    "  mov.u64 %rd5, warp_exec_bench_smem;\n"
+    "  mul.wide.u32 %rd6, %r2, 4;\n"
+    "  add.s64 %rd7, %rd5, %rd6;\n"
+    "  cvt.rn.f32.s32 %f1, %r5;\n"
+    "  mov.f32 %f2, 0f3F800000;\n"
+    "  mov.u32 %r6, 0;\n"
+    "  mov.u32 %r7, %r5;\n"
+    "  st.global.u32 [%rd4], %r5;\n"
+    "LOOP:\n"
+    "  ld.global.u32 %r8, [%rd4];\n"
+    "  mad.lo.s32 %r7, %r7, 1103515245, %r8;\n"
+    "  fma.rn.f32 %f2, %f2, 0f3F7FF000, %f1;\n"
+    "  mul.lo.s32 %r9, %r7, 3;\n"
+    "  st.shared.u32 [%rd7], %r9;\n"
+    "  ld.shared.u32 %r10, [%rd7];\n"
+    "  add.s32 %r11, %r10, %r6;\n"
+    "  setp.gt.u32 %p1, %r11, %r8;\n"
+    "  @%p1 st.global.u32 [%rd4], %r11;\n"
+    "  add.s32 %r6, %r6, 1;\n"
+    "  setp.lt.u32 %p2, %r6, %r1;\n"
+    "  @%p2 bra LOOP;\n"
+    "  cvt.rzi.u32.f32 %r12, %f2;\n"
+    "  ld.global.u32 %r13, [%rd4];\n"
+    "  add.s32 %r13, %r13, %r12;\n"
+    "  st.global.u32 [%rd4], %r13;\n"
+    "  ret;\n"
+    "}\n";
+
+struct bench_result {
+  unsigned long long insn;
+  double seconds;
+  unsigned long long checksum;
+};
+
+static bench_result run_kernel(const char *config_file, const char *warp_exec,
+                               unsigned iterations) {
+  std::vector<const char *> options;
+  options.push_back("-gpgpu_ptx_warp_exec");
+  options.push_back(warp_exec);
+  gpgpu_context *ctx = new gpgpu_context();
+  gpgpu_sim *gpu = test_create_gpu(ctx, config_file, options);
+
+  // loaded from a file: the string loader parses _<n>.ptx of the working
+  // directory first, which only exists for -save_embedded_ptx
+  char ptx_file[] = "/tmp/ptx_warp_exec_bench_XXXXXX";
+  int fd = mkstemp(ptx_file);
+  if (fd < 0 || write(fd, g_bench_ptx, strlen(g_bench_ptx)) < 0) abort();
+  close(fd);
+  symbol_table *symtab = ctx->gpgpu_ptx_sim_load_ptx_from_filename(ptx_file);
+  unlink(ptx_file);
+  function_info *entry = symtab->lookup_function("warp_exec_bench");
+  // what ptxas would report for the kernel
+  gpgpu_ptx_sim_info info;
+  memset(&info, 0, sizeof(info));
+  info.regs = 24;
+  info.smem = 1024;
+  entry->set_kernel_info(info);
+
+  unsigned n_threads = BENCH_N_CTAS * BENCH_CTA_SIZE;
+  void *out = gpu->gpu_malloc(n_threads * sizeof(unsigned));
+  gpgpu_ptx_sim_arg out_arg(&out, sizeof(out), 0);
+  gpgpu_ptx_sim_arg iter_arg(&iterations, sizeof(iterations), sizeof(out));
+  entry->add_param_data(0, &out_arg);
+  entry->add_param_data(1, &iter_arg);
+  kernel_info_t kernel(dim3(BENCH_N_CTAS, 1, 1), dim3(BENCH_CTA_SIZE, 1, 1),
+                       entry);
+  entry->finalize(kernel.get_param_memory());
+  ctx->func_sim->g_ptx_kernel_count++;
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  ctx->func_sim->gpgpu_cuda_ptx_sim_main_func(kernel, true);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  std::vector<unsigned> result(n_threads);
+  gpu->memcpy_from_gpu(&result[0], (size_t)out, n_threads * sizeof(unsigned));
+  bench_result r;
+  r.insn = ctx->func_sim->g_ptx_sim_num_insn;
+  r.seconds = std::chrono::duration<double>(end - start).count();
+  r.checksum = 0;
+  for (unsigned i = 0; i < n_threads; i++)
+    r.checksum = r.checksum * 31 + result[i];
+  return r;
+}
+
+// runs one mode in a child process with the simulator's output discarded
+static bool run_mode(const char *config_file, const char *warp_exec,
+                     unsigned iterations, bench_result &r) {
+  int fd[2];
+  if (pipe(fd)) return false;
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    close(fd[0]);
+    if (!freopen("/dev/null", "w", stdout)) _exit(1);
+    bench_result child = run_kernel(config_file, warp_exec, iterations);
+    _exit(write(fd[1], &child, sizeof(child)) == sizeof(child) ? 0 : 1);
+  }
+  close(fd[1]);
+  bool ok = read(fd[0], &r, sizeof(r)) == sizeof(r);
+  close(fd[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <gpgpusim.config> [iterations]\n", argv[0]);
+    return 2;
+  }
+  unsigned iterations = argc > 2 ? strtoul(argv[2], NULL, 0) : 400;
+
+  bench_result warp, lane;
+  if (!run_mode(argv[1], "1", iterations, warp) ||
+      !run_mode(argv[1], "0", iterations, lane)) {
+    fprintf(stderr, "FAIL: functional simulation did not complete\n");
+    return 1;
+  }
+  printf("%-12s %14s %10s %14s\n", "execution", "instructions", "seconds",
+         "inst/sec");
+  printf("%-12s %14llu %10.3f %14.0f\n", "warp-wide", warp.insn, warp.seconds,
+         warp.insn / warp.seconds);
+  printf("%-12s %14llu %10.3f %14.0f\n", "per-thread", lane.insn, lane.seconds,
+         lane.insn / lane.seconds);
+  printf("speedup %.2fx\n", lane.seconds / warp.seconds);
+  if (warp.insn != lane.insn || warp.checksum != lane.checksum) {
+    fprintf(stderr, "FAIL: the execution modes produced different results\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+// Builds a performance model the way gpgpu_ptx_sim_init_perf() does, but from
+// a configuration file and option overrides given by the test instead of the
+// gpgpusim.config of the working directory.
+
+#ifndef TEST_SIM_SETUP_H
+#define TEST_SIM_SETUP_H
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "../libcuda/gpgpu_context.h"
+#include "../src/cuda-sim/cuda-sim.h"
+#include "../src/gpgpu-sim/gpu-sim.h"
+#include "../src/gpgpu-sim/icnt_wrapper.h"
+#include "../src/gpgpusim_entrypoint.h"
+#include "../src/option_parser.h"
+
+// options is a list of "-option value" pairs applied after config_file
+static gpgpu_sim *test_create_gpu(gpgpu_context *ctx, const char *config_file,
+                                  const std::vector<const char *> &options) {
+  std::vector<const char *> argv;
+  argv.push_back("");
+  argv.push_back("-config");
+  argv.push_back(config_file);
+  argv.insert(argv.end(), options.begin(), options.end());
+
+  option_parser_t opp = option_parser_create();
+  ctx->ptx_reg_options(opp);
+  ctx->func_sim->ptx_opcocde_latency_options(opp);
+  icnt_reg_options(opp);
+  ctx->the_gpgpusim->g_the_gpu_config = new gpgpu_sim_config(ctx);
+  ctx->the_gpgpusim->g_the_gpu_config->reg_options(opp);
+  option_parser_cmdline(opp, argv.size(), &argv[0]);
+  if (!setlocale(LC_NUMERIC, "C")) abort();
+  ctx->the_gpgpusim->g_the_gpu_config->init();
+
+  ctx->the_gpgpusim->g_simulation_starttime = time((time_t *)NULL);
+  ctx->the_gpgpusim->g_the_gpu =
+      new exec_gpgpu_sim(*(ctx->the_gpgpusim->g_the_gpu_config), ctx);
+  return ctx->the_gpgpusim->g_the_gpu;
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Runs the kernels of test_kernels.h through the timing model with
+// -gpgpu_sim_threads 1 and with several host threads, each in its own
+// process, and compares what they print:
+//
+// - with the default options only the memory system is ticked on the worker
+//   threads, and every kernel must print identical statistics and results;
+// - with -gpgpu_sim_parallel_clusters 1 the SIMT clusters are ticked on them
+//   as well.  threads_diff, whose CTAs do not communicate, must still print
+//   identical statistics.  The CTAs of cta_chain wait for each other through
+//   global memory, so how long they spin may change with the thread schedule,
+//   but the sums they pass along must not.
+//
+// usage: sim_threads_diff <gpgpusim.config> [threads]
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "test_kernels.h"
+
+// compares two runs of kernel, all statistics or just the result line
+static bool compare_runs(const test_kernel &kernel, const char *config_file,
+                         const char *threads, bool parallel_clusters,
+                         bool stats) {
+  std::vector<const char *> serial_options, parallel_options;
+  serial_options.push_back("-gpgpu_sim_threads");
+  serial_options.push_back("1");
+  parallel_options.push_back("-gpgpu_sim_threads");
+  parallel_options.push_back(threads);
+  parallel_options.push_back("-gpgpu_sim_parallel_clusters");
+  parallel_options.push_back(parallel_clusters ? "1" : "0");
+
+  std::vector<std::string> serial, parallel;
+  if (!test_run_child(kernel, config_file, serial_options, serial) ||
+      !test_run_child(kernel, config_file, parallel_options, parallel))
+    return false;
+  if (!stats) {
+    // the result line is the last one printed
+    serial.erase(serial.begin(), serial.end() - 1);
+    parallel.erase(parallel.begin(), parallel.end() - 1);
+  }
+  for (unsigned i = 0; i < serial.size() || i < parallel.size(); i++) {
+    if (i < serial.size() && i < parallel.size() && serial[i] == parallel[i])
+      continue;
+    printf("FAIL: %s with -gpgpu_sim_threads 1 and %s%s differs:\n",
+           kernel.name, threads,
+           parallel_clusters ? " -gpgpu_sim_parallel_clusters 1" : "");
+    printf("  1: %s\n", i < serial.size() ? serial[i].c_str() : "");
+    printf("  %s: %s\n", threads,
+           i < parallel.size() ? parallel[i].c_str() : "");
+    return false;
+  }
+  printf("PASS: %s%s printed the same %s with -gpgpu_sim_threads 1 and %s\n",
+         kernel.name,
+         parallel_clusters ? " with parallel clusters" : "",
+         stats ? "statistics" : "result", threads);
+  return true;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <gpgpusim.config> [threads]\n", argv[0]);
+    return 2;
+  }
+  const char *threads = argc > 2 ? argv[2] : "4";
+
+  bool ok = true;
+  for (unsigned k = 0; k < g_n_test_kernels; k++)
+    ok = compare_runs(g_test_kernels[k], argv[1], threads, false, true) && ok;
+  for (unsigned k = 0; k < g_n_test_kernels; k++) {
+    bool communicates = !strcmp(g_test_kernels[k].name, "cta_chain");
+    ok = compare_runs(g_test_kernels[k], argv[1], threads, true,
+                      !communicates) &&
+         ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+// Runs the kernels of test_kernels.h through the timing model with
+// -gpgpu_stall_fast_forward 0 and 1, each in its own process, and requires
+// both to print identical statistics and results: a core that is stalled on
+// memory must account for its skipped cycles exactly as the full pipeline
+// would.
+//
+// usage: stall_fast_forward_diff <gpgpusim.config>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "test_kernels.h"
+
+static bool compare_runs(const test_kernel &kernel, const char *config_file) {
+  std::vector<const char *> stepped_options, skipped_options;
+  stepped_options.push_back("-gpgpu_stall_fast_forward");
+  stepped_options.push_back("0");
+  skipped_options.push_back("-gpgpu_stall_fast_forward");
+  skipped_options.push_back("1");
+
+  std::vector<std::string> stepped, skipped;
+  if (!test_run_child(kernel, config_file, stepped_options, stepped) ||
+      !test_run_child(kernel, config_file, skipped_options, skipped))
+    return false;
+  for (unsigned i = 0; i < stepped.size() || i < skipped.size(); i++) {
+    if (i < stepped.size() && i < skipped.size() && stepped[i] == skipped[i])
+      continue;
+    printf("FAIL: %s with -gpgpu_stall_fast_forward 0 and 1 differs:\n",
+           kernel.name);
+    printf("  0: %s\n", i < stepped.size() ? stepped[i].c_str() : "");
+    printf("  1: %s\n", i < skipped.size() ? skipped[i].c_str() : "");
+    return false;
+  }
+  printf("PASS: %s printed the same %u lines with -gpgpu_stall_fast_forward "
+         "0 and 1\n",
+         kernel.name, (unsigned)stepped.size());
+  return true;
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <gpgpusim.config>\n", argv[0]);
+    return 2;
+  }
+  bool ok = true;
+  for (unsigned k = 0; k < g_n_test_kernels; k++)
+    ok = compare_runs(g_test_kernels[k], argv[1]) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,387 @@
+// Kernels run through the whole timing model by the tests that compare
+// simulator statistics, with the code that loads, launches and checks them.
+// Each run prints the statistics of gpgpu_sim::print_stats() followed by a
+// "result" line describing what the kernel left in global memory, and returns
+// non-zero if that result is wrong.
+
+#ifndef TEST_TEST_KERNELS_H
+#define TEST_TEST_KERNELS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/cuda-sim/ptx_ir.h"
+#include "sim_setup.h"
+
+// Gathers from a table, exchanges values through shared memory across
+// barriers and ends with a global atomic, so that every clock domain carries
+// traffic.  The CTAs do not communicate otherwise.
+#define THREADS_DIFF_N_CTAS 96
+#define THREADS_DIFF_CTA_SIZE 256
+#define THREADS_DIFF_TABLE_WORDS (1 << 16)
+
+static const char *g_threads_diff_ptx =
+    ".version 6.4\n"
+    ".target sm_70\n"
+    ".address_size 64\n"
+    "\n"
+    ".visible .entry threads_diff(\n"
+    "  .param .u64 threads_diff_param_0,\n"
+    "  .param .u64 threads_diff_param_1,\n"
+    "  .param .u64 threads_diff_param_2\n"
+    ")\n"
+    "{\n"
+    "  .reg .pred %p<3>;\n"
+    "  .reg .b32 %r<20>;\n"
+    "  .reg .b64 %rd<16>;\n"
+    "  .shared .align 4 .b8 exchange[1024];\n"
+    "\n"
+    "  ld.param.u64 %rd1, [threads_diff_param_0];\n"
+    "  ld.param.u64 %rd2, [threads_diff_param_1];\n"
+    "  ld.param.u64 %rd3, [threads_diff_param_2];\n"
+    "  cvta.to.global.u64 %rd1, %rd1;\n"
+    "  cvta.to.global.u64 %rd2, %rd2;\n"
+    "  cvta.to.global.u64 %rd3, %rd3;\n"
+    "  mov.u32 %r2, %tid.x;\n"
+    "  mov.u32 %r3, %ctaid.x;\n"
+    "  mov.u32 %r4, %ntid.x;\n"
+    "  mad.lo.s32 %r5, %r3, %r4, %r2;\n"
+    "  mov.u32 %r6, %r5;\n"
+    "  mov.u32 %r7, 0;\n"
+    "  mov.u32 %r8, 0;\n"
+    "  mov.u64 %rd8, exchange;\n"
+    "  shl.b32 %r13, %r2, 2;\n"
+    "  cvt.u64.u32 %rd9, %r13;\n"
+    "  add.s64 %rd9, %rd8, %rd9;\n"
+    "  add.s32 %r16, %r2, 1;\n"
+    "  and.b32 %r16, %r16, 255;\n"
+    "  shl.b32 %r16, %r16, 2;\n"
+    "  cvt.u64.u32 %rd10, %r16;\n"
+    "  add.s64 %rd10, %rd8, %rd10;\n"
+    "LOOP:\n"
+    // odd iterations read a coalesced word, even ones a random one
+    "  mul.lo.s32 %r6, %r6, 1103515245;\n"
+    "  add.s32 %r6, %r6, 12345;\n"
+    "  and.b32 %r9, %r8, 1;\n"
+    "  setp.eq.u32 %p1, %r9, 0;\n"
+    "  add.s32 %r11, %r5, %r8;\n"
+    "  selp.b32 %r10, %r6, %r11, %p1;\n"
+    "  and.b32 %r10, %r10, 65535;\n"
+    "  mul.wide.u32 %rd4, %r10, 4;\n"
+    "  add.s64 %rd5, %rd1, %rd4;\n"
+    "  ld.global.u32 %r12, [%rd5];\n"
+    "  add.s32 %r7, %r7, %r12;\n"
+    "  xor.b32 %r7, %r7, %r6;\n"
+    "  st.shared.u32 [%rd9], %r7;\n"
+    "  bar.sync 0;\n"
+    "  ld.shared.u32 %r17, [%rd10];\n"
+    "  add.s32 %r7, %r7, %r17;\n"
+    "  bar.sync 0;\n"
+    "  add.s32 %r8, %r8, 1;\n"
+    "  setp.lt.u32 %p2, %r8, 6;\n"
+    "  @%p2 bra LOOP;\n"
+    // the value returned by the atomic depends on the order the requests
+    // reached the L2, so it is stored as well
+    "  shr.u32 %r18, %r7, 7;\n"
+    "  and.b32 %r18, %r18, 1;\n"
+    "  atom.global.add.u32 %r19, [%rd3], %r18;\n"
+    "  mul.wide.u32 %rd6, %r5, 8;\n"
+    "  add.s64 %rd7, %rd2, %rd6;\n"
+    "  st.global.v2.u32 [%rd7], {%r7, %r19};\n"
+    "  ret;\n"
+    "}\n";
+
+// A chain of CTAs passing a running sum through global memory: thread 0 of
+// CTA c spins on the flag of CTA c - 1, takes its sum as the carry, and the
+// CTA publishes carry + its own inputs before raising its own flag.  Every
+// thread also stores carry + its input.  CTAs are issued in order, so the
+// predecessor of a running CTA has always been issued and the chain cannot
+// deadlock, but how long each CTA spins depends on when the stores of the
+// other clusters become visible to it.
+#define CTA_CHAIN_N_CTAS 48
+#define CTA_CHAIN_CTA_SIZE 128
+
+static const char *g_cta_chain_ptx =
+    ".version 6.4\n"
+    ".target sm_70\n"
+    ".address_size 64\n"
+    "\n"
+    ".visible .entry cta_chain(\n"
+    "  .param .u64 cta_chain_param_0,\n"
+    "  .param .u64 cta_chain_param_1,\n"
+    "  .param .u64 cta_chain_param_2,\n"
+    "  .param .u64 cta_chain_param_3\n"
+    ")\n"
+    "{\n"
+    "  .reg .pred %p<4>;\n"
+    "  .reg .b32 %r<16>;\n"
+    "  .reg .b64 %rd<16>;\n"
+    "  .shared .align 4 .b32 carry;\n"
+    "  .shared .align 4 .b32 cta_sum;\n"
+    "\n"
+    "  ld.param.u64 %rd1, [cta_chain_param_0];\n"
+    "  ld.param.u64 %rd2, [cta_chain_param_1];\n"
+    "  ld.param.u64 %rd3, [cta_chain_param_2];\n"
+    "  ld.param.u64 %rd4, [cta_chain_param_3];\n"
+    "  cvta.to.global.u64 %rd1, %rd1;\n"
+    "  cvta.to.global.u64 %rd2, %rd2;\n"
+    "  cvta.to.global.u64 %rd3, %rd3;\n"
+    "  cvta.to.global.u64 %rd4, %rd4;\n"
+    "  mov.u32 %r1, %tid.x;\n"
+    "  mov.u32 %r2, %ctaid.x;\n"
+    "  mov.u32 %r3, %ntid.x;\n"
+    "  mad.lo.s32 %r4, %r2, %r3, %r1;\n"
+    "  mul.wide.u32 %rd5, %r4, 4;\n"
+    "  add.s64 %rd6, %rd1, %rd5;\n"
+    "  ld.global.u32 %r5, [%rd6];\n"
+    "  mul.wide.u32 %rd7, %r2, 4;\n"
+    "  setp.ne.u32 %p1, %r1, 0;\n"
+    "  @%p1 bra WAITED;\n"
+    "  mov.u32 %r6, 0;\n"
+    "  st.shared.u32 [cta_sum], %r6;\n"
+    "  setp.eq.u32 %p2, %r2, 0;\n"
+    "  @%p2 bra HAVE_CARRY;\n"
+    "  add.s64 %rd8, %rd7, -4;\n"
+    "  add.s64 %rd9, %rd4, %rd8;\n"
+    "SPIN:\n"
+    "  ld.volatile.global.u32 %r7, [%rd9];\n"
+    "  setp.eq.u32 %p3, %r7, 0;\n"
+    "  @%p3 bra SPIN;\n"
+    "  add.s64 %rd10, %rd3, %rd8;\n"
+    "  ld.volatile.global.u32 %r6, [%rd10];\n"
+    "HAVE_CARRY:\n"
+    "  st.shared.u32 [carry], %r6;\n"
+    "WAITED:\n"
+    "  bar.sync 0;\n"
+    "  ld.shared.u32 %r8, [carry];\n"
+    "  add.s32 %r9, %r8, %r5;\n"
+    "  add.s64 %rd11, %rd2, %rd5;\n"
+    "  st.global.u32 [%rd11], %r9;\n"
+    "  atom.shared.add.u32 %r10, [cta_sum], %r5;\n"
+    "  bar.sync 0;\n"
+    "  @%p1 bra DONE;\n"
+    "  ld.shared.u32 %r11, [cta_sum];\n"
+    "  add.s32 %r12, %r11, %r8;\n"
+    "  add.s64 %rd12, %rd3, %rd7;\n"
+    "  st.volatile.global.u32 [%rd12], %r12;\n"
+    "  membar.gl;\n"
+    "  mov.u32 %r13, 1;\n"
+    "  add.s64 %rd13, %rd4, %rd7;\n"
+    "  st.volatile.global.u32 [%rd13], %r13;\n"
+    "DONE:\n"
+    "  ret;\n"
+    "}\n";
+
+// Loads ptx and returns its entry point, with the resource usage ptxas would
+// report for it.  The PTX is loaded from a file: the string loader parses
+// _<n>.ptx of the working directory first, which only exists for
+// -save_embedded_ptx.
+static function_info *test_load_kernel(gpgpu_context *ctx, const char *ptx,
+                                       const char *name, unsigned regs,
+                                       unsigned smem) {
+  char ptx_file[] = "/tmp/test_kernel_XXXXXX";
+  int fd = mkstemp(ptx_file);
+  if (fd < 0 || write(fd, ptx, strlen(ptx)) < 0) abort();
+  close(fd);
+  symbol_table *symtab = ctx->gpgpu_ptx_sim_load_ptx_from_filename(ptx_file);
+  unlink(ptx_file);
+  function_info *entry = symtab->lookup_function(name);
+  gpgpu_ptx_sim_info info;
+  memset(&info, 0, sizeof(info));
+  info.regs = regs;
+  info.smem = smem;
+  entry->set_kernel_info(info);
+  return entry;
+}
+
+// Launches entry with params and runs the GPU until it is idle, the way
+// cudaLaunch and the simulation loop do for a timing run, then prints the
+// statistics.
+static void test_run_kernel(gpgpu_sim *gpu, function_info *entry,
+                            std::vector<void *> &params, unsigned n_ctas,
+                            unsigned cta_size) {
+  std::vector<gpgpu_ptx_sim_arg *> args;
+  for (unsigned i = 0; i < params.size(); i++) {
+    args.push_back(new gpgpu_ptx_sim_arg(&params[i], sizeof(void *),
+                                         i * sizeof(void *)));
+    entry->add_param_data(i, args.back());
+  }
+  kernel_info_t *kernel = new kernel_info_t(dim3(n_ctas, 1, 1),
+                                            dim3(cta_size, 1, 1), entry);
+  entry->finalize(kernel->get_param_memory());
+  // reconvergence points, as cudaLaunch computes them for timing runs
+  entry->do_pdom();
+  entry->set_pdom();
+
+  gpu->launch(kernel);
+  gpu->init();
+  while (gpu->active()) {
+    gpu->cycle();
+    gpu->deadlock_check();
+  }
+  gpu->print_stats();
+  gpu->update_stats();
+  for (unsigned i = 0; i < args.size(); i++) delete args[i];
+}
+
+// the options every run starts from: a few clusters, so that the CTAs take
+// several waves, the fewest memory channels the address hashing supports, so
+// that the statistics stay short, and no per-source-line statistics file in
+// the working directory
+static std::vector<const char *> test_kernel_options(
+    const std::vector<const char *> &extra) {
+  std::vector<const char *> options;
+  options.push_back("-gpgpu_n_clusters");
+  options.push_back("8");
+  options.push_back("-gpgpu_n_mem");
+  options.push_back("16");
+  options.push_back("-enable_ptx_file_line_stats");
+  options.push_back("0");
+  options.insert(options.end(), extra.begin(), extra.end());
+  return options;
+}
+
+static int run_threads_diff(const char *config_file,
+                            const std::vector<const char *> &extra) {
+  gpgpu_context *ctx = new gpgpu_context();
+  gpgpu_sim *gpu =
+      test_create_gpu(ctx, config_file, test_kernel_options(extra));
+  function_info *entry =
+      test_load_kernel(ctx, g_threads_diff_ptx, "threads_diff", 24, 1024);
+
+  std::vector<unsigned> table(THREADS_DIFF_TABLE_WORDS);
+  for (unsigned i = 0; i < THREADS_DIFF_TABLE_WORDS; i++)
+    table[i] = i * 2654435761u;
+  unsigned n_threads = THREADS_DIFF_N_CTAS * THREADS_DIFF_CTA_SIZE;
+  std::vector<void *> params(3);
+  params[0] = gpu->gpu_malloc(THREADS_DIFF_TABLE_WORDS * sizeof(unsigned));
+  params[1] = gpu->gpu_malloc(n_threads * 2 * sizeof(unsigned));
+  params[2] = gpu->gpu_malloc(sizeof(unsigned));
+  gpu->memcpy_to_gpu((size_t)params[0], &table[0],
+                     THREADS_DIFF_TABLE_WORDS * sizeof(unsigned));
+  unsigned zero = 0;
+  gpu->memcpy_to_gpu((size_t)params[2], &zero, sizeof(zero));
+  test_run_kernel(gpu, entry, params, THREADS_DIFF_N_CTAS,
+                  THREADS_DIFF_CTA_SIZE);
+
+  std::vector<unsigned> result(n_threads * 2);
+  gpu->memcpy_from_gpu(&result[0], (size_t)params[1],
+                       n_threads * 2 * sizeof(unsigned));
+  unsigned long long checksum = 0;
+  for (unsigned i = 0; i < n_threads * 2; i++)
+    checksum = checksum * 31 + result[i];
+  unsigned atomic_count;
+  gpu->memcpy_from_gpu(&atomic_count, (size_t)params[2],
+                       sizeof(atomic_count));
+  printf("result checksum = %llx, atomic count = %u\n", checksum,
+         atomic_count);
+  return 0;
+}
+
+static int run_cta_chain(const char *config_file,
+                         const std::vector<const char *> &extra) {
+  gpgpu_context *ctx = new gpgpu_context();
+  gpgpu_sim *gpu =
+      test_create_gpu(ctx, config_file, test_kernel_options(extra));
+  function_info *entry =
+      test_load_kernel(ctx, g_cta_chain_ptx, "cta_chain", 16, 8);
+
+  unsigned n_threads = CTA_CHAIN_N_CTAS * CTA_CHAIN_CTA_SIZE;
+  std::vector<unsigned> in(n_threads);
+  for (unsigned i = 0; i < n_threads; i++) in[i] = (i * 2654435761u) >> 20;
+  std::vector<void *> params(4);
+  params[0] = gpu->gpu_malloc(n_threads * sizeof(unsigned));
+  params[1] = gpu->gpu_malloc(n_threads * sizeof(unsigned));
+  params[2] = gpu->gpu_malloc(CTA_CHAIN_N_CTAS * sizeof(unsigned));
+  params[3] = gpu->gpu_malloc(CTA_CHAIN_N_CTAS * sizeof(unsigned));
+  gpu->memcpy_to_gpu((size_t)params[0], &in[0], n_threads * sizeof(unsigned));
+  std::vector<unsigned> zero(CTA_CHAIN_N_CTAS, 0);
+  gpu->memcpy_to_gpu((size_t)params[3], &zero[0],
+                     CTA_CHAIN_N_CTAS * sizeof(unsigned));
+  test_run_kernel(gpu, entry, params, CTA_CHAIN_N_CTAS, CTA_CHAIN_CTA_SIZE);
+
+  std::vector<unsigned> out(n_threads), sums(CTA_CHAIN_N_CTAS);
+  gpu->memcpy_from_gpu(&out[0], (size_t)params[1],
+                       n_threads * sizeof(unsigned));
+  gpu->memcpy_from_gpu(&sums[0], (size_t)params[2],
+                       CTA_CHAIN_N_CTAS * sizeof(unsigned));
+  unsigned carry = 0;
+  for (unsigned c = 0; c < CTA_CHAIN_N_CTAS; c++) {
+    unsigned sum = carry;
+    for (unsigned t = 0; t < CTA_CHAIN_CTA_SIZE; t++) {
+      unsigned i = c * CTA_CHAIN_CTA_SIZE + t;
+      sum += in[i];
+      if (out[i] != carry + in[i]) {
+        printf("result wrong: thread %u stored %u, expected %u\n", i, out[i],
+               carry + in[i]);
+        return 1;
+      }
+    }
+    if (sums[c] != sum) {
+      printf("result wrong: CTA %u published %u, expected %u\n", c, sums[c],
+             sum);
+      return 1;
+    }
+    carry = sum;
+  }
+  printf("result total = %u\n", carry);
+  return 0;
+}
+
+struct test_kernel {
+  const char *name;
+  int (*run)(const char *config_file, const std::vector<const char *> &extra);
+};
+
+static const test_kernel g_test_kernels[] = {{"threads_diff", run_threads_diff},
+                                             {"cta_chain", run_cta_chain}};
+static const unsigned g_n_test_kernels =
+    sizeof(g_test_kernels) / sizeof(g_test_kernels[0]);
+
+// output lines that legitimately differ between two runs
+static bool test_run_dependent(const std::string &line) {
+  return line.find("sim_rate") != std::string::npos;
+}
+
+// Runs kernel with the extra options in a child process, so that each run
+// starts from a fresh simulator, and returns what it printed from the first
+// statistic on.
+static bool test_run_child(const test_kernel &kernel, const char *config_file,
+                           const std::vector<const char *> &extra,
+                           std::vector<std::string> &lines) {
+  char out_file[] = "/tmp/test_kernel_out_XXXXXX";
+  int fd = mkstemp(out_file);
+  if (fd < 0) return false;
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(fd, 1);
+    int rc = kernel.run(config_file, extra);
+    fflush(stdout);
+    _exit(rc);
+  }
+  close(fd);
+  int status;
+  if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    printf("%s run failed, output in %s\n", kernel.name, out_file);
+    return false;
+  }
+  std::ifstream in(out_file);
+  std::string line;
+  bool started = false;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 14, "kernel_name = ") == 0) started = true;
+    if (started && !test_run_dependent(line)) lines.push_back(line);
+  }
+  unlink(out_file);
+  return started;
+}
+
+#endif